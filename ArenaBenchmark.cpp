@@ -0,0 +1,101 @@
+// Benchmark for per worker scratch arenas: a kernel that allocates a dynamically sized local array on every
+// invocation, dispatched over a growing number of worker threads with and without arenas.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Bench.h"
+#include "CPUDispatcher.h"
+#include "RunModes.h"
+
+static const uint32_t   c_groupCount        = 4096;
+static const uint32_t   c_threadsPerGroup   = 64;
+static const uint32_t   c_maxLocalElements  = 256;
+static const int        c_repeatCount       = 5;
+
+struct ScratchKernelParams
+{
+    RWStructuredBuffer<float> results;
+};
+
+// One invocation, in the shape the C++ target emits: a local array sized at runtime, filled and reduced.
+static void ScratchKernelThread(const uint3& dispatchThreadID, ScratchKernelParams* params)
+{
+    const size_t count = 16 + (dispatchThreadID.x * 7) % (c_maxLocalElements - 16);
+    Array<float> values = ScratchArray<float>(count);
+    for (size_t i = 0; i < count; i++)
+        values[i] = float(dispatchThreadID.x + i) * 0.5f;
+
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; i++)
+        sum += values[i];
+    params->results[dispatchThreadID.x] = sum;
+
+    ScratchRelease(values);
+}
+
+// The group loop emitted around an entry point for [numthreads(64, 1, 1)]
+static void ScratchKernel(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    ScratchKernelParams* params = (ScratchKernelParams*)uniformEntryPointParams;
+    for (uint32_t groupX = varyingInput->startGroupID.x; groupX < varyingInput->endGroupID.x; groupX++)
+    {
+        for (uint32_t threadX = 0; threadX < c_threadsPerGroup; threadX++)
+        {
+            uint3 dispatchThreadID = uint3(groupX * c_threadsPerGroup + threadX, 0, 0);
+            ScratchKernelThread(dispatchThreadID, params);
+        }
+    }
+}
+
+int RunArenaBenchmark(int argc, char** argv)
+{
+    int maxThreadCount = argc > 1 ? atoi(argv[1]) : int(std::thread::hardware_concurrency());
+    if (maxThreadCount <= 0)
+        maxThreadCount = 1;
+
+    const uint32_t invocationCount = c_groupCount * c_threadsPerGroup;
+    std::vector<float> results(invocationCount);
+    ScratchKernelParams params = { { results.data(), results.size() } };
+
+    printf("Scratch arena benchmark: %u groups of %u threads, one allocation per invocation, best of %i runs\n",
+        c_groupCount, c_threadsPerGroup, c_repeatCount);
+    printf("\n    %-8s %12s %14s %12s %14s %8s\n", "threads", "heap ms", "heap Mallocs/s", "arena ms", "arena Mallocs/s", "speedup");
+
+    int ret = 0;
+    for (int threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+    {
+        double ms[2];
+        std::vector<float> reference;
+        for (int useArenas = 0; useArenas < 2; useArenas++)
+        {
+            CPUDispatcher dispatcher(threadCount, useArenas != 0);
+            ms[useArenas] = TimeBestMs(c_repeatCount, [&]()
+            {
+                dispatcher.dispatch(ScratchKernel, uint3(c_groupCount, 1, 1), &params, nullptr);
+            });
+
+            if (!useArenas)
+                reference = results;
+            else if (reference != results)
+            {
+                printf("ERROR: arena results differ from heap results at %i threads\n", threadCount);
+                ret = 1;
+            }
+        }
+
+        const double allocations = double(invocationCount);
+        printf("    %-8i %12.3f %14.2f %12.3f %14.2f %7.2fx\n",
+            threadCount,
+            ms[0], allocations / (ms[0] * 1000.0),
+            ms[1], allocations / (ms[1] * 1000.0),
+            ms[0] / ms[1]);
+
+        if (threadCount < maxThreadCount && threadCount * 2 > maxThreadCount)
+            threadCount = maxThreadCount / 2;
+    }
+
+    return ret;
+}
@@ -0,0 +1,169 @@
+// Exercises AsyncCompiler (AsyncCompiler.h) the way an editor would: test.slang is "edited" every few milliseconds,
+// each edit submitted as an interactive compile that supersedes the previous one, with low priority background
+// compiles mixed in. Reports how many compiles finished or were cancelled and the latency from submit to result.
+
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <string.h>
+#include <thread>
+
+#include "AsyncCompiler.h"
+#include "Bench.h"
+#include "RunModes.h"
+
+static const char*  c_fileNameSource        = "test.slang";
+static const char*  c_moduleName            = "test";
+static const char*  c_entryPointName        = "csmain";
+static const char*  c_editedText            = "0.0f";       // the value csmain writes, changed by each edit
+static const int    c_firstEditValue        = 1000;         // edited values are distinctive enough to find in the output
+static const int    c_defaultEditCount      = 20;
+static const int    c_editIntervalMs        = 5;
+static const int    c_backgroundEvery       = 4;            // a background compile after every 4th edit
+static const int    c_interactivePriority   = 1;
+static const int    c_backgroundPriority    = 0;
+
+struct LatencyStats
+{
+    int         submitted = 0;
+    int         succeeded = 0;
+    int         failed = 0;
+    int         cancelled = 0;
+    double      minMs = 0.0;
+    double      maxMs = 0.0;
+    double      totalMs = 0.0;
+
+    void add(const CompileResult& result)
+    {
+        if (result.status == CompileStatus::Cancelled)
+        {
+            cancelled++;
+            return;
+        }
+        if (result.status == CompileStatus::Failed)
+        {
+            failed++;
+            return;
+        }
+        minMs = succeeded == 0 || result.totalMs < minMs ? result.totalMs : minMs;
+        maxMs = succeeded == 0 || result.totalMs > maxMs ? result.totalMs : maxMs;
+        totalMs += result.totalMs;
+        succeeded++;
+    }
+
+    void print(const char* label) const
+    {
+        printf("    %-12s %9i %9i %9i %9i", label, submitted, succeeded, cancelled, failed);
+        if (succeeded)
+            printf(" %12.3f %12.3f %12.3f", minMs, totalMs / succeeded, maxMs);
+        printf("\n");
+    }
+};
+
+static bool ReadFile(const char* fileName, std::string& outText)
+{
+    FILE* file = nullptr;
+    fopen_s(&file, fileName, "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    outText.resize(size_t(ftell(file)));
+    fseek(file, 0, SEEK_SET);
+    const size_t readSize = fread(&outText[0], 1, outText.size(), file);
+    fclose(file);
+    return readSize == outText.size();
+}
+
+int RunAsyncCompileBenchmark(int argc, char** argv)
+{
+    const int editCount = argc > 1 ? atoi(argv[1]) : c_defaultEditCount;
+    const int threadCount = argc > 2 ? atoi(argv[2]) : 0;
+
+    std::string source;
+    if (!ReadFile(c_fileNameSource, source))
+    {
+        printf("Could not read %s.\n", c_fileNameSource);
+        return 1;
+    }
+    const size_t editPosition = source.find(c_editedText);
+    if (editPosition == std::string::npos)
+    {
+        printf("%s does not contain \"%s\" to edit.\n", c_fileNameSource, c_editedText);
+        return 1;
+    }
+
+    AsyncCompiler compiler(threadCount);
+    printf("Async compile: %i edits of %s every %i ms on %i workers\n\n", editCount, c_fileNameSource, c_editIntervalMs, compiler.getThreadCount());
+
+    std::mutex statsMutex;
+    LatencyStats interactive;
+    LatencyStats background;
+
+    Timer timer;
+    std::shared_ptr<CompileJob> lastEdit;
+    std::string lastEditValue;
+    for (int edit = 0; edit < editCount; edit++)
+    {
+        CompileRequestDesc desc;
+        desc.moduleName = c_moduleName;
+        desc.entryPointName = c_entryPointName;
+        desc.priority = c_interactivePriority;
+        desc.supersedeKey = c_fileNameSource;
+        lastEditValue = std::to_string(c_firstEditValue + edit);
+        desc.source = source.substr(0, editPosition) + lastEditValue + ".0f" + source.substr(editPosition + strlen(c_editedText));
+        desc.onComplete = [&](const CompileResult& result)
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            interactive.add(result);
+        };
+        lastEdit = compiler.submit(desc);
+        interactive.submitted++;
+
+        if ((edit + 1) % c_backgroundEvery == 0)
+        {
+            CompileRequestDesc backgroundDesc;
+            backgroundDesc.moduleName = c_moduleName;
+            backgroundDesc.entryPointName = c_entryPointName;
+            backgroundDesc.priority = c_backgroundPriority;
+            backgroundDesc.onComplete = [&](const CompileResult& result)
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                background.add(result);
+            };
+            compiler.submit(backgroundDesc);
+            background.submitted++;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(c_editIntervalMs));
+    }
+
+    // The last edit is never superseded, so it must come back compiled, with the edit in its output
+    int failures = 0;
+    const CompileResult& lastResult = lastEdit->getFuture().get();
+    bool lastOk = lastResult.status == CompileStatus::Succeeded && lastResult.code;
+    if (lastOk)
+    {
+        const std::string code((const char*)lastResult.code->getBufferPointer(), lastResult.code->getBufferSize());
+        lastOk = code.find(lastEditValue) != std::string::npos;
+    }
+    const double lastEditMs = timer.elapsedMs();
+    compiler.waitIdle();
+    const double allMs = timer.elapsedMs();
+
+    printf("    %-12s %9s %9s %9s %9s %12s %12s %12s\n", "", "submitted", "compiled", "cancelled", "failed", "min ms", "avg ms", "max ms");
+    interactive.print("interactive");
+    background.print("background");
+    printf("\n    %-40s %10.3f ms\n", "edits until last result", lastEditMs);
+    printf("    %-40s %10.3f ms\n", "until idle", allMs);
+    printf("    %-40s %10.3f ms\n", "last edit, submit to result", lastResult.totalMs);
+    printf("    %-40s %s\n", "last edit result", lastOk ? "OK" : "FAILED");
+    if (!lastOk)
+    {
+        if (!lastResult.diagnostics.empty())
+            printf("diagnostics:\n%s\n", lastResult.diagnostics.c_str());
+        failures++;
+    }
+
+    return failures ? 1 : 0;
+}
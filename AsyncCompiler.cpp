@@ -0,0 +1,187 @@
+#include "AsyncCompiler.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "SlangHelpers.h"
+#include "StringBlob.h"
+
+using Slang::ComPtr;
+
+static const char* c_searchPaths[] = { "." };
+
+static double MsSince(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+AsyncCompiler::AsyncCompiler(int threadCount)
+{
+    if (threadCount <= 0)
+        threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    for (int i = 0; i < threadCount; i++)
+        m_workers.emplace_back([this]() { _workerLoop(); });
+}
+
+AsyncCompiler::~AsyncCompiler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workAvailable.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+std::shared_ptr<CompileJob> AsyncCompiler::submit(const CompileRequestDesc& desc)
+{
+    JobPtr job = std::make_shared<CompileJob>();
+    job->m_desc = desc;
+    job->m_submitTime = std::chrono::steady_clock::now();
+    job->m_future = job->m_promise.get_future().share();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job->m_sequence = m_nextSequence++;
+
+        if (!desc.supersedeKey.empty())
+        {
+            for (const JobPtr& other : m_supersedable)
+            {
+                if (other->m_desc.supersedeKey == desc.supersedeKey)
+                    other->cancel();
+            }
+            m_supersedable.push_back(job);
+        }
+        m_queue.push(job);
+    }
+    m_workAvailable.notify_one();
+    return job;
+}
+
+void AsyncCompiler::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_queue.empty() && m_runningCount == 0; });
+}
+
+void AsyncCompiler::_workerLoop()
+{
+    // Creating the global session loads the standard library, so it's done once per worker
+    ComPtr<slang::IGlobalSession> globalSession;
+    slang_createGlobalSession(SLANG_API_VERSION, globalSession.writeRef());
+
+    for (;;)
+    {
+        JobPtr job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workAvailable.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+            job = m_queue.top();
+            m_queue.pop();
+            m_runningCount++;
+
+            // Shutting down: drain the queue, completing every job as cancelled
+            if (m_stopping)
+                job->cancel();
+        }
+
+        const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        CompileResult result;
+        if (!job->isCancelled())
+        {
+            if (globalSession)
+                result = _compile(globalSession, *job);
+            else
+                result.diagnostics = "Could not create a slang global session.\n";
+        }
+        _finish(*job, result, startTime);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_supersedable.erase(std::remove(m_supersedable.begin(), m_supersedable.end(), job), m_supersedable.end());
+            m_runningCount--;
+        }
+        m_idle.notify_all();
+    }
+}
+
+CompileResult AsyncCompiler::_compile(slang::IGlobalSession* globalSession, CompileJob& job)
+{
+    const CompileRequestDesc& desc = job.m_desc;
+    CompileResult result;
+
+    slang::TargetDesc targetDesc;
+    targetDesc.format = desc.target;
+    targetDesc.profile = globalSession->findProfile(desc.profile.c_str());
+
+    slang::SessionDesc sessionDesc;
+    sessionDesc.targets = &targetDesc;
+    sessionDesc.targetCount = 1;
+    sessionDesc.searchPaths = c_searchPaths;
+    sessionDesc.searchPathCount = SlangInt(sizeof(c_searchPaths) / sizeof(c_searchPaths[0]));
+
+    ComPtr<slang::ISession> session;
+    if (SLANG_FAILED(globalSession->createSession(sessionDesc, session.writeRef())))
+        return result;
+
+    ComPtr<ISlangBlob> diagnostics;
+    slang::IModule* module = nullptr;
+    if (desc.source.empty())
+    {
+        module = session->loadModule(desc.moduleName.c_str(), diagnostics.writeRef());
+    }
+    else
+    {
+        const std::string path = desc.moduleName + ".slang";
+        ComPtr<ISlangBlob> source = StringBlob::create(desc.source.c_str());
+        module = session->loadModuleFromSource(desc.moduleName.c_str(), path.c_str(), source, diagnostics.writeRef());
+    }
+    AppendDiagnostics(result.diagnostics, diagnostics);
+    if (!module || job.isCancelled())
+        return result;
+
+    ComPtr<slang::IEntryPoint> entryPoint;
+    if (SLANG_FAILED(module->findEntryPointByName(desc.entryPointName.c_str(), entryPoint.writeRef())))
+    {
+        result.diagnostics += "No entry point named " + desc.entryPointName + ".\n";
+        return result;
+    }
+
+    slang::IComponentType* components[] = { module, entryPoint };
+    ComPtr<slang::IComponentType> composite;
+    ComPtr<slang::IComponentType> linked;
+    SlangResult linkResult = session->createCompositeComponentType(components, 2, composite.writeRef(), diagnostics.writeRef());
+    AppendDiagnostics(result.diagnostics, diagnostics);
+    if (SLANG_SUCCEEDED(linkResult))
+    {
+        linkResult = composite->link(linked.writeRef(), diagnostics.writeRef());
+        AppendDiagnostics(result.diagnostics, diagnostics);
+    }
+    if (SLANG_FAILED(linkResult) || job.isCancelled())
+        return result;
+
+    const SlangResult codeResult = linked->getEntryPointCode(0, 0, result.code.writeRef(), diagnostics.writeRef());
+    AppendDiagnostics(result.diagnostics, diagnostics);
+    result.status = SLANG_SUCCEEDED(codeResult) ? CompileStatus::Succeeded : CompileStatus::Failed;
+    return result;
+}
+
+void AsyncCompiler::_finish(CompileJob& job, CompileResult& result, std::chrono::steady_clock::time_point startTime)
+{
+    if (job.isCancelled())
+    {
+        result.status = CompileStatus::Cancelled;
+        result.code = nullptr;
+    }
+    result.queueMs = std::chrono::duration<double, std::milli>(startTime - job.m_submitTime).count();
+    result.totalMs = MsSince(job.m_submitTime);
+
+    if (job.m_desc.onComplete)
+        job.m_desc.onComplete(result);
+    job.m_promise.set_value(result);
+}
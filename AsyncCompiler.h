@@ -0,0 +1,120 @@
+#pragma once
+
+// Compiles in the background, so tools don't block on spCompile.
+//
+// submit() queues a request and returns a CompileJob right away. The result arrives through the job's future, and
+// optionally a callback on the worker thread. Queued jobs run highest priority first (then oldest first) on a fixed
+// number of workers, which bounds how many compiles run at once.
+//
+// Jobs can be cancelled. A queued job is dropped without compiling; a running one stops at the next stage boundary
+// (load, link, code generation). Requests that share a supersede key replace each other: submitting one cancels the
+// earlier ones, which is what an editor wants when the source changes again before the last compile finished.
+//
+// A slang global session must only be used by one thread at a time, so each worker owns one and creates a fresh
+// session per job from it. The fresh session means edited source is always recompiled rather than served from the
+// session's module cache.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "slang/slang.h"
+#include "slang/slang-com-ptr.h"
+
+enum class CompileStatus
+{
+    Succeeded,
+    Failed,
+    Cancelled,
+};
+
+struct CompileResult
+{
+    CompileStatus                   status = CompileStatus::Failed;
+    Slang::ComPtr<ISlangBlob>       code;
+    std::string                     diagnostics;
+    double                          queueMs = 0.0;      ///< Submit until a worker started it
+    double                          totalMs = 0.0;      ///< Submit until the result was ready
+};
+
+struct CompileRequestDesc
+{
+    std::string                     moduleName;
+    std::string                     source;             ///< Module source. If empty, the module is loaded from the working directory.
+    std::string                     entryPointName;
+    SlangCompileTarget              target = SLANG_HLSL;
+    std::string                     profile = "cs_5_1";
+    int                             priority = 0;       ///< Higher runs first
+    std::string                     supersedeKey;       ///< If set, cancels earlier jobs with the same key
+    std::function<void(const CompileResult&)> onComplete;
+};
+
+class CompileJob
+{
+public:
+    /// Cancels the job if it hasn't finished. Its result will be CompileStatus::Cancelled.
+    void cancel() { m_cancelled = true; }
+    bool isCancelled() const { return m_cancelled; }
+
+    const std::shared_future<CompileResult>& getFuture() const { return m_future; }
+
+protected:
+    friend class AsyncCompiler;
+
+    CompileRequestDesc                              m_desc;
+    uint64_t                                        m_sequence = 0;
+    std::chrono::steady_clock::time_point           m_submitTime;
+    std::atomic<bool>                               m_cancelled{ false };
+    std::promise<CompileResult>                     m_promise;
+    std::shared_future<CompileResult>               m_future;
+};
+
+class AsyncCompiler
+{
+public:
+    /// Starts `threadCount` workers (one per hardware thread if 0), each with its own global session.
+    explicit AsyncCompiler(int threadCount = 0);
+
+    /// Cancels everything still queued and waits for running jobs.
+    ~AsyncCompiler();
+
+    std::shared_ptr<CompileJob> submit(const CompileRequestDesc& desc);
+
+    /// Waits until the queue is empty and no job is running.
+    void waitIdle();
+
+    int getThreadCount() const { return int(m_workers.size()); }
+
+protected:
+    typedef std::shared_ptr<CompileJob> JobPtr;
+
+    struct JobOrder
+    {
+        bool operator()(const JobPtr& a, const JobPtr& b) const
+        {
+            return a->m_desc.priority != b->m_desc.priority ? a->m_desc.priority < b->m_desc.priority : a->m_sequence > b->m_sequence;
+        }
+    };
+
+    void _workerLoop();
+    CompileResult _compile(slang::IGlobalSession* globalSession, CompileJob& job);
+    void _finish(CompileJob& job, CompileResult& result, std::chrono::steady_clock::time_point startTime);
+
+    std::mutex                                              m_mutex;
+    std::condition_variable                                 m_workAvailable;
+    std::condition_variable                                 m_idle;
+    std::priority_queue<JobPtr, std::vector<JobPtr>, JobOrder> m_queue;
+    std::vector<JobPtr>                                     m_supersedable;     ///< Unfinished jobs with a supersede key
+    uint64_t                                                m_nextSequence = 0;
+    int                                                     m_runningCount = 0;
+    bool                                                    m_stopping = false;
+    std::vector<std::thread>                                m_workers;
+};
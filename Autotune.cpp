@@ -0,0 +1,182 @@
+// Autotunes the group size of test.slang's csmain on slang-gfx's CPU device.
+//
+// csmain takes its group size from GROUP_SIZE_X, so each candidate is compiled through a device whose session
+// defines it. Each one is dispatched over the same buffer with warmup runs first, then timed repeatedly, and reported
+// as a mean with a 95% confidence interval. The fastest is stored in the tuning file (KernelTuning.h) for this
+// kernel, target and machine, where gfxcpu picks it up.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "GfxCompute.h"
+#include "KernelTuning.h"
+#include "RunModes.h"
+
+using namespace gfx;
+using Slang::ComPtr;
+
+static const char*  c_moduleName            = "test";
+static const char*  c_entryPointName        = "csmain";
+static const char*  c_dataParameterName     = "Data";
+static const char*  c_target                = "cpu";
+static const int    c_groupSizes[]          = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+static const int    c_maxGroupSize          = 256;
+static const int    c_defaultElementCount   = 1 << 16;
+static const int    c_defaultRepeatCount    = 30;
+static const int    c_warmupCount           = 5;
+static const float  c_initialValue          = 1.0f;     // csmain writes 0, so anything left at this wasn't written
+
+struct TuningCandidate
+{
+    int             groupSize = 0;
+    SampleStats     stats;
+    bool            ok = false;
+};
+
+/// Compiles csmain with the candidate's group size, checks it covers every element, and times it.
+static bool MeasureCandidate(TuningCandidate& candidate, int elementCount, int repeatCount)
+{
+    TuningResult config;
+    config.groupSize[0] = candidate.groupSize;
+    std::vector<std::string> macroValues;
+    std::vector<slang::PreprocessorMacroDesc> macros;
+    GetTunedGroupSizeMacros(config, macroValues, macros);
+
+    IDevice::Desc deviceDesc = {};
+    deviceDesc.slang.preprocessorMacros = macros.data();
+    deviceDesc.slang.preprocessorMacroCount = GfxCount(macros.size());
+
+    GfxComputeContext context;
+    GfxComputeKernel kernel;
+    if (SLANG_FAILED(CreateGfxComputeContext(DeviceType::CPU, context, &deviceDesc)) ||
+        SLANG_FAILED(LoadComputeKernel(context.device, c_moduleName, c_entryPointName, kernel)))
+    {
+        printf("    ERROR: could not build %s:%s with a group size of %i\n", c_moduleName, c_entryPointName, candidate.groupSize);
+        return false;
+    }
+    if (int(kernel.numThreads[0]) != candidate.groupSize)
+    {
+        printf("    ERROR: %s:%s has numthreads %i, expected %i. Does it use GROUP_SIZE_X?\n",
+            c_moduleName, c_entryPointName, int(kernel.numThreads[0]), candidate.groupSize);
+        return false;
+    }
+
+    const std::vector<float> initialData(size_t(elementCount), c_initialValue);
+    ComPtr<IBufferResource> buffer;
+    ComPtr<IResourceView> view;
+    if (SLANG_FAILED(CreateFloatBuffer(context.device, size_t(elementCount), initialData.data(), buffer.writeRef(), view.writeRef())))
+    {
+        printf("    ERROR: could not create the %s buffer\n", c_dataParameterName);
+        return false;
+    }
+
+    const int groupCount = elementCount / candidate.groupSize;
+    bool dispatchFailed = false;
+    std::vector<double> samples = TimeSamplesMs(c_warmupCount, repeatCount, [&]()
+    {
+        dispatchFailed |= SLANG_FAILED(DispatchAndWait(context, kernel, c_dataParameterName, view, groupCount));
+    });
+    if (dispatchFailed)
+    {
+        printf("    ERROR: dispatch failed with a group size of %i\n", candidate.groupSize);
+        return false;
+    }
+
+    ComPtr<ISlangBlob> readback;
+    if (SLANG_FAILED(context.device->readBufferResource(buffer, 0, Size(elementCount) * sizeof(float), readback.writeRef())))
+    {
+        printf("    ERROR: could not read back the %s buffer\n", c_dataParameterName);
+        return false;
+    }
+    const float* values = (const float*)readback->getBufferPointer();
+    for (int i = 0; i < elementCount; i++)
+    {
+        if (values[i] != 0.0f)
+        {
+            printf("    ERROR: %s[%i] is %f with a group size of %i, expected 0\n", c_dataParameterName, i, values[i], candidate.groupSize);
+            return false;
+        }
+    }
+
+    candidate.stats = ComputeSampleStats(samples);
+    return true;
+}
+
+int RunAutotune(int argc, char** argv)
+{
+    int elementCount = argc > 1 ? atoi(argv[1]) : c_defaultElementCount;
+    const int repeatCount = argc > 2 ? atoi(argv[2]) : c_defaultRepeatCount;
+    if (elementCount < 1 || repeatCount < 2)
+    {
+        printf("The element count must be at least 1 and the repeat count at least 2.\n");
+        return 1;
+    }
+
+    // Every candidate then divides the buffer into whole groups
+    elementCount = (elementCount + c_maxGroupSize - 1) / c_maxGroupSize * c_maxGroupSize;
+
+    const TuningKey key = { std::string(c_moduleName) + ":" + c_entryPointName, c_target, GetTuningMachineName() };
+    printf("Autotuning %s for %s on %s: %i elements, %i warmup and %i timed dispatches per group size\n\n",
+        key.kernel.c_str(), key.target.c_str(), key.machine.c_str(), elementCount, c_warmupCount, repeatCount);
+    printf("    %-10s %12s %12s %12s %12s %14s\n", "group size", "mean ms", "+- 95% ms", "stddev ms", "min ms", "Melements/s");
+
+    int failures = 0;
+    std::vector<TuningCandidate> candidates;
+    for (int groupSize : c_groupSizes)
+    {
+        TuningCandidate candidate;
+        candidate.groupSize = groupSize;
+        candidate.ok = MeasureCandidate(candidate, elementCount, repeatCount);
+        if (!candidate.ok)
+        {
+            failures++;
+            continue;
+        }
+
+        const SampleStats& stats = candidate.stats;
+        printf("    %-10i %12.4f %12.4f %12.4f %12.4f %14.2f\n", groupSize, stats.mean, stats.ci95, stats.stddev, stats.min,
+            stats.mean > 0.0 ? double(elementCount) / (stats.mean * 1000.0) : 0.0);
+        candidates.push_back(candidate);
+    }
+    if (candidates.empty())
+    {
+        printf("\nNo group size could be measured.\n");
+        return 1;
+    }
+
+    const TuningCandidate* best = &candidates[0];
+    for (const TuningCandidate& candidate : candidates)
+    {
+        if (candidate.stats.mean < best->stats.mean)
+            best = &candidate;
+    }
+
+    // Group sizes whose intervals overlap the best one's aren't clearly slower
+    std::string ties;
+    for (const TuningCandidate& candidate : candidates)
+    {
+        if (&candidate != best && candidate.stats.overlaps(best->stats))
+            ties += " " + std::to_string(candidate.groupSize);
+    }
+    printf("\n    %-40s %i (%.4f +- %.4f ms)\n", "best group size", best->groupSize, best->stats.mean, best->stats.ci95);
+    printf("    %-40s %s\n", "within its confidence interval", ties.empty() ? "none" : ties.c_str() + 1);
+
+    TuningDatabase database;
+    database.load(c_tuningFileName);
+    TuningResult result;
+    result.groupSize[0] = best->groupSize;
+    result.meanMs = best->stats.mean;
+    result.ci95Ms = best->stats.ci95;
+    database.set(key, result);
+    if (!database.save(c_tuningFileName))
+    {
+        printf("Could not open %s for writing.\n", c_tuningFileName);
+        return 1;
+    }
+    printf("    %-40s %s\n", "saved to", c_tuningFileName);
+
+    return failures ? 1 : 0;
+}
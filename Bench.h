@@ -0,0 +1,123 @@
+#pragma once
+
+// Small timing helpers shared by the benchmark run modes.
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+class Timer
+{
+public:
+    Timer() { reset(); }
+
+    void reset() { m_start = std::chrono::high_resolution_clock::now(); }
+
+    double elapsedMs() const
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - m_start;
+        return elapsed.count();
+    }
+
+protected:
+    std::chrono::high_resolution_clock::time_point m_start;
+};
+
+/// Runs `func` once to warm caches, then `repeatCount` more times, and returns the fastest run in milliseconds.
+template <typename FUNC>
+double TimeBestMs(int repeatCount, FUNC&& func)
+{
+    func();
+
+    double best = 0.0;
+    for (int i = 0; i < repeatCount; i++)
+    {
+        Timer timer;
+        func();
+        double ms = timer.elapsedMs();
+        if (i == 0 || ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+/// Prints one benchmark result line. `workCount` is the number of items processed per run (samples, elements...).
+inline void PrintBenchResult(const char* label, double ms, double workCount, const char* workUnit)
+{
+    double ratePerSec = ms > 0.0 ? workCount / (ms / 1000.0) : 0.0;
+    printf("    %-40s %10.3f ms  %10.2f M%s/s\n", label, ms, ratePerSec / 1000000.0, workUnit);
+}
+
+/// Runs `func` `warmupCount` times untimed, then `repeatCount` times, and returns each timed run in milliseconds.
+template <typename FUNC>
+std::vector<double> TimeSamplesMs(int warmupCount, int repeatCount, FUNC&& func)
+{
+    for (int i = 0; i < warmupCount; i++)
+        func();
+
+    std::vector<double> samples;
+    for (int i = 0; i < repeatCount; i++)
+    {
+        Timer timer;
+        func();
+        samples.push_back(timer.elapsedMs());
+    }
+    return samples;
+}
+
+/// Summary of repeated timings. ci95 is the half width of the 95% confidence interval of the mean.
+struct SampleStats
+{
+    int     count = 0;
+    double  mean = 0.0;
+    double  stddev = 0.0;
+    double  min = 0.0;
+    double  max = 0.0;
+    double  ci95 = 0.0;
+
+    /// True if the confidence intervals of the two means overlap, so neither is clearly faster.
+    bool overlaps(const SampleStats& other) const
+    {
+        return fabs(mean - other.mean) <= ci95 + other.ci95;
+    }
+};
+
+inline SampleStats ComputeSampleStats(const std::vector<double>& samples)
+{
+    // Two sided 95% Student's t values for 1 to 30 degrees of freedom. Past that the normal value is close enough.
+    static const double c_t95[30] =
+    {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+
+    SampleStats stats;
+    stats.count = int(samples.size());
+    if (samples.empty())
+        return stats;
+
+    stats.min = samples[0];
+    stats.max = samples[0];
+    double sum = 0.0;
+    for (double sample : samples)
+    {
+        sum += sample;
+        stats.min = sample < stats.min ? sample : stats.min;
+        stats.max = sample > stats.max ? sample : stats.max;
+    }
+    stats.mean = sum / stats.count;
+    if (stats.count < 2)
+        return stats;
+
+    double squares = 0.0;
+    for (double sample : samples)
+        squares += (sample - stats.mean) * (sample - stats.mean);
+    stats.stddev = sqrt(squares / (stats.count - 1));
+
+    const int degrees = stats.count - 1;
+    const double t = degrees <= 30 ? c_t95[degrees - 1] : 1.960;
+    stats.ci95 = t * stats.stddev / sqrt(double(stats.count));
+    return stats;
+}
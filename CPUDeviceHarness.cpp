@@ -0,0 +1,132 @@
+// Runs test.slang end to end on slang-gfx's CPU device: create the device, build the compute pipeline, bind Data,
+// dispatch, read back and check. Needs no GPU, so it works as a headless correctness and performance check.
+//
+// Reports the one off costs (device creation, program load, first dispatch) separately from steady state dispatch
+// latency (one group) and throughput (one thread per element).
+//
+// If the autotune run mode stored a group size for csmain on this machine, the kernel is compiled with it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "GfxCompute.h"
+#include "KernelTuning.h"
+#include "RunModes.h"
+
+using namespace gfx;
+using Slang::ComPtr;
+
+static const char*  c_moduleName            = "test";
+static const char*  c_entryPointName        = "csmain";
+static const char*  c_dataParameterName     = "Data";
+static const int    c_defaultElementCount   = 1 << 16;
+static const int    c_defaultRepeatCount    = 100;
+static const float  c_initialValue          = 1.0f;     // csmain writes 0, so anything left at this wasn't written
+
+int RunCPUDeviceHarness(int argc, char** argv)
+{
+    const int elementCount = argc > 1 ? atoi(argv[1]) : c_defaultElementCount;
+    const int repeatCount = argc > 2 ? atoi(argv[2]) : c_defaultRepeatCount;
+    if (elementCount < 1 || repeatCount < 1)
+    {
+        printf("Element and repeat counts must be at least 1.\n");
+        return 1;
+    }
+
+    printf("CPU device harness: %s:%s, %i elements, best of %i runs\n\n", c_moduleName, c_entryPointName, elementCount, repeatCount);
+
+    TuningDatabase tuning;
+    TuningResult tuned;
+    std::vector<std::string> macroValues;
+    std::vector<slang::PreprocessorMacroDesc> macros;
+    IDevice::Desc deviceDesc = {};
+    const TuningKey tuningKey = { std::string(c_moduleName) + ":" + c_entryPointName, "cpu", GetTuningMachineName() };
+    if (tuning.load(c_tuningFileName) && tuning.find(tuningKey, tuned))
+    {
+        GetTunedGroupSizeMacros(tuned, macroValues, macros);
+        deviceDesc.slang.preprocessorMacros = macros.data();
+        deviceDesc.slang.preprocessorMacroCount = GfxCount(macros.size());
+        printf("    %-40s %i, from %s\n", "tuned group size", tuned.groupSize[0], c_tuningFileName);
+    }
+
+    Timer timer;
+    GfxComputeContext context;
+    if (SLANG_FAILED(CreateGfxComputeContext(DeviceType::CPU, context, &deviceDesc)))
+    {
+        printf("Could not create a CPU device.\n");
+        return 1;
+    }
+    printf("    %-40s %10.3f ms\n", "device creation", timer.elapsedMs());
+
+    timer.reset();
+    GfxComputeKernel kernel;
+    if (SLANG_FAILED(LoadComputeKernel(context.device, c_moduleName, c_entryPointName, kernel)))
+    {
+        printf("Could not load %s:%s.\n", c_moduleName, c_entryPointName);
+        return 1;
+    }
+    printf("    %-40s %10.3f ms\n", "program and pipeline creation", timer.elapsedMs());
+
+    // csmain doesn't check bounds, so the buffer covers the last group whole
+    const int threadsPerGroup = int(kernel.numThreads[0] * kernel.numThreads[1] * kernel.numThreads[2]);
+    const int groupCount = (elementCount + threadsPerGroup - 1) / threadsPerGroup;
+    const size_t bufferCount = size_t(groupCount) * size_t(threadsPerGroup);
+
+    const std::vector<float> initialData(bufferCount, c_initialValue);
+    ComPtr<IBufferResource> buffer;
+    ComPtr<IResourceView> view;
+    if (SLANG_FAILED(CreateFloatBuffer(context.device, bufferCount, initialData.data(), buffer.writeRef(), view.writeRef())))
+    {
+        printf("Could not create the %s buffer.\n", c_dataParameterName);
+        return 1;
+    }
+
+    // The first dispatch includes any work the device defers until the kernel is first run
+    timer.reset();
+    if (SLANG_FAILED(DispatchAndWait(context, kernel, c_dataParameterName, view, groupCount)))
+    {
+        printf("Dispatch failed.\n");
+        return 1;
+    }
+    printf("    %-40s %10.3f ms\n", "first dispatch", timer.elapsedMs());
+
+    int failures = 0;
+    {
+        ComPtr<ISlangBlob> readback;
+        if (SLANG_FAILED(context.device->readBufferResource(buffer, 0, Size(elementCount) * sizeof(float), readback.writeRef())))
+        {
+            printf("Could not read back the %s buffer.\n", c_dataParameterName);
+            return 1;
+        }
+
+        const float* values = (const float*)readback->getBufferPointer();
+        for (int i = 0; i < elementCount; i++)
+        {
+            if (values[i] != 0.0f)
+            {
+                printf("    ERROR: %s[%i] is %f, expected 0\n", c_dataParameterName, i, values[i]);
+                failures++;
+                break;
+            }
+        }
+        printf("    %-40s %s\n", "readback check", failures ? "FAILED" : "OK");
+    }
+
+    printf("\n");
+    double ms = TimeBestMs(repeatCount, [&]()
+    {
+        DispatchAndWait(context, kernel, c_dataParameterName, view, 1);
+    });
+    PrintBenchResult("dispatch latency, 1 group", ms, 1.0, "dispatches");
+
+    ms = TimeBestMs(repeatCount, [&]()
+    {
+        DispatchAndWait(context, kernel, c_dataParameterName, view, groupCount);
+    });
+    PrintBenchResult("dispatch throughput, all elements", ms, double(elementCount), "elements");
+
+    return failures ? 1 : 0;
+}
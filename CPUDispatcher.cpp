@@ -0,0 +1,132 @@
+#include "CPUDispatcher.h"
+
+CPUDispatcher::CPUDispatcher(int threadCount, bool useScratchArenas)
+    : m_useScratchArenas(useScratchArenas)
+    , m_nextGroup(0)
+{
+    if (threadCount <= 0)
+        threadCount = int(std::thread::hardware_concurrency());
+    if (threadCount <= 0)
+        threadCount = 1;
+
+    for (int i = 0; i < threadCount; i++)
+        m_workers.emplace_back(new Worker);
+    for (auto& worker : m_workers)
+        worker->thread = std::thread(&CPUDispatcher::_workerMain, this, worker.get());
+}
+
+CPUDispatcher::~CPUDispatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_jobReady.notify_all();
+    for (auto& worker : m_workers)
+        worker->thread.join();
+}
+
+void CPUDispatcher::dispatch(ComputeFunc func, const uint3& groupCount, void* uniformEntryPointParams, void* uniformState)
+{
+    // Waiting for the workers below lets go of m_mutex, so another caller must not get in and replace the job
+    std::lock_guard<std::mutex> dispatchLock(m_dispatchMutex);
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_job.func = func;
+    m_job.groupCount = groupCount;
+    m_job.uniformEntryPointParams = uniformEntryPointParams;
+    m_job.uniformState = uniformState;
+    m_totalGroupCount = uint64_t(groupCount.x) * groupCount.y * groupCount.z;
+    m_nextGroup.store(0, std::memory_order_relaxed);
+
+    m_busyWorkerCount = int(m_workers.size());
+    m_jobGeneration++;
+    m_jobReady.notify_all();
+
+    m_jobDone.wait(lock, [this]() { return m_busyWorkerCount == 0; });
+}
+
+size_t CPUDispatcher::getScratchHighWaterBytes() const
+{
+    size_t highWater = 0;
+    for (const auto& worker : m_workers)
+    {
+        if (worker->arena.getHighWaterBytes() > highWater)
+            highWater = worker->arena.getHighWaterBytes();
+    }
+    return highWater;
+}
+
+std::vector<KernelCounters> CPUDispatcher::getKernelCounters() const
+{
+    std::vector<KernelCounters> total;
+    for (const auto& worker : m_workers)
+    {
+        const std::vector<KernelCounters>& counters = worker->counters.getCounters();
+        if (counters.size() > total.size())
+            total.resize(counters.size());
+        for (size_t id = 0; id < counters.size(); id++)
+            total[id].add(counters[id]);
+    }
+    return total;
+}
+
+void CPUDispatcher::resetKernelCounters()
+{
+    for (auto& worker : m_workers)
+        worker->counters.reset();
+}
+
+void CPUDispatcher::_workerMain(Worker* worker)
+{
+    if (m_useScratchArenas)
+        ScratchArena::current() = &worker->arena;
+    KernelCounterTable::current() = &worker->counters;
+
+    uint64_t seenGeneration = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobReady.wait(lock, [&]() { return m_quit || m_jobGeneration != seenGeneration; });
+            if (m_quit)
+                break;
+            seenGeneration = m_jobGeneration;
+        }
+
+        _runGroups(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busyWorkerCount == 0)
+                m_jobDone.notify_one();
+        }
+    }
+
+    ScratchArena::current() = nullptr;
+    KernelCounterTable::current() = nullptr;
+}
+
+void CPUDispatcher::_runGroups(Worker* worker)
+{
+    const Job& job = m_job;
+    for (;;)
+    {
+        const uint64_t groupIndex = m_nextGroup.fetch_add(1, std::memory_order_relaxed);
+        if (groupIndex >= m_totalGroupCount)
+            break;
+
+        ComputeVaryingInput varyingInput;
+        varyingInput.startGroupID.x = uint32_t(groupIndex % job.groupCount.x);
+        varyingInput.startGroupID.y = uint32_t((groupIndex / job.groupCount.x) % job.groupCount.y);
+        varyingInput.startGroupID.z = uint32_t(groupIndex / (uint64_t(job.groupCount.x) * job.groupCount.y));
+        varyingInput.endGroupID.x = varyingInput.startGroupID.x + 1;
+        varyingInput.endGroupID.y = varyingInput.startGroupID.y + 1;
+        varyingInput.endGroupID.z = varyingInput.startGroupID.z + 1;
+
+        job.func(&varyingInput, job.uniformEntryPointParams, job.uniformState);
+
+        if (m_useScratchArenas)
+            worker->arena.reset();
+    }
+}
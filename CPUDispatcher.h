@@ -0,0 +1,77 @@
+#pragma once
+
+// Runs a CPU target ComputeFunc over a grid of groups on a pool of worker threads.
+//
+// Workers take groups one at a time from a shared counter, so uneven groups balance out. Each worker owns a
+// ScratchArena that is bound to the thread while it runs kernels and reset after every group, and a
+// KernelCounterTable that counted entry points (KernelCounters.h) add to.
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "KernelCounters.h"
+#include "ScratchArena.h"
+
+class CPUDispatcher
+{
+public:
+    /// A threadCount of 0 uses one thread per hardware thread.
+    explicit CPUDispatcher(int threadCount = 0, bool useScratchArenas = true);
+    ~CPUDispatcher();
+
+    CPUDispatcher(const CPUDispatcher&) = delete;
+    CPUDispatcher& operator=(const CPUDispatcher&) = delete;
+
+    /// Runs `func` for every group in [0, groupCount) and returns when all have finished. Threads calling it at once
+    /// take turns, one dispatch at a time. Must not be called from a kernel this dispatcher is running.
+    void dispatch(ComputeFunc func, const uint3& groupCount, void* uniformEntryPointParams, void* uniformState);
+
+    int getThreadCount() const { return int(m_workers.size()); }
+    bool usesScratchArenas() const { return m_useScratchArenas; }
+
+    /// Largest amount of scratch memory any worker used for a single group.
+    size_t getScratchHighWaterBytes() const;
+
+    /// The counters of every counted entry point, summed over the workers, indexed by entry point id. Call between
+    /// dispatches.
+    std::vector<KernelCounters> getKernelCounters() const;
+    void resetKernelCounters();
+
+protected:
+    struct Worker
+    {
+        std::thread         thread;
+        ScratchArena        arena;
+        KernelCounterTable  counters;
+    };
+
+    struct Job
+    {
+        ComputeFunc     func;
+        uint3           groupCount;
+        void*           uniformEntryPointParams;
+        void*           uniformState;
+    };
+
+    void _workerMain(Worker* worker);
+    void _runGroups(Worker* worker);
+
+    bool                                    m_useScratchArenas;
+    std::vector<std::unique_ptr<Worker>>    m_workers;
+
+    std::mutex                              m_dispatchMutex;    ///< Held for a whole dispatch, as there's one m_job
+    std::mutex                              m_mutex;
+    std::condition_variable                 m_jobReady;
+    std::condition_variable                 m_jobDone;
+    uint64_t                                m_jobGeneration = 0;
+    int                                     m_busyWorkerCount = 0;
+    bool                                    m_quit = false;
+
+    Job                                     m_job = {};
+    std::atomic<uint64_t>                   m_nextGroup;
+    uint64_t                                m_totalGroupCount = 0;
+};
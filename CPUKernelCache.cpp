@@ -0,0 +1,300 @@
+#include "CPUKernelCache.h"
+
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "SlangHelpers.h"
+#include "StringBlob.h"
+
+using Slang::ComPtr;
+
+namespace fs = std::filesystem;
+
+static const char* c_searchPaths[] = { "." };
+
+static std::string ToHex(const void* data, size_t size)
+{
+    static const char c_digits[] = "0123456789abcdef";
+    const uint8_t* bytes = (const uint8_t*)data;
+    std::string hex;
+    for (size_t i = 0; i < size; i++)
+    {
+        hex += c_digits[bytes[i] >> 4];
+        hex += c_digits[bytes[i] & 15];
+    }
+    return hex;
+}
+
+static bool ReadTextFile(const std::string& fileName, std::string& outText)
+{
+    FILE* file = nullptr;
+    fopen_s(&file, fileName.c_str(), "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    outText.resize(size_t(ftell(file)));
+    fseek(file, 0, SEEK_SET);
+    const size_t readSize = outText.empty() ? 0 : fread(&outText[0], 1, outText.size(), file);
+    fclose(file);
+    return readSize == outText.size();
+}
+
+/// Identifies a kernel by what it's compiled from: the hashed source, slang build tag and entry point, then the names.
+static std::string MakeSourceKey(const char* moduleName, const std::string& source, const char* entryPointName)
+{
+    const char* buildTag = spGetBuildTagString();
+    uint64_t hash = HashBytes(c_fnvOffsetBasis, source.data(), source.size());
+    hash = HashBytes(hash, buildTag, strlen(buildTag) + 1);
+    hash = HashBytes(hash, entryPointName, strlen(entryPointName) + 1);
+    return HashToHex(hash) + " " + moduleName + " " + entryPointName;
+}
+
+CPUKernelCache::CPUKernelCache(const char* directory)
+    : m_directory(directory)
+{
+    slang_createGlobalSessionWithoutStdLib(SLANG_API_VERSION, m_loaderSession.writeRef());
+    _readIndex();
+}
+
+CPUKernelCacheStats CPUKernelCache::getStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+SlangResult CPUKernelCache::getKernel(const char* moduleName, const std::string& source, const char* entryPointName,
+    CPUKernel& outKernel, std::string& outDiagnostics)
+{
+    outDiagnostics.clear();
+    std::string moduleSource = source;
+    if (moduleSource.empty() && !ReadTextFile(std::string(moduleName) + ".slang", moduleSource))
+    {
+        outDiagnostics = std::string("Could not read ") + moduleName + ".slang.\n";
+        return SLANG_E_NOT_FOUND;
+    }
+    const std::string key = MakeSourceKey(moduleName, moduleSource, entryPointName);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto loaded = m_loaded.find(key);
+    if (loaded != m_loaded.end())
+    {
+        m_stats.memoryHits++;
+        outKernel = loaded->second;
+        return SLANG_OK;
+    }
+
+    // A library that's in the index but won't load (deleted, corrupt, or from another platform) is compiled again, and
+    // written over
+    auto indexed = m_index.find(key);
+    if (indexed != m_index.end() && SLANG_SUCCEEDED(_loadLibrary(indexed->second, entryPointName, outKernel)))
+    {
+        m_stats.diskHits++;
+        m_loaded[key] = outKernel;
+        return SLANG_OK;
+    }
+
+    const SlangResult result = _compile(moduleName, moduleSource, entryPointName, outKernel, outDiagnostics);
+    if (SLANG_FAILED(result))
+    {
+        m_stats.failures++;
+        return result;
+    }
+    m_stats.compiles++;
+    m_loaded[key] = outKernel;
+    if (indexed == m_index.end() || indexed->second != outKernel.entryPointHash)
+    {
+        m_index[key] = outKernel.entryPointHash;
+        _appendIndex(key, outKernel.entryPointHash);
+    }
+    return SLANG_OK;
+}
+
+bool CPUKernelCache::_readIndex()
+{
+    std::string text;
+    if (!ReadTextFile((fs::path(m_directory) / c_kernelCacheIndexFileName).string(), text))
+        return false;
+
+    // sourceHash entryPointHash module entryPoint, where the key is the line without the entry point hash. Later lines win.
+    size_t lineStart = 0;
+    while (lineStart < text.size())
+    {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = text.size();
+        std::string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        const size_t first = line.find(' ');
+        const size_t second = first == std::string::npos ? std::string::npos : line.find(' ', first + 1);
+        if (second == std::string::npos)
+            continue;
+        m_index[line.substr(0, first) + line.substr(second)] = line.substr(first + 1, second - first - 1);
+    }
+    return true;
+}
+
+void CPUKernelCache::_appendIndex(const std::string& key, const std::string& entryPointHash)
+{
+    const std::string indexPath = (fs::path(m_directory) / c_kernelCacheIndexFileName).string();
+    std::error_code error;
+    const bool newIndex = !fs::exists(indexPath, error);
+
+    FILE* file = nullptr;
+    fopen_s(&file, indexPath.c_str(), "ab");
+    if (!file)
+        return;
+    if (newIndex)
+        fprintf(file, "# sourceHash entryPointHash module entryPoint\n");
+    const size_t first = key.find(' ');
+    fprintf(file, "%s %s%s\n", key.substr(0, first).c_str(), entryPointHash.c_str(), key.substr(first).c_str());
+    fclose(file);
+}
+
+std::string CPUKernelCache::_getLibraryLoadPath(const std::string& entryPointHash) const
+{
+    // The loader adds the platform's prefix and extension
+    return (fs::path(m_directory) / entryPointHash).string();
+}
+
+SlangResult CPUKernelCache::_loadLibrary(const std::string& entryPointHash, const char* entryPointName, CPUKernel& outKernel)
+{
+    if (!m_loaderSession)
+        return SLANG_FAIL;
+    ISlangSharedLibraryLoader* loader = m_loaderSession->getSharedLibraryLoader();
+    if (!loader)
+        return SLANG_FAIL;
+
+    ComPtr<ISlangSharedLibrary> library;
+    const SlangResult result = loader->loadSharedLibrary(_getLibraryLoadPath(entryPointHash).c_str(), library.writeRef());
+    ComputeFunc func = SLANG_SUCCEEDED(result) ? (ComputeFunc)library->findFuncByName(entryPointName) : nullptr;
+    if (!func)
+    {
+        m_unloadableHashes.insert(entryPointHash);
+        return SLANG_FAILED(result) ? result : SLANG_E_NOT_FOUND;
+    }
+    m_unloadableHashes.erase(entryPointHash);
+
+    outKernel.func = func;
+    outKernel.library = library;
+    outKernel.entryPointHash = entryPointHash;
+    return SLANG_OK;
+}
+
+SlangResult CPUKernelCache::_compile(const char* moduleName, const std::string& source, const char* entryPointName,
+    CPUKernel& outKernel, std::string& outDiagnostics)
+{
+    if (!m_session)
+    {
+        if (!m_globalSession && SLANG_FAILED(slang_createGlobalSession(SLANG_API_VERSION, m_globalSession.writeRef())))
+        {
+            outDiagnostics += "Could not create a slang global session.\n";
+            return SLANG_FAIL;
+        }
+
+        slang::TargetDesc targetDesc;
+        targetDesc.format = SLANG_SHADER_SHARED_LIBRARY;
+
+        slang::SessionDesc sessionDesc;
+        sessionDesc.targets = &targetDesc;
+        sessionDesc.targetCount = 1;
+        sessionDesc.searchPaths = c_searchPaths;
+        sessionDesc.searchPathCount = SlangInt(sizeof(c_searchPaths) / sizeof(c_searchPaths[0]));
+        SLANG_RETURN_ON_FAIL(m_globalSession->createSession(sessionDesc, m_session.writeRef()));
+    }
+
+    // Modules stay in the session, so every compile gets its own name: a kernel's source may have changed since it
+    // was last loaded under its module name
+    const std::string uniqueName = std::string(moduleName) + "_" + std::to_string(m_stats.compiles + m_stats.failures);
+    const std::string path = std::string(moduleName) + ".slang";
+    ComPtr<ISlangBlob> sourceBlob = StringBlob::createCopy(source.c_str());
+    ComPtr<ISlangBlob> diagnostics;
+    slang::IModule* module = m_session->loadModuleFromSource(uniqueName.c_str(), path.c_str(), sourceBlob, diagnostics.writeRef());
+    AppendDiagnostics(outDiagnostics, diagnostics);
+    if (!module)
+        return SLANG_FAIL;
+
+    ComPtr<slang::IEntryPoint> entryPoint;
+    if (SLANG_FAILED(module->findEntryPointByName(entryPointName, entryPoint.writeRef())))
+    {
+        outDiagnostics += std::string("No entry point named ") + entryPointName + ".\n";
+        return SLANG_E_NOT_FOUND;
+    }
+
+    slang::IComponentType* components[] = { module, entryPoint };
+    ComPtr<slang::IComponentType> composite;
+    ComPtr<slang::IComponentType> linked;
+    SlangResult result = m_session->createCompositeComponentType(components, 2, composite.writeRef(), diagnostics.writeRef());
+    AppendDiagnostics(outDiagnostics, diagnostics);
+    if (SLANG_SUCCEEDED(result))
+    {
+        result = composite->link(linked.writeRef(), diagnostics.writeRef());
+        AppendDiagnostics(outDiagnostics, diagnostics);
+    }
+    SLANG_RETURN_ON_FAIL(result);
+
+    ComPtr<ISlangBlob> hash;
+    linked->getEntryPointHash(0, 0, hash.writeRef());
+    if (!hash || !hash->getBufferSize())
+    {
+        outDiagnostics += "Slang gave no entry point hash.\n";
+        return SLANG_FAIL;
+    }
+    const std::string entryPointHash = ToHex(hash->getBufferPointer(), hash->getBufferSize());
+
+    // Runs the downstream C++ compiler
+    ComPtr<ISlangBlob> library;
+    result = linked->getEntryPointCode(0, 0, library.writeRef(), diagnostics.writeRef());
+    AppendDiagnostics(outDiagnostics, diagnostics);
+    SLANG_RETURN_ON_FAIL(result);
+
+#ifdef _WIN32
+    const std::string fileName = entryPointHash + ".dll";
+#else
+    const std::string fileName = "lib" + entryPointHash + ".so";
+#endif
+    const fs::path libraryPath = fs::path(m_directory) / fileName;
+
+    // Written under a temporary name and renamed, so another process never loads half a library. A library with the
+    // same entry point hash is the same code, and may be loaded already, so is left alone unless it failed to load.
+    std::error_code error;
+    if (!fs::exists(libraryPath, error) || m_unloadableHashes.count(entryPointHash))
+    {
+        fs::create_directories(m_directory, error);
+        const fs::path temporaryPath = fs::path(libraryPath).concat(".tmp");
+        FILE* file = nullptr;
+        fopen_s(&file, temporaryPath.string().c_str(), "wb");
+        if (!file)
+        {
+            outDiagnostics += "Could not write " + temporaryPath.string() + ".\n";
+            return SLANG_E_CANNOT_OPEN;
+        }
+        const bool written = fwrite(library->getBufferPointer(), 1, library->getBufferSize(), file) == library->getBufferSize();
+        fclose(file);
+        if (written)
+            fs::rename(temporaryPath, libraryPath, error);
+        if (!written || error)
+        {
+            fs::remove(temporaryPath, error);
+            outDiagnostics += "Could not write " + libraryPath.string() + ".\n";
+            return SLANG_E_CANNOT_OPEN;
+        }
+    }
+
+    result = _loadLibrary(entryPointHash, entryPointName, outKernel);
+    if (SLANG_FAILED(result))
+        outDiagnostics += "Could not load " + libraryPath.string() + ".\n";
+    return result;
+}
+
+CPUKernelCache& GetCPUKernelCache()
+{
+    static CPUKernelCache s_cache(c_defaultKernelCacheDirectory);
+    return s_cache;
+}
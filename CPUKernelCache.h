@@ -0,0 +1,90 @@
+#pragma once
+
+// A process wide cache of CPU kernels, compiled once to shared libraries (SLANG_SHADER_SHARED_LIBRARY) and kept on
+// disk, so later runs load them instead of compiling.
+//
+// Going through spGetEntryPointHostCallable runs slang's front end and then the downstream C++ compiler every time a
+// process starts, which for hundreds of kernels takes minutes. Here, each kernel's shared library is written to the
+// cache directory, named after its entry point hash (IComponentType::getEntryPointHash), and loaded with the global
+// session's ISlangSharedLibraryLoader:
+//   <directory>/<entryPointHash>.dll       on Windows
+//   <directory>/lib<entryPointHash>.so     elsewhere
+//
+// The entry point hash is only known once slang has loaded and linked the module, which is most of the front end's
+// cost. So the directory also has index.txt, mapping a hash of the module source, entry point name and slang build
+// tag to the entry point hash:
+//   sourceHash entryPointHash module entryPoint
+// A kernel in the index whose library loads is started without slang compiling anything. One whose library doesn't
+// load is compiled again and its library written over. Only the module's own source is hashed, not modules it
+// imports; change an imported module and clear the cache.
+//
+// Loading needs a global session for its shared library loader, but not the standard library, so the one the cache
+// starts with is created without it. The full global session is created on the first miss.
+//
+// Slang's sessions aren't thread safe, so getKernel() holds a lock for the whole lookup, including any compile.
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "slang/slang.h"
+#include "slang/slang-com-ptr.h"
+
+#include "CPUPrelude.h"
+
+static const char* const c_defaultKernelCacheDirectory  = "out_kernels";
+static const char* const c_kernelCacheIndexFileName     = "index.txt";
+
+struct CPUKernel
+{
+    ComputeFunc                             func = nullptr;
+    Slang::ComPtr<ISlangSharedLibrary>      library;            ///< Keeps func loaded
+    std::string                             entryPointHash;     ///< Hex, names the library in the cache directory
+};
+
+struct CPUKernelCacheStats
+{
+    int     memoryHits = 0;     ///< Already loaded in this process
+    int     diskHits = 0;       ///< Loaded from the cache directory
+    int     compiles = 0;
+    int     failures = 0;
+};
+
+class CPUKernelCache
+{
+public:
+    explicit CPUKernelCache(const char* directory);
+
+    CPUKernelCache(const CPUKernelCache&) = delete;
+    CPUKernelCache& operator=(const CPUKernelCache&) = delete;
+
+    /// The kernel for entryPointName in module moduleName, whose source is given, loading or compiling it as needed.
+    /// If source is empty the module is read from <moduleName>.slang in the working directory.
+    SlangResult getKernel(const char* moduleName, const std::string& source, const char* entryPointName,
+        CPUKernel& outKernel, std::string& outDiagnostics);
+
+    const std::string& getDirectory() const { return m_directory; }
+    CPUKernelCacheStats getStats();
+
+protected:
+    bool _readIndex();
+    void _appendIndex(const std::string& key, const std::string& entryPointHash);
+    std::string _getLibraryLoadPath(const std::string& entryPointHash) const;
+    SlangResult _loadLibrary(const std::string& entryPointHash, const char* entryPointName, CPUKernel& outKernel);
+    SlangResult _compile(const char* moduleName, const std::string& source, const char* entryPointName,
+        CPUKernel& outKernel, std::string& outDiagnostics);
+
+    std::string                                     m_directory;
+    std::mutex                                      m_mutex;
+    Slang::ComPtr<slang::IGlobalSession>            m_loaderSession;    ///< Without the standard library, only for loading
+    Slang::ComPtr<slang::IGlobalSession>            m_globalSession;    ///< Created on the first compile
+    Slang::ComPtr<slang::ISession>                  m_session;
+    std::map<std::string, std::string>              m_index;            ///< Entry point hash by source key
+    std::map<std::string, CPUKernel>                m_loaded;           ///< By source key
+    std::set<std::string>                           m_unloadableHashes; ///< Libraries that failed to load, to write over
+    CPUKernelCacheStats                             m_stats;
+};
+
+/// The process wide cache, in c_defaultKernelCacheDirectory. Created on first use.
+CPUKernelCache& GetCPUKernelCache();
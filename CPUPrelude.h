@@ -0,0 +1,25 @@
+#pragma once
+
+// Host side code includes the CPU prelude through this header.
+//
+// slang-cpp-prelude.h is written for the single translation unit a kernel is emitted into, and defines a few
+// functions without `inline`. The CPU runtime headers here are included from several translation units, so those
+// definitions are made inline while the prelude is included, instead of clashing at link time.
+//
+// The prelude can follow slang.h but not precede it, so slang.h always comes first. The two macros both define
+// (to the same effect) are dropped so the prelude's versions don't warn.
+
+#include "slang/slang.h"
+
+#undef SLANG_BREAKPOINT
+#undef SLANG_OFFSET_OF
+
+#define f32tof16 inline f32tof16
+#define f16tof32 inline f16tof32
+#define InterlockedAdd inline InterlockedAdd
+
+#include "slang/prelude/slang-cpp-prelude.h"
+
+#undef f32tof16
+#undef f16tof32
+#undef InterlockedAdd
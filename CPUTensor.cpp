@@ -0,0 +1,181 @@
+#include "CPUTensor.h"
+
+#include <string.h>
+
+// Calls func(tensorElement, contiguousOffset) for every row of the innermost dimension, in row major order.
+// `func` copies `rowLength` elements between the strided row and the contiguous buffer.
+template <typename FUNC>
+static void ForEachTensorRow(const HostTensor& tensor, FUNC&& func)
+{
+    const size_t elementSize = GetTensorScalarSize(tensor.type);
+    const int64_t elementCount = tensor.getElementCount();
+    if (elementCount == 0)
+        return;
+    if (tensor.dimensionCount == 0)
+    {
+        func((uint8_t*)tensor.data, size_t(0), int64_t(1), int64_t(1));
+        return;
+    }
+
+    const int inner = tensor.dimensionCount - 1;
+    const int64_t rowLength = tensor.sizes[inner];
+    const int64_t innerStride = tensor.strides[inner];
+    int64_t index[kHostTensorMaxDim] = {};
+    for (int64_t row = 0; row < elementCount / rowLength; row++)
+    {
+        int64_t offset = 0;
+        for (int i = 0; i < inner; i++)
+            offset += index[i] * tensor.strides[i];
+        func((uint8_t*)tensor.data + offset * int64_t(elementSize), size_t(row * rowLength) * elementSize, rowLength, innerStride);
+
+        for (int i = inner - 1; i >= 0; i--)
+        {
+            if (++index[i] < tensor.sizes[i])
+                break;
+            index[i] = 0;
+        }
+    }
+}
+
+void GatherTensor(const HostTensor& tensor, void* contiguous)
+{
+    const size_t elementSize = GetTensorScalarSize(tensor.type);
+    ForEachTensorRow(tensor, [&](const uint8_t* src, size_t dstOffset, int64_t rowLength, int64_t stride)
+    {
+        uint8_t* dst = (uint8_t*)contiguous + dstOffset;
+        if (stride == 1)
+        {
+            memcpy(dst, src, size_t(rowLength) * elementSize);
+            return;
+        }
+        for (int64_t i = 0; i < rowLength; i++)
+            memcpy(dst + size_t(i) * elementSize, src + i * stride * int64_t(elementSize), elementSize);
+    });
+}
+
+void ScatterTensor(const HostTensor& tensor, const void* contiguous)
+{
+    const size_t elementSize = GetTensorScalarSize(tensor.type);
+    ForEachTensorRow(tensor, [&](uint8_t* dst, size_t srcOffset, int64_t rowLength, int64_t stride)
+    {
+        const uint8_t* src = (const uint8_t*)contiguous + srcOffset;
+        if (stride == 1)
+        {
+            memcpy(dst, src, size_t(rowLength) * elementSize);
+            return;
+        }
+        for (int64_t i = 0; i < rowLength; i++)
+            memcpy(dst + i * stride * int64_t(elementSize), src + size_t(i) * elementSize, elementSize);
+    });
+}
+
+int CollapseTensorDimensions(HostTensor* tensors, int tensorCount)
+{
+    if (tensorCount <= 0)
+        return 0;
+
+    // Dimensions of size 1 don't affect addressing
+    const int dimensionCount = tensors[0].dimensionCount;
+    int kept = 0;
+    for (int i = 0; i < dimensionCount; i++)
+    {
+        if (tensors[0].sizes[i] == 1)
+            continue;
+        for (int t = 0; t < tensorCount; t++)
+        {
+            tensors[t].sizes[kept] = tensors[t].sizes[i];
+            tensors[t].strides[kept] = tensors[t].strides[i];
+        }
+        kept++;
+    }
+
+    // Fold each dimension into the one after it when every tensor steps over the inner one exactly
+    int collapsed = 0;
+    for (int i = 0; i < kept; i++)
+    {
+        bool merge = collapsed > 0;
+        for (int t = 0; t < tensorCount && merge; t++)
+            merge = tensors[t].strides[collapsed - 1] == tensors[t].strides[i] * tensors[t].sizes[i];
+
+        for (int t = 0; t < tensorCount; t++)
+        {
+            if (merge)
+            {
+                tensors[t].sizes[collapsed - 1] *= tensors[t].sizes[i];
+                tensors[t].strides[collapsed - 1] = tensors[t].strides[i];
+            }
+            else
+            {
+                tensors[t].sizes[collapsed] = tensors[t].sizes[i];
+                tensors[t].strides[collapsed] = tensors[t].strides[i];
+            }
+        }
+        if (!merge)
+            collapsed++;
+    }
+
+    for (int t = 0; t < tensorCount; t++)
+        tensors[t].dimensionCount = collapsed;
+    return collapsed;
+}
+
+bool CPUTensorBinding::bind(const HostTensor& tensor, TensorScalarType expectedType, const char* name, std::string& outError)
+{
+    m_tensor = tensor;
+    m_view = {};
+    m_staging.clear();
+
+    if (tensor.type != expectedType)
+    {
+        outError = std::string(name) + ": tensor is not of the expected type.";
+        return false;
+    }
+    if (tensor.dimensionCount < 0 || tensor.dimensionCount > kCPUTensorMaxDim)
+    {
+        outError = std::string(name) + ": number of dimensions exceeds limit (" + std::to_string(kCPUTensorMaxDim) + ")";
+        return false;
+    }
+    if (!tensor.data)
+    {
+        outError = std::string(name) + ": data pointer is invalid.";
+        return false;
+    }
+
+    const size_t elementSize = GetTensorScalarSize(tensor.type);
+    const bool aligned = uintptr_t(tensor.data) % elementSize == 0;
+    const bool zeroCopy = aligned && tensor.isContiguous();
+
+    // A staging copy is always contiguous, so the view's strides are either the tensor's own or row major
+    int64_t stride = int64_t(elementSize);
+    for (int i = tensor.dimensionCount - 1; i >= 0; i--)
+    {
+        const int64_t byteStride = zeroCopy ? tensor.strides[i] * int64_t(elementSize) : stride;
+        if (tensor.sizes[i] > int64_t(UINT32_MAX) || byteStride < 0 || byteStride > int64_t(UINT32_MAX))
+        {
+            outError = std::string(name) + ": tensor is too large for 32 bit strides.";
+            return false;
+        }
+        m_view.sizes[i] = uint32_t(tensor.sizes[i]);
+        m_view.strides[i] = uint32_t(byteStride);
+        stride *= tensor.sizes[i];
+    }
+    m_view.dimensionCount = uint32_t(tensor.dimensionCount);
+
+    if (zeroCopy)
+    {
+        m_view.data = (uint8_t*)tensor.data;
+        return true;
+    }
+
+    const size_t byteCount = size_t(tensor.getElementCount()) * elementSize;
+    m_staging.resize((byteCount + sizeof(uint64_t) - 1) / sizeof(uint64_t) + 1);
+    GatherTensor(tensor, m_staging.data());
+    m_view.data = (uint8_t*)m_staging.data();
+    return true;
+}
+
+void CPUTensorBinding::commit()
+{
+    if (!m_staging.empty())
+        ScatterTensor(m_tensor, m_staging.data());
+}
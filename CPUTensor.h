@@ -0,0 +1,314 @@
+#pragma once
+
+// Runs TensorView based kernels on the CPU, for machines without CUDA.
+//
+// The torch prelude's make_tensor_view() only accepts CUDA tensors. This is the CPU side of the same binding: a
+// HostTensor describes a tensor in host memory (pointer, element type, and sizes and strides in elements, as torch
+// reports them), and CPUTensorBinding turns it into a CPUTensorView for kernels dispatched on CPUDispatcher.
+// CPUTensorView has the prelude TensorView's layout (byte strides) and the CUDA prelude's load/store accessors.
+//
+// A tensor that is contiguous and aligned for its element type is bound in place, with no copy. Anything else, such
+// as a transposed or sliced tensor, is gathered into a contiguous staging copy. commit() writes that copy back if the
+// kernel wrote to it.
+//
+// CPUTensorView keeps the prelude's 32 bit byte strides and 5 dimensions, so it can't address tensors over 4 GB or
+// with more dimensions. CPUTensorViewN<RANK> is the view for those: 64 bit byte strides and a compile time rank, so
+// the index math unrolls. Before making one, CollapseTensorDimensions() merges dimensions that are laid out
+// contiguously with the next one in every operand. A contiguous tensor of any rank becomes one dimension, and inner
+// loops index with a single stride instead of recomputing a multi dimensional offset per element.
+//
+// When building as a torch extension, MakeHostTensor() fills a HostTensor from a CPU torch::Tensor, throwing on the
+// same conditions make_tensor_view() does.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef TORCH_EXTENSION_NAME
+#include <stdexcept>
+#include <torch/extension.h>
+#endif
+
+static const int kCPUTensorMaxDim = 5;     // kSlangTorchTensorMaxDim
+static const int kHostTensorMaxDim = 16;
+
+enum class TensorScalarType
+{
+    Int8,
+    UInt8,
+    Int16,
+    BFloat16,
+    Int32,
+    Float32,
+    Int64,
+    Float64,
+};
+
+inline size_t GetTensorScalarSize(TensorScalarType type)
+{
+    switch (type)
+    {
+        case TensorScalarType::Int8:
+        case TensorScalarType::UInt8:       return 1;
+        case TensorScalarType::Int16:
+        case TensorScalarType::BFloat16:    return 2;
+        case TensorScalarType::Int32:
+        case TensorScalarType::Float32:     return 4;
+        case TensorScalarType::Int64:
+        case TensorScalarType::Float64:     return 8;
+        default:                            return 0;
+    }
+}
+
+/// A tensor in host memory. Sizes and strides are in elements.
+struct HostTensor
+{
+    void*               data = nullptr;
+    TensorScalarType    type = TensorScalarType::Float32;
+    int                 dimensionCount = 0;
+    int64_t             sizes[kHostTensorMaxDim] = {};
+    int64_t             strides[kHostTensorMaxDim] = {};
+
+    int64_t getElementCount() const
+    {
+        int64_t count = 1;
+        for (int i = 0; i < dimensionCount; i++)
+            count *= sizes[i];
+        return count;
+    }
+
+    /// True if the elements are packed in row major order. Dimensions of size 1 can have any stride.
+    bool isContiguous() const
+    {
+        int64_t expectedStride = 1;
+        for (int i = dimensionCount - 1; i >= 0; i--)
+        {
+            if (sizes[i] != 1 && strides[i] != expectedStride)
+                return false;
+            expectedStride *= sizes[i];
+        }
+        return true;
+    }
+
+    /// A contiguous row major tensor over `data`.
+    static HostTensor contiguous(void* data, TensorScalarType type, int dimensionCount, const int64_t* sizes)
+    {
+        HostTensor tensor;
+        tensor.data = data;
+        tensor.type = type;
+        tensor.dimensionCount = dimensionCount;
+        int64_t stride = 1;
+        for (int i = dimensionCount - 1; i >= 0; i--)
+        {
+            tensor.sizes[i] = sizes[i];
+            tensor.strides[i] = stride;
+            stride *= sizes[i];
+        }
+        return tensor;
+    }
+};
+
+/// The prelude's TensorView, with the CUDA prelude's accessors. Strides are in bytes.
+struct CPUTensorView
+{
+    uint8_t* data;
+    uint32_t strides[kCPUTensorMaxDim];
+    uint32_t sizes[kCPUTensorMaxDim];
+    uint32_t dimensionCount;
+
+    template <typename T>
+    T* data_ptr() const
+    {
+        return reinterpret_cast<T*>(data);
+    }
+
+    template <typename T>
+    T* data_ptr_at(uint32_t index) const
+    {
+        return reinterpret_cast<T*>(data + uint64_t(strides[0]) * index);
+    }
+
+    template <typename T>
+    T& load(uint32_t x) const
+    {
+        return *reinterpret_cast<T*>(data + uint64_t(strides[0]) * x);
+    }
+    template <typename T>
+    T& load(uint32_t x, uint32_t y) const
+    {
+        return *reinterpret_cast<T*>(data + uint64_t(strides[0]) * x + uint64_t(strides[1]) * y);
+    }
+    template <typename T>
+    T& load(uint32_t x, uint32_t y, uint32_t z) const
+    {
+        return *reinterpret_cast<T*>(data + uint64_t(strides[0]) * x + uint64_t(strides[1]) * y + uint64_t(strides[2]) * z);
+    }
+    template <typename T>
+    T& load(uint32_t x, uint32_t y, uint32_t z, uint32_t w) const
+    {
+        return *reinterpret_cast<T*>(data + uint64_t(strides[0]) * x + uint64_t(strides[1]) * y + uint64_t(strides[2]) * z + uint64_t(strides[3]) * w);
+    }
+
+    template <typename T>
+    void store(uint32_t x, T val) const
+    {
+        load<T>(x) = val;
+    }
+    template <typename T>
+    void store(uint32_t x, uint32_t y, T val) const
+    {
+        load<T>(x, y) = val;
+    }
+    template <typename T>
+    void store(uint32_t x, uint32_t y, uint32_t z, T val) const
+    {
+        load<T>(x, y, z) = val;
+    }
+    template <typename T>
+    void store(uint32_t x, uint32_t y, uint32_t z, uint32_t w, T val) const
+    {
+        load<T>(x, y, z, w) = val;
+    }
+};
+
+class CPUTensorBinding
+{
+public:
+    /// Binds `tensor` as `name` (used in errors). Returns false with `outError` set if it is not of `expectedType`,
+    /// has too many dimensions, or doesn't fit the view's 32 bit strides.
+    bool bind(const HostTensor& tensor, TensorScalarType expectedType, const char* name, std::string& outError);
+
+    const CPUTensorView& getView() const { return m_view; }
+
+    /// True if the view points at the tensor's own memory.
+    bool isZeroCopy() const { return m_staging.empty(); }
+
+    /// Copies the staging copy back into the tensor, for tensors the kernel wrote. Does nothing when zero copy.
+    void commit();
+
+protected:
+    HostTensor              m_tensor;
+    CPUTensorView           m_view = {};
+    std::vector<uint64_t>   m_staging;      ///< uint64_t, so the copy is aligned for every element type
+};
+
+/// A view with 64 bit byte strides and a compile time rank. Strides can be negative.
+template <int RANK>
+struct CPUTensorViewN
+{
+    static_assert(RANK >= 1, "a view has at least one dimension");
+
+    uint8_t*    data;
+    int64_t     strides[RANK];
+    uint64_t    sizes[RANK];
+
+    template <typename... INDICES>
+    int64_t getOffset(INDICES... indices) const
+    {
+        static_assert(sizeof...(INDICES) == RANK, "one index per dimension");
+        const uint64_t index[RANK] = { uint64_t(indices)... };
+        int64_t offset = 0;
+        for (int i = 0; i < RANK; i++)
+            offset += int64_t(index[i]) * strides[i];
+        return offset;
+    }
+
+    template <typename T, typename... INDICES>
+    T& load(INDICES... indices) const
+    {
+        return *reinterpret_cast<T*>(data + getOffset(indices...));
+    }
+
+    /// The value comes first, since the number of indices is the rank.
+    template <typename T, typename... INDICES>
+    void store(T val, INDICES... indices) const
+    {
+        load<T>(indices...) = val;
+    }
+
+    uint64_t getElementCount() const
+    {
+        uint64_t count = 1;
+        for (int i = 0; i < RANK; i++)
+            count *= sizes[i];
+        return count;
+    }
+};
+
+/// Merges dimensions of `tensors`, which must all have the same sizes, wherever a dimension is laid out contiguously
+/// with the next one in every tensor, and drops dimensions of size 1. Indexing the result in row major order visits
+/// the same elements in the same order. Returns the new dimension count.
+int CollapseTensorDimensions(HostTensor* tensors, int tensorCount);
+
+/// Makes a rank RANK view of `tensor`, named `name` in errors. A tensor with fewer dimensions gets leading dimensions
+/// of size 1. Returns false with `outError` set if it has more than RANK dimensions or isn't of `expectedType`.
+template <int RANK>
+bool MakeTensorViewN(const HostTensor& tensor, TensorScalarType expectedType, const char* name, CPUTensorViewN<RANK>& outView, std::string& outError)
+{
+    if (tensor.type != expectedType)
+    {
+        outError = std::string(name) + ": tensor is not of the expected type.";
+        return false;
+    }
+    if (tensor.dimensionCount > RANK)
+    {
+        outError = std::string(name) + ": " + std::to_string(tensor.dimensionCount) + " dimensions don't fit a rank " + std::to_string(RANK) + " view.";
+        return false;
+    }
+    if (!tensor.data)
+    {
+        outError = std::string(name) + ": data pointer is invalid.";
+        return false;
+    }
+
+    const int64_t elementSize = int64_t(GetTensorScalarSize(tensor.type));
+    const int padding = RANK - tensor.dimensionCount;
+    outView.data = (uint8_t*)tensor.data;
+    for (int i = 0; i < RANK; i++)
+    {
+        outView.sizes[i] = i < padding ? 1 : uint64_t(tensor.sizes[i - padding]);
+        outView.strides[i] = i < padding ? 0 : tensor.strides[i - padding] * elementSize;
+    }
+    return true;
+}
+
+/// Copies between a strided tensor and a contiguous buffer of its elements in row major order.
+void GatherTensor(const HostTensor& tensor, void* contiguous);
+void ScatterTensor(const HostTensor& tensor, const void* contiguous);
+
+#ifdef TORCH_EXTENSION_NAME
+
+/// Describes a CPU torch tensor. Throws if it isn't on the CPU or isn't of `targetScalarType`, like make_tensor_view().
+inline HostTensor MakeHostTensor(const torch::Tensor& val, const char* name, torch::ScalarType targetScalarType)
+{
+    if (!val.device().is_cpu())
+        throw std::runtime_error(std::string(name).append(": tensor is not on the CPU."));
+    if (val.dtype() != targetScalarType)
+        throw std::runtime_error(std::string(name).append(": tensor is not of the expected type."));
+    if (val.dim() > kHostTensorMaxDim)
+        throw std::runtime_error(std::string(name).append(": number of dimensions exceeds limit (").append(std::to_string(kHostTensorMaxDim)).append(")"));
+
+    HostTensor tensor;
+    switch (val.scalar_type())
+    {
+        case torch::kInt8:      tensor.type = TensorScalarType::Int8; break;
+        case torch::kUInt8:     tensor.type = TensorScalarType::UInt8; break;
+        case torch::kInt16:     tensor.type = TensorScalarType::Int16; break;
+        case torch::kBFloat16:  tensor.type = TensorScalarType::BFloat16; break;
+        case torch::kInt32:     tensor.type = TensorScalarType::Int32; break;
+        case torch::kFloat32:   tensor.type = TensorScalarType::Float32; break;
+        case torch::kInt64:     tensor.type = TensorScalarType::Int64; break;
+        case torch::kFloat64:   tensor.type = TensorScalarType::Float64; break;
+        default: throw std::runtime_error(std::string(name).append(": unsupported tensor type."));
+    }
+    tensor.data = val.data_ptr();
+    tensor.dimensionCount = int(val.dim());
+    for (int i = 0; i < tensor.dimensionCount; i++)
+    {
+        tensor.sizes[i] = val.size(i);
+        tensor.strides[i] = val.stride(i);
+    }
+    return tensor;
+}
+
+#endif
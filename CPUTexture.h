@@ -0,0 +1,368 @@
+#pragma once
+
+// A concrete CPU implementation of the prelude's ITexture, so CPU target kernels that use Texture2D have
+// something to read from.
+//
+// Texels are stored as floats, either row linear or in 8x8 tiles with Morton (Z-order) ordering inside
+// each tile. With the tiled layout a bilinear footprint, and the footprints of neighbouring threads,
+// mostly land in the same cache lines no matter which direction the kernel walks the image.
+// The whole mip chain is built with a box filter when the texture is created.
+
+#include <vector>
+#include <string.h>
+
+#include "CPUPrelude.h"
+
+enum class TextureLayout
+{
+    Linear,
+    MortonTiled,
+};
+
+enum class TextureFilter
+{
+    Point,
+    Bilinear,
+    Trilinear,
+};
+
+enum class TextureAddressMode
+{
+    Wrap,
+    Clamp,
+};
+
+/// ITexture extended with batched sampling, so the virtual call is paid once per batch rather than once per texel.
+/// `locs` holds `count` float2 coordinates, `outData` receives `count` elements of `elementSize` bytes each.
+struct IBatchedTexture : ITexture
+{
+    virtual void SampleLevelN(const float* locs, size_t count, float level, void* outData, size_t elementSize) = 0;
+};
+
+class CPUTexture2D final : public IBatchedTexture
+{
+public:
+    static const int kTileShift = 3;
+    static const int kTileSize = 1 << kTileShift;
+    static const int kTileTexelCount = kTileSize * kTileSize;
+
+    /// `texels` is `width * height * channelCount` floats, row linear. Mips are generated when `generateMips` is set.
+    CPUTexture2D(
+        uint32_t width,
+        uint32_t height,
+        int channelCount,
+        const float* texels,
+        TextureLayout layout = TextureLayout::MortonTiled,
+        TextureFilter filter = TextureFilter::Bilinear,
+        TextureAddressMode addressMode = TextureAddressMode::Wrap,
+        bool generateMips = true)
+        : m_channelCount(channelCount)
+        , m_layout(layout)
+        , m_filter(filter)
+        , m_addressMode(addressMode)
+    {
+        // Build the mip chain row linear first, then copy each level into the storage layout
+        std::vector<std::vector<float>> levels;
+        levels.emplace_back(texels, texels + size_t(width) * height * channelCount);
+
+        uint32_t levelWidth = width;
+        uint32_t levelHeight = height;
+        _addLevel(levelWidth, levelHeight);
+        while (generateMips && (levelWidth > 1 || levelHeight > 1))
+        {
+            uint32_t nextWidth = levelWidth > 1 ? levelWidth / 2 : 1;
+            uint32_t nextHeight = levelHeight > 1 ? levelHeight / 2 : 1;
+            levels.push_back(_downsample(levels.back(), levelWidth, levelHeight, nextWidth, nextHeight));
+            levelWidth = nextWidth;
+            levelHeight = nextHeight;
+            _addLevel(levelWidth, levelHeight);
+        }
+
+        m_texels.resize(m_texelCount * m_channelCount, 0.0f);
+        for (size_t levelIndex = 0; levelIndex < m_levels.size(); levelIndex++)
+        {
+            const Level& level = m_levels[levelIndex];
+            const float* src = levels[levelIndex].data();
+            for (uint32_t y = 0; y < level.height; y++)
+            {
+                for (uint32_t x = 0; x < level.width; x++)
+                {
+                    memcpy(_texel(level, x, y), src, sizeof(float) * m_channelCount);
+                    src += m_channelCount;
+                }
+            }
+        }
+    }
+
+    struct Level
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t tileCountX;
+        size_t   texelOffset;
+    };
+
+    int getLevelCount() const { return int(m_levels.size()); }
+    const Level& getLevel(int levelIndex) const { return m_levels[levelIndex]; }
+    int getChannelCount() const { return m_channelCount; }
+    TextureLayout getLayout() const { return m_layout; }
+    TextureFilter getFilter() const { return m_filter; }
+    TextureAddressMode getAddressMode() const { return m_addressMode; }
+    const float* getTexelData() const { return m_texels.data(); }
+    size_t getSizeInBytes() const { return m_texels.size() * sizeof(float); }
+
+    // ITexture
+    virtual TextureDimensions GetDimensions(int mipLevel = -1) override
+    {
+        const Level& level = m_levels[(mipLevel < 0 || mipLevel >= getLevelCount()) ? 0 : mipLevel];
+
+        TextureDimensions dims;
+        dims.reset();
+        dims.shape = SLANG_TEXTURE_2D;
+        dims.width = level.width;
+        dims.height = level.height;
+        dims.depth = 1;
+        dims.numberOfLevels = uint32_t(getLevelCount());
+        return dims;
+    }
+
+    virtual void Load(const int32_t* v, void* outData, size_t dataSize) override
+    {
+        float texel[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        const int32_t mip = v[2];
+        if (mip >= 0 && mip < getLevelCount())
+        {
+            const Level& level = m_levels[mip];
+            if (uint32_t(v[0]) < level.width && uint32_t(v[1]) < level.height)
+            {
+                memcpy(texel, _texel(level, uint32_t(v[0]), uint32_t(v[1])), sizeof(float) * m_channelCount);
+            }
+        }
+        _write(texel, outData, dataSize);
+    }
+
+    virtual void Sample(SamplerState samplerState, const float* loc, void* outData, size_t dataSize) override
+    {
+        // There are no derivatives on the CPU target, so an implicit lod sample reads the top level
+        (void)samplerState;
+        float texel[4];
+        _sampleLevel(loc[0], loc[1], 0.0f, texel);
+        _write(texel, outData, dataSize);
+    }
+
+    virtual void SampleLevel(SamplerState samplerState, const float* loc, float level, void* outData, size_t dataSize) override
+    {
+        (void)samplerState;
+        float texel[4];
+        _sampleLevel(loc[0], loc[1], level, texel);
+        _write(texel, outData, dataSize);
+    }
+
+    // IBatchedTexture
+    virtual void SampleLevelN(const float* locs, size_t count, float level, void* outData, size_t elementSize) override
+    {
+        // Mip selection is done once for the whole batch
+        int level0;
+        float fracLevel;
+        _selectLevel(level, level0, fracLevel);
+
+        char* out = (char*)outData;
+        for (size_t i = 0; i < count; i++)
+        {
+            float texel[4];
+            _sampleMips(level0, fracLevel, locs[i * 2 + 0], locs[i * 2 + 1], texel);
+            _write(texel, out + i * elementSize, elementSize);
+        }
+    }
+
+protected:
+    void _addLevel(uint32_t width, uint32_t height)
+    {
+        Level level;
+        level.width = width;
+        level.height = height;
+        level.tileCountX = (width + kTileSize - 1) >> kTileShift;
+        level.texelOffset = m_texelCount;
+        m_levels.push_back(level);
+
+        if (m_layout == TextureLayout::MortonTiled)
+        {
+            uint32_t tileCountY = (height + kTileSize - 1) >> kTileShift;
+            m_texelCount += size_t(level.tileCountX) * tileCountY * kTileTexelCount;
+        }
+        else
+        {
+            m_texelCount += size_t(width) * height;
+        }
+    }
+
+    static std::vector<float> _downsample(const std::vector<float>& src, uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight)
+    {
+        // A plain 2x2 box filter. Odd sizes drop the last row/column, as D3D does for its own mip generation.
+        const int channelCount = int(src.size() / (size_t(srcWidth) * srcHeight));
+        std::vector<float> dst(size_t(dstWidth) * dstHeight * channelCount);
+        for (uint32_t y = 0; y < dstHeight; y++)
+        {
+            uint32_t y0 = y * 2 < srcHeight ? y * 2 : srcHeight - 1;
+            uint32_t y1 = y0 + 1 < srcHeight ? y0 + 1 : y0;
+            for (uint32_t x = 0; x < dstWidth; x++)
+            {
+                uint32_t x0 = x * 2 < srcWidth ? x * 2 : srcWidth - 1;
+                uint32_t x1 = x0 + 1 < srcWidth ? x0 + 1 : x0;
+                for (int c = 0; c < channelCount; c++)
+                {
+                    float sum =
+                        src[(size_t(y0) * srcWidth + x0) * channelCount + c] +
+                        src[(size_t(y0) * srcWidth + x1) * channelCount + c] +
+                        src[(size_t(y1) * srcWidth + x0) * channelCount + c] +
+                        src[(size_t(y1) * srcWidth + x1) * channelCount + c];
+                    dst[(size_t(y) * dstWidth + x) * channelCount + c] = sum * 0.25f;
+                }
+            }
+        }
+        return dst;
+    }
+
+    /// Spreads the low 3 bits of v so that bit i moves to bit 2i, for Morton ordering within a tile.
+    static SLANG_FORCE_INLINE uint32_t _spreadBits(uint32_t v)
+    {
+        static const uint8_t table[kTileSize] = { 0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15 };
+        return table[v & (kTileSize - 1)];
+    }
+
+    SLANG_FORCE_INLINE float* _texel(const Level& level, uint32_t x, uint32_t y)
+    {
+        size_t index;
+        if (m_layout == TextureLayout::MortonTiled)
+        {
+            size_t tileIndex = size_t(y >> kTileShift) * level.tileCountX + (x >> kTileShift);
+            index = tileIndex * kTileTexelCount + (_spreadBits(x) | (_spreadBits(y) << 1));
+        }
+        else
+        {
+            index = size_t(y) * level.width + x;
+        }
+        return &m_texels[(level.texelOffset + index) * m_channelCount];
+    }
+
+    SLANG_FORCE_INLINE uint32_t _address(int32_t v, uint32_t size) const
+    {
+        if (m_addressMode == TextureAddressMode::Wrap)
+        {
+            // Most textures are a power of two in size, and a mask is much cheaper than a division
+            if ((size & (size - 1)) == 0)
+                return uint32_t(v) & (size - 1);
+            int32_t wrapped = v % int32_t(size);
+            return uint32_t(wrapped < 0 ? wrapped + int32_t(size) : wrapped);
+        }
+        return uint32_t(v < 0 ? 0 : (v >= int32_t(size) ? int32_t(size) - 1 : v));
+    }
+
+    void _sampleMip(int levelIndex, float u, float v, float outTexel[4])
+    {
+        const Level& level = m_levels[levelIndex];
+        const float x = u * level.width - 0.5f;
+        const float y = v * level.height - 0.5f;
+
+        if (m_filter == TextureFilter::Point)
+        {
+            const float* texel = _texel(level, _address(int32_t(floorf(x + 0.5f)), level.width), _address(int32_t(floorf(y + 0.5f)), level.height));
+            for (int c = 0; c < m_channelCount; c++)
+                outTexel[c] = texel[c];
+            return;
+        }
+
+        const float floorX = floorf(x);
+        const float floorY = floorf(y);
+        const float fracX = x - floorX;
+        const float fracY = y - floorY;
+        const uint32_t x0 = _address(int32_t(floorX), level.width);
+        const uint32_t x1 = _address(int32_t(floorX) + 1, level.width);
+        const uint32_t y0 = _address(int32_t(floorY), level.height);
+        const uint32_t y1 = _address(int32_t(floorY) + 1, level.height);
+
+        const float* t00 = _texel(level, x0, y0);
+        const float* t10 = _texel(level, x1, y0);
+        const float* t01 = _texel(level, x0, y1);
+        const float* t11 = _texel(level, x1, y1);
+        for (int c = 0; c < m_channelCount; c++)
+        {
+            float top = t00[c] + (t10[c] - t00[c]) * fracX;
+            float bottom = t01[c] + (t11[c] - t01[c]) * fracX;
+            outTexel[c] = top + (bottom - top) * fracY;
+        }
+    }
+
+    /// Picks the mip (and for trilinear filtering the blend towards the next mip) for a lod.
+    SLANG_FORCE_INLINE void _selectLevel(float level, int& outLevel0, float& outFracLevel) const
+    {
+        const float maxLevel = float(getLevelCount() - 1);
+        level = level < 0.0f ? 0.0f : (level > maxLevel ? maxLevel : level);
+
+        if (m_filter != TextureFilter::Trilinear)
+        {
+            outLevel0 = int(level + 0.5f);
+            outFracLevel = 0.0f;
+            return;
+        }
+        outLevel0 = int(level);
+        outFracLevel = level - float(outLevel0);
+    }
+
+    SLANG_FORCE_INLINE void _sampleMips(int level0, float fracLevel, float u, float v, float outTexel[4])
+    {
+        _sampleMip(level0, u, v, outTexel);
+        if (fracLevel > 0.0f)
+        {
+            float texel1[4];
+            _sampleMip(level0 + 1, u, v, texel1);
+            for (int c = 0; c < m_channelCount; c++)
+                outTexel[c] += (texel1[c] - outTexel[c]) * fracLevel;
+        }
+    }
+
+    SLANG_FORCE_INLINE void _sampleLevel(float u, float v, float level, float outTexel[4])
+    {
+        int level0;
+        float fracLevel;
+        _selectLevel(level, level0, fracLevel);
+        _sampleMips(level0, fracLevel, u, v, outTexel);
+    }
+
+    /// Writes a texel to an output of `dataSize` bytes. Missing channels read as (0, 0, 0, 1) like on the GPU.
+    SLANG_FORCE_INLINE void _write(float texel[4], void* outData, size_t dataSize) const
+    {
+        for (int c = m_channelCount; c < 4; c++)
+            texel[c] = (c == 3) ? 1.0f : 0.0f;
+        memcpy(outData, texel, dataSize < sizeof(float) * 4 ? dataSize : sizeof(float) * 4);
+    }
+
+    int                 m_channelCount;
+    TextureLayout       m_layout;
+    TextureFilter       m_filter;
+    TextureAddressMode  m_addressMode;
+    std::vector<Level>  m_levels;
+    size_t              m_texelCount = 0;
+    std::vector<float>  m_texels;
+};
+
+/// Samples `count` locations of a texture with one virtual call if it's an IBatchedTexture (such as CPUTexture2D).
+/// Any other ITexture is sampled a location at a time.
+template <typename T>
+SLANG_FORCE_INLINE void SampleN(const Texture2D<T>& texture, const float2* locs, size_t count, float level, T* out)
+{
+    if (IBatchedTexture* batched = dynamic_cast<IBatchedTexture*>(texture.texture))
+    {
+        batched->SampleLevelN(&locs->x, count, level, out, sizeof(T));
+        return;
+    }
+    SamplerState samplerState = {};
+    for (size_t i = 0; i < count; i++)
+        texture.texture->SampleLevel(samplerState, &locs[i].x, level, &out[i], sizeof(T));
+}
+
+template <typename T>
+SLANG_FORCE_INLINE void Sample4(const Texture2D<T>& texture, const float2 locs[4], float level, T out[4])
+{
+    SampleN(texture, locs, 4, level, out);
+}
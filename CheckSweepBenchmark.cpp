@@ -0,0 +1,143 @@
+// Sweeps the permutations of a generated shader with ShaderSweep (ShaderSweep.h), as CI would: full compilation
+// against check only (SLANG_COMPILE_FLAG_NO_CODEGEN), then check only again with one permutation broken, run to the
+// end and with stop on first error.
+//
+// Given a threshold, the full compilation sweep also saves a repro of every permutation slower than it to the corpus
+// in out_repros (ReproCorpus.h), for the reproreplay run mode.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "ReproCorpus.h"
+#include "RunModes.h"
+#include "ShaderSweep.h"
+
+static const char*  c_sourcePath                = "sweep.slang";
+static const int    c_defaultPermutationCount   = 256;
+
+static const char* c_source =
+    "RWBuffer<float> Data;\n"
+    "\n"
+    "#if USE_SCALE\n"
+    "static const float c_scale = SCALE;\n"
+    "#else\n"
+    "static const float c_scale = 1.0;\n"
+    "#endif\n"
+    "\n"
+    "float shade(float x)\n"
+    "{\n"
+    "#if USE_LOOP\n"
+    "    for (int i = 0; i < LOOP_COUNT; i++)\n"
+    "        x = x * c_scale + sin(x);\n"
+    "#endif\n"
+    "#if USE_BROKEN\n"
+    "    x += missingValue;\n"
+    "#endif\n"
+    "    return x * c_scale;\n"
+    "}\n"
+    "\n"
+    "[shader(\"compute\")]\n"
+    "[numthreads(GROUP_SIZE_X, 1, 1)]\n"
+    "void csmain(uint3 DTid : SV_DispatchThreadID)\n"
+    "{\n"
+    "    Data[DTid.x] = shade(Data[DTid.x]);\n"
+    "}\n";
+
+/// Permutation p's defines come from the bits of p. If broken, USE_BROKEN makes it reference an undefined name.
+static ShaderDefines MakePermutation(int p, bool broken)
+{
+    ShaderDefines defines;
+    defines.push_back({ "USE_SCALE", std::to_string(p & 1) });
+    defines.push_back({ "USE_LOOP", std::to_string((p >> 1) & 1) });
+    defines.push_back({ "LOOP_COUNT", std::to_string(1 + (p >> 2) % 8) });
+    defines.push_back({ "GROUP_SIZE_X", std::to_string(1 << ((p >> 5) % 8)) });
+    defines.push_back({ "SCALE", std::to_string(p) + ".0" });
+    defines.push_back({ "USE_BROKEN", broken ? "1" : "0" });
+    return defines;
+}
+
+static void PrintSweep(const char* label, const ShaderSweepResult& result)
+{
+    printf("    %-34s %10.3f %9i %9i %9i %12.1f\n", label, result.ms, result.succeeded, result.failed, result.skipped,
+        double(result.codeBytes) / 1024.0);
+}
+
+static std::string FirstLine(const std::string& text)
+{
+    const size_t end = text.find_first_of("\r\n");
+    return end == std::string::npos ? text : text.substr(0, end);
+}
+
+int RunCheckSweepBenchmark(int argc, char** argv)
+{
+    const int permutationCount = argc > 1 ? atoi(argv[1]) : c_defaultPermutationCount;
+    const int threadCount = argc > 2 ? atoi(argv[2]) : 0;
+    const double reproThresholdMs = argc > 3 ? atof(argv[3]) : -1.0;
+    if (permutationCount < 1)
+    {
+        printf("Permutation count must be at least 1.\n");
+        return 1;
+    }
+
+    ShaderSweepDesc desc;
+    desc.sourcePath = c_sourcePath;
+    desc.source = c_source;
+    desc.threadCount = threadCount;
+    for (int p = 0; p < permutationCount; p++)
+        desc.permutations.push_back(MakePermutation(p, false));
+
+    printf("Permutation sweep: %i permutations of %s:%s\n\n", permutationCount, c_sourcePath, desc.entryPointName.c_str());
+    printf("    %-34s %10s %9s %9s %9s %12s\n", "sweep", "ms", "ok", "failed", "skipped", "code KB");
+
+    int failures = 0;
+    SlowCompileRecorder recorder(c_defaultReproDirectory, reproThresholdMs);
+    desc.reproRecorder = reproThresholdMs >= 0.0 ? &recorder : nullptr;
+    const ShaderSweepResult full = RunShaderSweep(desc);
+    PrintSweep("full compilation", full);
+    desc.reproRecorder = nullptr;
+
+    desc.checkOnly = true;
+    const ShaderSweepResult checked = RunShaderSweep(desc);
+    PrintSweep("check only", checked);
+    if (full.succeeded != permutationCount || checked.succeeded != permutationCount)
+    {
+        printf("    ERROR: every permutation should compile\n%s", full.failed ? full.firstFailureDiagnostics.c_str() : checked.firstFailureDiagnostics.c_str());
+        failures++;
+    }
+    if (checked.codeBytes)
+    {
+        printf("    ERROR: check only generated code\n");
+        failures++;
+    }
+
+    // One permutation a quarter of the way in is broken
+    const int broken = permutationCount / 4;
+    desc.permutations[broken] = MakePermutation(broken, true);
+    const ShaderSweepResult toEnd = RunShaderSweep(desc);
+    PrintSweep("check only, one broken", toEnd);
+
+    desc.stopOnFirstError = true;
+    const ShaderSweepResult stopped = RunShaderSweep(desc);
+    PrintSweep("check only, one broken, fail fast", stopped);
+
+    if (toEnd.failed != 1 || toEnd.firstFailure != broken || stopped.failed != 1 || stopped.firstFailure != broken)
+    {
+        printf("    ERROR: expected permutation %i, and only it, to fail\n", broken);
+        failures++;
+    }
+    if (stopped.succeeded + stopped.skipped != permutationCount - 1)
+    {
+        printf("    ERROR: the fail fast sweep lost track of permutations\n");
+        failures++;
+    }
+
+    printf("\n    %-40s %.2fx\n", "check only speedup", checked.ms > 0.0 ? full.ms / checked.ms : 0.0);
+    printf("    %-40s %.2fx\n", "fail fast speedup, one broken", stopped.ms > 0.0 ? toEnd.ms / stopped.ms : 0.0);
+    if (reproThresholdMs >= 0.0)
+        printf("    %-40s %i over %.1f ms, to %s\n", "repros saved", recorder.getRecordedCount(), reproThresholdMs, c_defaultReproDirectory);
+    if (stopped.firstFailure >= 0)
+        printf("    %-40s %i: %s\n", "first failure", stopped.firstFailure, FirstLine(stopped.firstFailureDiagnostics).c_str());
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,65 @@
+#include "CompileStrategy.h"
+
+const char* GetCompileStrategyName(CompileStrategy strategy)
+{
+    switch (strategy)
+    {
+        case CompileStrategy::PerEntryPoint:    return "per entry point";
+        case CompileStrategy::WholeProgram:     return "whole program";
+    }
+    return "unknown";
+}
+
+SlangResult CompileProgram(SlangSession* session, const ProgramCompileDesc& desc, CompileStrategy strategy, ProgramCompileOutput& outOutput)
+{
+    outOutput = ProgramCompileOutput();
+
+    SlangCompileRequest* request = spCreateCompileRequest(session);
+    spSetCodeGenTarget(request, desc.target);
+    spSetTargetProfile(request, 0, spFindProfile(session, desc.profile.c_str()));
+    if (strategy == CompileStrategy::WholeProgram)
+        spSetTargetFlags(request, 0, kDefaultTargetFlags | SLANG_TARGET_FLAG_GENERATE_WHOLE_PROGRAM);
+
+    const int translationUnitIndex = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_SLANG, "");
+    spAddTranslationUnitSourceFile(request, translationUnitIndex, desc.sourceFileName.c_str());
+    for (const std::string& name : desc.entryPointNames)
+        spAddEntryPoint(request, translationUnitIndex, name.c_str(), desc.stage);
+
+    SlangResult result = spCompile(request);
+    if (SLANG_SUCCEEDED(result))
+    {
+        Slang::ComPtr<ISlangBlob> program;
+        if (strategy == CompileStrategy::WholeProgram)
+        {
+            result = spGetTargetCodeBlob(request, 0, program.writeRef());
+            if (SLANG_SUCCEEDED(result))
+                outOutput.outputSize = program->getBufferSize();
+        }
+
+        for (int i = 0; i < int(desc.entryPointNames.size()) && SLANG_SUCCEEDED(result); i++)
+        {
+            EntryPointCode entryPoint;
+            entryPoint.name = desc.entryPointNames[i];
+            if (strategy == CompileStrategy::WholeProgram)
+                entryPoint.code = program;
+            else
+            {
+                result = spGetEntryPointCodeBlob(request, i, 0, entryPoint.code.writeRef());
+                if (SLANG_SUCCEEDED(result))
+                    outOutput.outputSize += entryPoint.code->getBufferSize();
+            }
+            if (SLANG_SUCCEEDED(result) && !entryPoint.code->getBufferSize())
+            {
+                outOutput.diagnostics += "No code was generated for " + entryPoint.name + ".\n";
+                result = SLANG_FAIL;
+            }
+            outOutput.entryPoints.push_back(entryPoint);
+        }
+    }
+
+    const char* diagnostics = spGetDiagnosticOutput(request);
+    if (diagnostics)
+        outOutput.diagnostics.insert(0, diagnostics);
+    spDestroyCompileRequest(request);
+    return result;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Compiles a file with many entry points in one of two ways, so a project can pick whichever is faster for it:
+//
+// PerEntryPoint: the front end runs once, then code is generated separately for each entry point and read back with
+// spGetEntryPointCodeBlob. Each output holds only what its entry point uses, but code shared between entry points is
+// generated and emitted again for each of them.
+//
+// WholeProgram: SLANG_TARGET_FLAG_GENERATE_WHOLE_PROGRAM generates one output holding every entry point, read back
+// with spGetTargetCodeBlob. It is split per entry point by reference: every entry point gets the same blob and selects
+// itself from it by name, as a DXIL library or a SPIR-V module with several entry points is used. Shared code is
+// generated and stored once.
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "slang/slang.h"
+#include "slang/slang-com-ptr.h"
+
+enum class CompileStrategy
+{
+    PerEntryPoint,
+    WholeProgram,
+};
+
+const char* GetCompileStrategyName(CompileStrategy strategy);
+
+struct ProgramCompileDesc
+{
+    std::string                     sourceFileName;
+    std::vector<std::string>        entryPointNames;
+    SlangStage                      stage = SLANG_STAGE_COMPUTE;
+    SlangCompileTarget              target = SLANG_HLSL;
+    std::string                     profile = "cs_5_1";
+};
+
+struct EntryPointCode
+{
+    std::string                     name;
+    Slang::ComPtr<ISlangBlob>       code;               ///< With WholeProgram, the blob shared by every entry point
+};
+
+struct ProgramCompileOutput
+{
+    std::vector<EntryPointCode>     entryPoints;        ///< In ProgramCompileDesc::entryPointNames order
+    size_t                          outputSize = 0;     ///< Bytes of distinct output, counting a shared blob once
+    std::string                     diagnostics;
+};
+
+/// Compiles every entry point in desc with the strategy. Fails if any entry point got no code.
+SlangResult CompileProgram(SlangSession* session, const ProgramCompileDesc& desc, CompileStrategy strategy, ProgramCompileOutput& outOutput);
@@ -0,0 +1,204 @@
+// Compiles a batch of generated modules on worker threads with their diagnostics streamed through DiagnosticLog.h,
+// and reports each failing job from the main thread as soon as its first error is parsed, while the rest of the batch
+// keeps compiling.
+//
+// Every job has a warning, and every few jobs also has an error near the top of the file, ahead of a lot of code that
+// still gets checked. For each failing job the time its error was reported is compared with the time its compile
+// returned, which is the earliest spGetDiagnosticOutput could have shown it. The parsed records are checked against
+// where the generated errors are.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DiagnosticLog.h"
+#include "RunModes.h"
+
+static const char*  c_entryPointName        = "csmain";
+static const int    c_defaultJobCount       = 32;
+static const int    c_failEvery             = 4;        // every 4th job has an error
+static const int    c_functionCount         = 300;      // per module, so checking takes a while after the error
+static const int    c_errorLine             = 3;
+static const int    c_undefinedCode         = 30015;    // slang's "undefined identifier"
+static const size_t c_ringCapacity          = 1024;
+
+struct JobOutcome
+{
+    bool                                    failed = false;
+    std::chrono::steady_clock::time_point   endTime;
+};
+
+struct JobReport
+{
+    bool                                    reported = false;
+    std::chrono::steady_clock::time_point   firstErrorTime;
+    bool                                    locationOk = false;
+};
+
+static bool JobHasError(int job)
+{
+    return job % c_failEvery == c_failEvery - 1;
+}
+
+static std::string JobFileName(int job)
+{
+    return "job" + std::to_string(job) + ".slang";
+}
+
+/// Line c_errorLine uses an undefined identifier in failing jobs. csmain narrows a float to an int, a warning.
+static std::string JobSource(int job)
+{
+    std::string source = "// Generated by the diagbatch run mode\nRWBuffer<float> Data;\n";
+    source += JobHasError(job) ? "static const float c_scale = undefinedScale;\n" : "static const float c_scale = 2.0;\n";
+    for (int i = 0; i < c_functionCount; i++)
+    {
+        source += "float helper" + std::to_string(i) + "(float x)\n{\n";
+        source += "    float y = x * c_scale + " + std::to_string(i) + ".0;\n";
+        source += "    for (int i = 0; i < 4; i++)\n        y = y * 0.5 + sin(y);\n    return y;\n}\n";
+    }
+    source += "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\nvoid csmain(uint3 DTid : SV_DispatchThreadID)\n{\n";
+    source += "    int truncated = Data[DTid.x];\n";
+    source += "    Data[DTid.x] = helper0(Data[DTid.x]) + helper" + std::to_string(c_functionCount - 1) + "(truncated);\n}\n";
+    return source;
+}
+
+static double MsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int RunDiagnosticBatchBenchmark(int argc, char** argv)
+{
+    const int jobCount = argc > 1 ? atoi(argv[1]) : c_defaultJobCount;
+    int threadCount = argc > 2 ? atoi(argv[2]) : 0;
+    if (jobCount < 1)
+    {
+        printf("Job count must be at least 1.\n");
+        return 1;
+    }
+    if (threadCount <= 0)
+        threadCount = int(std::thread::hardware_concurrency()) > 0 ? int(std::thread::hardware_concurrency()) : 1;
+
+    printf("Streamed diagnostics: %i jobs of %i functions, every %ith failing, on %i threads\n\n",
+        jobCount, c_functionCount, c_failEvery, threadCount);
+
+    DiagnosticRing ring(c_ringCapacity);
+    const size_t count = size_t(jobCount);
+    std::vector<JobOutcome> outcomes(count);
+    std::vector<std::string> sources;
+    for (int job = 0; job < jobCount; job++)
+        sources.push_back(JobSource(job));
+
+    std::atomic<int> nextJob{ 0 };
+    std::atomic<int> finishedCount{ 0 };
+    const std::chrono::steady_clock::time_point batchStart = std::chrono::steady_clock::now();
+
+    // The legacy API's sessions aren't thread safe, so each worker has its own
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back([&]()
+        {
+            SlangSession* session = spCreateSession(NULL);
+            for (int job = nextJob++; job < jobCount; job = nextJob++)
+            {
+                SlangCompileRequest* request = spCreateCompileRequest(session);
+                DiagnosticStream stream(ring, uint64_t(job));
+                stream.attach(request);
+
+                spSetCodeGenTarget(request, SLANG_HLSL);
+                spSetTargetProfile(request, 0, spFindProfile(session, "cs_5_1"));
+                const int translationUnitIndex = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_SLANG, "");
+                const std::string fileName = JobFileName(job);
+                spAddTranslationUnitSourceString(request, translationUnitIndex, fileName.c_str(), sources[job].c_str());
+                spAddEntryPoint(request, translationUnitIndex, c_entryPointName, SLANG_STAGE_COMPUTE);
+
+                const SlangResult result = spCompile(request);
+                stream.flush();
+
+                JobOutcome& outcome = outcomes[job];
+                outcome.endTime = std::chrono::steady_clock::now();
+                outcome.failed = SLANG_FAILED(result);
+                spDestroyCompileRequest(request);
+                finishedCount++;
+            }
+            spDestroySession(session);
+        });
+    }
+
+    // Drain the ring while the batch runs, reporting a job at its first error
+    std::vector<JobReport> reports(count);
+    int warningCount = 0;
+    DiagnosticRecord record;
+    for (;;)
+    {
+        const bool finished = finishedCount.load() == jobCount;
+        if (!ring.tryPop(record))
+        {
+            if (finished)
+                break;
+            std::this_thread::yield();
+            continue;
+        }
+
+        if (record.severity == DiagnosticSeverity::Warning)
+            warningCount++;
+        JobReport& report = reports[size_t(record.jobId)];
+        if (!record.isError() || report.reported)
+            continue;
+        report.reported = true;
+        report.firstErrorTime = record.time;
+        report.locationOk = record.line == c_errorLine && record.code == c_undefinedCode && JobFileName(int(record.jobId)) == record.file;
+        printf("    %9.3f ms  job %-4llu %s(%i): %s %i: %s\n", MsBetween(batchStart, record.time), (unsigned long long)record.jobId,
+            record.file, record.line, GetDiagnosticSeverityName(record.severity), record.code, record.message);
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+
+    int failures = 0;
+    int failedJobs = 0;
+    double totalLeadMs = 0.0, minLeadMs = 0.0, maxLeadMs = 0.0;
+    for (int job = 0; job < jobCount; job++)
+    {
+        const JobOutcome& outcome = outcomes[size_t(job)];
+        const JobReport& report = reports[size_t(job)];
+        if (outcome.failed != JobHasError(job) || report.reported != JobHasError(job))
+        {
+            printf("    ERROR: job %i %s and %s, expected it to %s\n", job, outcome.failed ? "failed" : "succeeded",
+                report.reported ? "reported an error" : "reported no error", JobHasError(job) ? "fail" : "succeed");
+            failures++;
+            continue;
+        }
+        if (!report.reported)
+            continue;
+        if (!report.locationOk)
+        {
+            printf("    ERROR: job %i's error wasn't parsed as %s(%i): error %i\n", job, JobFileName(job).c_str(), c_errorLine, c_undefinedCode);
+            failures++;
+        }
+
+        // How much earlier the streamed record arrived than the compile returned
+        const double leadMs = MsBetween(report.firstErrorTime, outcome.endTime);
+        minLeadMs = failedJobs == 0 || leadMs < minLeadMs ? leadMs : minLeadMs;
+        maxLeadMs = failedJobs == 0 || leadMs > maxLeadMs ? leadMs : maxLeadMs;
+        totalLeadMs += leadMs;
+        failedJobs++;
+    }
+
+    printf("\n    %-40s %i of %i\n", "failed jobs", failedJobs, jobCount);
+    printf("    %-40s %i\n", "warnings", warningCount);
+    printf("    %-40s %llu\n", "records dropped, ring full", (unsigned long long)ring.getDroppedCount());
+    printf("    %-40s %.3f ms\n", "batch time", MsBetween(batchStart, std::chrono::steady_clock::now()));
+    if (failedJobs)
+        printf("    %-40s %.3f / %.3f / %.3f ms\n", "error lead on compile end, min/mean/max", minLeadMs, totalLeadMs / failedJobs, maxLeadMs);
+    if (warningCount < jobCount && !ring.getDroppedCount())
+    {
+        printf("    ERROR: %i warnings, expected one per job\n", warningCount);
+        failures++;
+    }
+
+    return failures ? 1 : 0;
+}
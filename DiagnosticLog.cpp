@@ -0,0 +1,211 @@
+#include "DiagnosticLog.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct SeverityPrefix
+{
+    const char*         text;
+    DiagnosticSeverity  severity;
+};
+
+// Longest first, so "fatal error" isn't taken for an "error"
+static const SeverityPrefix c_severityPrefixes[] =
+{
+    { "internal error", DiagnosticSeverity::Fatal },
+    { "fatal error", DiagnosticSeverity::Fatal },
+    { "warning", DiagnosticSeverity::Warning },
+    { "error", DiagnosticSeverity::Error },
+    { "note", DiagnosticSeverity::Note },
+};
+
+const char* GetDiagnosticSeverityName(DiagnosticSeverity severity)
+{
+    switch (severity)
+    {
+        case DiagnosticSeverity::Note:      return "note";
+        case DiagnosticSeverity::Warning:   return "warning";
+        case DiagnosticSeverity::Error:     return "error";
+        case DiagnosticSeverity::Fatal:     return "fatal";
+    }
+    return "unknown";
+}
+
+static void CopyTruncated(char* dest, size_t destSize, const char* src, size_t length)
+{
+    if (length >= destSize)
+        length = destSize - 1;
+    memcpy(dest, src, length);
+    dest[length] = 0;
+}
+
+bool ParseDiagnosticLine(const char* line, size_t length, DiagnosticRecord& outRecord)
+{
+    const char* end = line + length;
+    const char* pos = line;
+
+    // Optional location: "file(line): ", where the file name may itself contain parentheses
+    int lineNumber = 0;
+    const char* fileEnd = line;
+    for (const char* p = line; p + 2 < end; p++)
+    {
+        if (p[0] != ')' || p[1] != ':' || p[2] != ' ')
+            continue;
+        const char* open = p;
+        while (open > line && isdigit((unsigned char)open[-1]))
+            open--;
+        if (open == p || open == line || open[-1] != '(')
+            continue;
+        lineNumber = atoi(open);
+        fileEnd = open - 1;
+        pos = p + 3;
+        break;
+    }
+
+    const SeverityPrefix* prefix = nullptr;
+    for (const SeverityPrefix& candidate : c_severityPrefixes)
+    {
+        const size_t prefixLength = strlen(candidate.text);
+        if (size_t(end - pos) > prefixLength && memcmp(pos, candidate.text, prefixLength) == 0 && pos[prefixLength] == ' ')
+        {
+            prefix = &candidate;
+            pos += prefixLength + 1;
+            break;
+        }
+    }
+    if (!prefix || pos == end || !isdigit((unsigned char)*pos))
+        return false;
+
+    int code = 0;
+    while (pos < end && isdigit((unsigned char)*pos))
+        code = code * 10 + (*pos++ - '0');
+    if (pos == end || *pos != ':')
+        return false;
+    pos++;
+    while (pos < end && *pos == ' ')
+        pos++;
+
+    outRecord.severity = prefix->severity;
+    outRecord.code = code;
+    outRecord.line = lineNumber;
+    CopyTruncated(outRecord.file, sizeof(outRecord.file), line, size_t(fileEnd - line));
+    CopyTruncated(outRecord.message, sizeof(outRecord.message), pos, size_t(end - pos));
+    return true;
+}
+
+DiagnosticRing::DiagnosticRing(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size *= 2;
+    m_slots = std::vector<Slot>(size);
+    m_mask = size - 1;
+    for (size_t i = 0; i < size; i++)
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool DiagnosticRing::tryPush(const DiagnosticRecord& record)
+{
+    size_t position = m_pushPosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Slot& slot = m_slots[position & m_mask];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const intptr_t difference = intptr_t(sequence) - intptr_t(position);
+        if (difference == 0)
+        {
+            // The slot is free for this position: claim it, fill it, then hand it to consumers
+            if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                slot.record = record;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // Still holds a record from one lap ago: full
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+            position = m_pushPosition.load(std::memory_order_relaxed);
+    }
+}
+
+bool DiagnosticRing::tryPop(DiagnosticRecord& outRecord)
+{
+    size_t position = m_popPosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Slot& slot = m_slots[position & m_mask];
+        const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const intptr_t difference = intptr_t(sequence) - intptr_t(position + 1);
+        if (difference == 0)
+        {
+            if (m_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                outRecord = slot.record;
+                slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+            return false;
+        else
+            position = m_popPosition.load(std::memory_order_relaxed);
+    }
+}
+
+void DiagnosticStream::attach(SlangCompileRequest* request)
+{
+    spSetDiagnosticCallback(request, _onDiagnostic, this);
+}
+
+void DiagnosticStream::write(const char* text)
+{
+    if (m_keepText)
+        m_text += text;
+    m_pending += text;
+
+    size_t start = 0;
+    for (;;)
+    {
+        const size_t newline = m_pending.find('\n', start);
+        if (newline == std::string::npos)
+            break;
+        size_t length = newline - start;
+        if (length && m_pending[start + length - 1] == '\r')
+            length--;
+        _parseLine(m_pending.data() + start, length);
+        start = newline + 1;
+    }
+    m_pending.erase(0, start);
+}
+
+void DiagnosticStream::flush()
+{
+    if (!m_pending.empty())
+        _parseLine(m_pending.data(), m_pending.size());
+    m_pending.clear();
+}
+
+void DiagnosticStream::_onDiagnostic(const char* message, void* userData)
+{
+    ((DiagnosticStream*)userData)->write(message);
+}
+
+void DiagnosticStream::_parseLine(const char* line, size_t length)
+{
+    DiagnosticRecord record;
+    if (!ParseDiagnosticLine(line, length, record))
+        return;
+
+    record.jobId = m_jobId;
+    record.time = std::chrono::steady_clock::now();
+    m_recordCount++;
+    if (record.isError())
+        m_errorCount++;
+    m_ring.tryPush(record);
+}
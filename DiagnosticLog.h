@@ -0,0 +1,122 @@
+#pragma once
+
+// Streams compiler diagnostics out of many concurrent compiles as they are reported, instead of each compile's
+// diagnostics arriving as one string after spCompile returns.
+//
+// A DiagnosticStream is attached to each compile request with spSetDiagnosticCallback. Slang calls it as each
+// diagnostic is emitted; it splits the text into lines, parses the first line of each diagnostic into a
+// DiagnosticRecord (file, line, severity, code, message), tags it with the job id and pushes it into a DiagnosticRing.
+// The ring is a bounded lock-free queue that any number of compiling threads push into and any thread drains, so a
+// failing job can be reported while the rest of the batch keeps compiling.
+//
+// Records are fixed size so pushing never allocates. When the ring is full, records are dropped and counted rather
+// than blocking a compile on whoever drains the ring.
+
+#include <atomic>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "slang/slang.h"
+
+enum class DiagnosticSeverity
+{
+    Note,
+    Warning,
+    Error,
+    Fatal,          ///< "fatal error" and "internal error": compilation stopped
+};
+
+const char* GetDiagnosticSeverityName(DiagnosticSeverity severity);
+
+struct DiagnosticRecord
+{
+    static const size_t kMaxFileLength      = 256;
+    static const size_t kMaxMessageLength   = 512;
+
+    uint64_t                                jobId = 0;
+    DiagnosticSeverity                      severity = DiagnosticSeverity::Note;
+    int                                     code = 0;
+    int                                     line = 0;           ///< 0 if the diagnostic has no location
+    std::chrono::steady_clock::time_point   time;               ///< When it was reported
+    char                                    file[kMaxFileLength] = {};
+    char                                    message[kMaxMessageLength] = {};   ///< Truncated if longer
+
+    bool isError() const { return severity == DiagnosticSeverity::Error || severity == DiagnosticSeverity::Fatal; }
+};
+
+/// Parses a line of slang's diagnostic output, "file(line): severity code: message", with the location optional.
+/// False for the lines that follow a diagnostic (the source line it points at and the caret under it).
+bool ParseDiagnosticLine(const char* line, size_t length, DiagnosticRecord& outRecord);
+
+/// A bounded multi producer, multi consumer queue of records: each slot has a sequence number saying whose turn it
+/// is, so producers and consumers claim slots with one compare and swap on their position.
+class DiagnosticRing
+{
+public:
+    /// The capacity is rounded up to a power of two.
+    explicit DiagnosticRing(size_t capacity);
+
+    DiagnosticRing(const DiagnosticRing&) = delete;
+    DiagnosticRing& operator=(const DiagnosticRing&) = delete;
+
+    /// False, and the record is counted as dropped, if the ring is full.
+    bool tryPush(const DiagnosticRecord& record);
+    bool tryPop(DiagnosticRecord& outRecord);
+
+    uint64_t getDroppedCount() const { return m_droppedCount.load(std::memory_order_relaxed); }
+
+protected:
+    struct Slot
+    {
+        std::atomic<size_t>     sequence;
+        DiagnosticRecord        record;
+    };
+
+    std::vector<Slot>           m_slots;
+    size_t                      m_mask = 0;
+    alignas(64) std::atomic<size_t>     m_pushPosition{ 0 };
+    alignas(64) std::atomic<size_t>     m_popPosition{ 0 };
+    alignas(64) std::atomic<uint64_t>   m_droppedCount{ 0 };
+};
+
+/// Receives one compile's diagnostics and pushes them into a ring as records. Used by one compile at a time.
+class DiagnosticStream
+{
+public:
+    DiagnosticStream(DiagnosticRing& ring, uint64_t jobId)
+        : m_ring(ring)
+        , m_jobId(jobId)
+    {}
+
+    /// Routes the request's diagnostics here. The stream must outlive the compile.
+    void attach(SlangCompileRequest* request);
+
+    /// Parses any complete lines in text, keeping a trailing partial line for the next call.
+    void write(const char* text);
+
+    /// Parses the partial line left over, if any. Call after the compile.
+    void flush();
+
+    /// Also keep the raw text, to fall back on when the ring dropped records. Slang gives diagnostics to the callback
+    /// instead of keeping them for spGetDiagnosticOutput.
+    void keepText() { m_keepText = true; }
+    const std::string& getText() const { return m_text; }
+
+    int getErrorCount() const { return m_errorCount; }
+    int getRecordCount() const { return m_recordCount; }
+
+protected:
+    static void _onDiagnostic(const char* message, void* userData);
+    void _parseLine(const char* line, size_t length);
+
+    DiagnosticRing&             m_ring;
+    uint64_t                    m_jobId;
+    std::string                 m_pending;
+    bool                        m_keepText = false;
+    std::string                 m_text;
+    int                         m_errorCount = 0;
+    int                         m_recordCount = 0;
+};
@@ -0,0 +1,219 @@
+// Measures the fixed CPU cost of a compute dispatch through slang-gfx on the CPU device, for a workload that
+// dispatches the same small kernel over and over.
+//
+// Each dispatch is split into phases: getting a transient heap, creating the command buffer and encoder, binding the
+// pipeline and its parameters, recording and submitting, and waiting. Three ways of doing it are compared:
+//  - fresh: a new transient heap per dispatch, parameters looked up by name and bound every time, wait every time
+//  - heap ring: a ring of transient heaps reused round robin (a heap is only waited on when it comes round again),
+//    with the parameter offset looked up once
+//  - ring + prebuilt root: as above, plus a mutable root shader object built once and bound with
+//    bindPipelineWithRootObject, so nothing is set per dispatch
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Bench.h"
+#include "GfxCompute.h"
+#include "RunModes.h"
+
+using namespace gfx;
+using Slang::ComPtr;
+
+static const char*  c_moduleName            = "test";
+static const char*  c_entryPointName        = "csmain";
+static const char*  c_dataParameterName     = "Data";
+static const int    c_defaultDispatchCount  = 10000;
+static const int    c_defaultRingSize       = 3;
+static const int    c_warmupDispatchCount   = 16;
+static const Size   c_heapConstantBytes     = 4096;
+
+enum DispatchPhase
+{
+    DispatchPhase_Heap,
+    DispatchPhase_Encoder,
+    DispatchPhase_Bind,
+    DispatchPhase_Submit,
+    DispatchPhase_Wait,
+    DispatchPhase_Count
+};
+
+static const char* c_phaseNames[DispatchPhase_Count] = { "heap", "encoder", "bind", "submit", "wait" };
+
+struct DispatchVariant
+{
+    const char*     label;
+    bool            freshHeaps;
+    bool            prebuiltRootObject;
+};
+
+struct DispatchTimes
+{
+    double          phaseMs[DispatchPhase_Count] = {};
+    double          totalMs = 0.0;
+};
+
+static bool RunDispatches(
+    GfxComputeContext& context,
+    const GfxComputeKernel& kernel,
+    IResourceView* view,
+    const DispatchVariant& variant,
+    int dispatchCount,
+    int ringSize,
+    DispatchTimes& outTimes)
+{
+    IDevice* device = context.device;
+    ITransientResourceHeap::Desc heapDesc = {};
+    heapDesc.constantBufferSize = c_heapConstantBytes;
+
+    std::vector<ComPtr<ITransientResourceHeap>> heapRing;
+    if (!variant.freshHeaps)
+    {
+        heapRing.resize(size_t(ringSize));
+        for (ComPtr<ITransientResourceHeap>& heap : heapRing)
+            SLANG_RETURN_FALSE_ON_FAIL(device->createTransientResourceHeap(heapDesc, heap.writeRef()));
+    }
+
+    ComPtr<IShaderObject> rootObject;
+    ShaderOffset dataOffset;
+    bool haveDataOffset = false;
+    if (variant.prebuiltRootObject)
+    {
+        SLANG_RETURN_FALSE_ON_FAIL(device->createMutableRootShaderObject(kernel.program, rootObject.writeRef()));
+        if (!FindShaderOffset(rootObject, c_dataParameterName, dataOffset))
+            return false;
+        rootObject->setResource(dataOffset, view);
+    }
+
+    outTimes = DispatchTimes();
+    Timer totalTimer;
+    Timer timer;
+    for (int i = 0; i < dispatchCount; i++)
+    {
+        timer.reset();
+        ComPtr<ITransientResourceHeap> heap;
+        if (variant.freshHeaps)
+        {
+            SLANG_RETURN_FALSE_ON_FAIL(device->createTransientResourceHeap(heapDesc, heap.writeRef()));
+        }
+        else
+        {
+            heap = heapRing[size_t(i % ringSize)];
+            heap->synchronizeAndReset();
+        }
+        outTimes.phaseMs[DispatchPhase_Heap] += timer.elapsedMs();
+
+        timer.reset();
+        ComPtr<ICommandBuffer> commandBuffer;
+        SLANG_RETURN_FALSE_ON_FAIL(heap->createCommandBuffer(commandBuffer.writeRef()));
+        IComputeCommandEncoder* encoder = commandBuffer->encodeComputeCommands();
+        outTimes.phaseMs[DispatchPhase_Encoder] += timer.elapsedMs();
+
+        timer.reset();
+        if (variant.prebuiltRootObject)
+        {
+            encoder->bindPipelineWithRootObject(kernel.pipeline, rootObject);
+        }
+        else
+        {
+            IShaderObject* transientRoot = encoder->bindPipeline(kernel.pipeline);
+            if (variant.freshHeaps || !haveDataOffset)
+                haveDataOffset = FindShaderOffset(transientRoot, c_dataParameterName, dataOffset);
+            transientRoot->setResource(dataOffset, view);
+        }
+        outTimes.phaseMs[DispatchPhase_Bind] += timer.elapsedMs();
+
+        timer.reset();
+        encoder->dispatchCompute(1, 1, 1);
+        encoder->endEncoding();
+        commandBuffer->close();
+        context.queue->executeCommandBuffer(commandBuffer);
+        heap->finish();
+        outTimes.phaseMs[DispatchPhase_Submit] += timer.elapsedMs();
+
+        if (variant.freshHeaps)
+        {
+            timer.reset();
+            context.queue->waitOnHost();
+            outTimes.phaseMs[DispatchPhase_Wait] += timer.elapsedMs();
+        }
+    }
+
+    timer.reset();
+    context.queue->waitOnHost();
+    outTimes.phaseMs[DispatchPhase_Wait] += timer.elapsedMs();
+    outTimes.totalMs = totalTimer.elapsedMs();
+    return true;
+}
+
+int RunDispatchOverheadBenchmark(int argc, char** argv)
+{
+    const int dispatchCount = argc > 1 ? atoi(argv[1]) : c_defaultDispatchCount;
+    const int ringSize = argc > 2 ? atoi(argv[2]) : c_defaultRingSize;
+    if (dispatchCount < 1 || ringSize < 1)
+    {
+        printf("Dispatch count and ring size must be at least 1.\n");
+        return 1;
+    }
+
+    GfxComputeContext context;
+    GfxComputeKernel kernel;
+    if (SLANG_FAILED(CreateGfxComputeContext(DeviceType::CPU, context)) ||
+        SLANG_FAILED(LoadComputeKernel(context.device, c_moduleName, c_entryPointName, kernel)))
+    {
+        printf("Could not create the CPU device and load %s:%s.\n", c_moduleName, c_entryPointName);
+        return 1;
+    }
+
+    const float initialValue = 1.0f;
+    ComPtr<IBufferResource> buffer;
+    ComPtr<IResourceView> view;
+    if (SLANG_FAILED(CreateFloatBuffer(context.device, 1, &initialValue, buffer.writeRef(), view.writeRef())))
+    {
+        printf("Could not create the %s buffer.\n", c_dataParameterName);
+        return 1;
+    }
+
+    static const DispatchVariant variants[] =
+    {
+        { "fresh",                  true,   false },
+        { "heap ring",              false,  false },
+        { "ring + prebuilt root",   false,  true },
+    };
+
+    printf("Per dispatch CPU overhead on the CPU device: %i single group dispatches, heap ring of %i\n\n", dispatchCount, ringSize);
+    printf("    %-24s", "us per dispatch");
+    for (const char* phaseName : c_phaseNames)
+        printf(" %9s", phaseName);
+    printf(" %9s %12s\n", "total", "dispatch/s");
+
+    int failures = 0;
+    for (const DispatchVariant& variant : variants)
+    {
+        DispatchTimes times;
+        if (!RunDispatches(context, kernel, view, variant, c_warmupDispatchCount, ringSize, times) ||
+            !RunDispatches(context, kernel, view, variant, dispatchCount, ringSize, times))
+        {
+            printf("    %-24s FAILED\n", variant.label);
+            failures++;
+            continue;
+        }
+
+        const double usPerDispatch = 1000.0 / double(dispatchCount);
+        printf("    %-24s", variant.label);
+        for (double phaseMs : times.phaseMs)
+            printf(" %9.3f", phaseMs * usPerDispatch);
+        printf(" %9.3f %12.0f\n", times.totalMs * usPerDispatch, double(dispatchCount) / (times.totalMs / 1000.0));
+    }
+
+    // The kernel writes Data[0] = 0 every dispatch
+    ComPtr<ISlangBlob> readback;
+    if (SLANG_FAILED(context.device->readBufferResource(buffer, 0, sizeof(float), readback.writeRef())) ||
+        *(const float*)readback->getBufferPointer() != 0.0f)
+    {
+        printf("\n    ERROR: %s[0] was not written\n", c_dataParameterName);
+        failures++;
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#elif defined(__linux__)
+#   include <poll.h>
+#   include <sys/inotify.h>
+#   include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+FileWatcher::FileWatcher()
+{
+#if defined(_WIN32)
+    m_usesNotifications = true;
+#elif defined(__linux__)
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_usesNotifications = m_inotify >= 0;
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#if defined(_WIN32)
+    for (void* handle : m_changeHandles)
+        FindCloseChangeNotification(handle);
+#elif defined(__linux__)
+    if (m_inotify >= 0)
+        close(m_inotify);
+#endif
+}
+
+std::string FileWatcher::NormalizePath(const std::string& fileName)
+{
+    std::error_code error;
+    const fs::path absolute = fs::absolute(fs::path(fileName), error);
+    return (error ? fs::path(fileName) : absolute).lexically_normal().string();
+}
+
+FileWatcher::FileState FileWatcher::_getState(const std::string& fileName)
+{
+    FileState state;
+    std::error_code error;
+    state.writeTime = fs::last_write_time(fileName, error);
+    if (error)
+        return state;
+    state.size = fs::file_size(fileName, error);
+    state.exists = !error;
+    return state;
+}
+
+void FileWatcher::setFiles(const std::vector<std::string>& fileNames)
+{
+    std::map<std::string, FileState> files;
+    for (const std::string& fileName : fileNames)
+    {
+        const std::string path = NormalizePath(fileName);
+        auto existing = m_files.find(path);
+        files[path] = existing != m_files.end() ? existing->second : _getState(path);
+        _watchDirectory(fs::path(path).parent_path().string());
+    }
+    m_files.swap(files);
+}
+
+void FileWatcher::_watchDirectory(const std::string& directory)
+{
+    // Directories stay watched once added; a notification from one no file is in any more only costs a comparison
+    if (std::find(m_directories.begin(), m_directories.end(), directory) != m_directories.end())
+        return;
+    m_directories.push_back(directory);
+
+#if defined(_WIN32)
+    // WaitForMultipleObjects takes at most MAXIMUM_WAIT_OBJECTS handles
+    HANDLE handle = m_changeHandles.size() < MAXIMUM_WAIT_OBJECTS
+        ? FindFirstChangeNotificationA(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE)
+        : INVALID_HANDLE_VALUE;
+    if (handle == INVALID_HANDLE_VALUE)
+        m_usesNotifications = false;
+    else
+        m_changeHandles.push_back(handle);
+#elif defined(__linux__)
+    if (m_inotify >= 0 && inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_ATTRIB) < 0)
+        m_usesNotifications = false;
+#endif
+}
+
+bool FileWatcher::_waitForNotification(int timeoutMs)
+{
+#if defined(_WIN32)
+    if (m_changeHandles.empty())
+    {
+        Sleep(DWORD(timeoutMs));
+        return false;
+    }
+    const DWORD waited = WaitForMultipleObjects(DWORD(m_changeHandles.size()), m_changeHandles.data(), FALSE, DWORD(timeoutMs));
+    if (waited < WAIT_OBJECT_0 || waited >= WAIT_OBJECT_0 + m_changeHandles.size())
+        return false;
+    FindNextChangeNotification(m_changeHandles[waited - WAIT_OBJECT_0]);
+    return true;
+#elif defined(__linux__)
+    pollfd descriptor = { m_inotify, POLLIN, 0 };
+    if (poll(&descriptor, 1, timeoutMs) <= 0)
+        return false;
+    // The events themselves aren't needed, only that there were some
+    char events[4096];
+    while (read(m_inotify, events, sizeof(events)) > 0)
+    {
+    }
+    return true;
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    return false;
+#endif
+}
+
+bool FileWatcher::wait(int timeoutMs, std::vector<std::string>& outChanged)
+{
+    outChanged.clear();
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;)
+    {
+        for (auto& file : m_files)
+        {
+            const FileState state = _getState(file.first);
+            if (!(state == file.second))
+            {
+                file.second = state;
+                outChanged.push_back(file.first);
+            }
+        }
+        if (!outChanged.empty())
+            return true;
+
+        const int remainingMs = int(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count());
+        if (remainingMs <= 0)
+            return false;
+
+        if (!m_usesNotifications)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::min(remainingMs, c_fileWatcherPollMs)));
+            continue;
+        }
+        if (_waitForNotification(remainingMs))
+        {
+            while (_waitForNotification(c_fileWatcherSettleMs))
+            {
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// Watches a set of files for changes.
+//
+// Which files changed is decided by comparing each one's last write time and size (or whether it exists) with what
+// they were when last seen. To not poll constantly, the watcher sleeps until the OS says something in one of the
+// files' directories changed: inotify on Linux, change notifications (FindFirstChangeNotification) on Windows.
+// Elsewhere, or if those can't be set up, it polls every c_fileWatcherPollMs.
+//
+// Editors often save in several steps (truncate, write, rename over), so after a notification the watcher waits until
+// the directory has been quiet for c_fileWatcherSettleMs before comparing.
+//
+// Not thread safe; one thread sets the files and waits.
+
+#include <filesystem>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+static const int c_fileWatcherPollMs    = 50;
+static const int c_fileWatcherSettleMs  = 10;
+
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /// Replaces the watched files. Files that were already watched keep their last seen state, so a change made since
+    /// is still reported; new ones are compared against their state now.
+    void setFiles(const std::vector<std::string>& fileNames);
+
+    /// Waits up to timeoutMs for watched files to change. True with the changed files, as NormalizePath gives them, in
+    /// outChanged; false if none changed in time.
+    bool wait(int timeoutMs, std::vector<std::string>& outChanged);
+
+    /// False if the watcher fell back to polling.
+    bool usesNotifications() const { return m_usesNotifications; }
+
+    /// The absolute, normalized form of a path, which the watcher identifies files by.
+    static std::string NormalizePath(const std::string& fileName);
+
+protected:
+    struct FileState
+    {
+        bool                            exists = false;
+        std::filesystem::file_time_type writeTime;
+        uintmax_t                       size = 0;
+
+        bool operator==(const FileState& other) const
+        {
+            return exists == other.exists && (!exists || (writeTime == other.writeTime && size == other.size));
+        }
+    };
+
+    static FileState _getState(const std::string& fileName);
+    void _watchDirectory(const std::string& directory);
+    /// True if a notification arrived within timeoutMs
+    bool _waitForNotification(int timeoutMs);
+
+    std::map<std::string, FileState>    m_files;
+    std::vector<std::string>            m_directories;
+    bool                                m_usesNotifications = false;
+
+#if defined(_WIN32)
+    std::vector<void*>                  m_changeHandles;    ///< One per directory
+#elif defined(__linux__)
+    int                                 m_inotify = -1;
+#endif
+};
@@ -0,0 +1,197 @@
+#include "GfxCompute.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace gfx;
+using Slang::ComPtr;
+
+static const char*  c_searchPaths[]             = { "." };
+static const Size   c_transientConstantBytes    = 4096;
+
+static void PrintDiagnostics(ISlangBlob* diagnostics)
+{
+    if (diagnostics && diagnostics->getBufferSize())
+        printf("diagnostics:\n%s\n", (const char*)diagnostics->getBufferPointer());
+}
+
+SlangResult CreateGfxComputeContext(DeviceType deviceType, GfxComputeContext& outContext, const IDevice::Desc* baseDesc)
+{
+    IDevice::Desc deviceDesc = baseDesc ? *baseDesc : IDevice::Desc();
+    deviceDesc.deviceType = deviceType;
+    deviceDesc.slang.searchPaths = c_searchPaths;
+    deviceDesc.slang.searchPathCount = GfxCount(sizeof(c_searchPaths) / sizeof(c_searchPaths[0]));
+    SLANG_RETURN_ON_FAIL(gfxCreateDevice(&deviceDesc, outContext.device.writeRef()));
+
+    ICommandQueue::Desc queueDesc = { ICommandQueue::QueueType::Graphics };
+    SLANG_RETURN_ON_FAIL(outContext.device->createCommandQueue(queueDesc, outContext.queue.writeRef()));
+
+    ITransientResourceHeap::Desc heapDesc = {};
+    heapDesc.constantBufferSize = c_transientConstantBytes;
+    return outContext.device->createTransientResourceHeap(heapDesc, outContext.transientHeap.writeRef());
+}
+
+SlangResult LoadComputeKernel(
+    IDevice* device,
+    const char* moduleName,
+    const char* entryPointName,
+    GfxComputeKernel& outKernel,
+    const char* const* specializationArgs,
+    int specializationArgCount)
+{
+    ComPtr<slang::ISession> session;
+    SLANG_RETURN_ON_FAIL(device->getSlangSession(session.writeRef()));
+
+    ComPtr<ISlangBlob> diagnostics;
+    slang::IModule* module = session->loadModule(moduleName, diagnostics.writeRef());
+    PrintDiagnostics(diagnostics);
+    if (!module)
+        return SLANG_FAIL;
+
+    ComPtr<slang::IEntryPoint> entryPoint;
+    SLANG_RETURN_ON_FAIL(module->findEntryPointByName(entryPointName, entryPoint.writeRef()));
+
+    slang::IComponentType* components[] = { module, entryPoint };
+    ComPtr<slang::IComponentType> composite;
+    SLANG_RETURN_ON_FAIL(session->createCompositeComponentType(components, 2, composite.writeRef(), diagnostics.writeRef()));
+    PrintDiagnostics(diagnostics);
+
+    if (specializationArgCount > 0)
+    {
+        std::vector<slang::SpecializationArg> args;
+        for (int i = 0; i < specializationArgCount; i++)
+        {
+            slang::TypeReflection* type = composite->getLayout()->findTypeByName(specializationArgs[i]);
+            if (!type)
+            {
+                printf("Unknown specialization type \"%s\".\n", specializationArgs[i]);
+                return SLANG_E_NOT_FOUND;
+            }
+            args.push_back(slang::SpecializationArg::fromType(type));
+        }
+
+        ComPtr<slang::IComponentType> specialized;
+        SlangResult result = composite->specialize(args.data(), SlangInt(args.size()), specialized.writeRef(), diagnostics.writeRef());
+        PrintDiagnostics(diagnostics);
+        SLANG_RETURN_ON_FAIL(result);
+        composite = specialized;
+    }
+
+    SlangResult result = composite->link(outKernel.linkedProgram.writeRef(), diagnostics.writeRef());
+    PrintDiagnostics(diagnostics);
+    SLANG_RETURN_ON_FAIL(result);
+
+    slang::EntryPointReflection* entryPointReflection = outKernel.linkedProgram->getLayout()->getEntryPointByIndex(0);
+    entryPointReflection->getComputeThreadGroupSize(3, outKernel.numThreads);
+
+    IShaderProgram::Desc programDesc = {};
+    programDesc.slangGlobalScope = outKernel.linkedProgram;
+    SLANG_RETURN_ON_FAIL(device->createProgram(programDesc, outKernel.program.writeRef()));
+
+    ComputePipelineStateDesc pipelineDesc = {};
+    pipelineDesc.program = outKernel.program;
+    return device->createComputePipelineState(pipelineDesc, outKernel.pipeline.writeRef());
+}
+
+bool FindShaderOffset(IShaderObject* object, const char* name, ShaderOffset& outOffset)
+{
+    // Walk the path one struct field at a time, adding up each field's offsets
+    slang::TypeLayoutReflection* layout = object->getElementTypeLayout();
+    ShaderOffset offset;
+    for (const char* nameBegin = name; layout; )
+    {
+        const char* nameEnd = strchr(nameBegin, '.');
+        const SlangInt fieldIndex = layout->findFieldIndexByName(nameBegin, nameEnd);
+        if (fieldIndex < 0)
+            return false;
+
+        slang::VariableLayoutReflection* field = layout->getFieldByIndex(unsigned(fieldIndex));
+        offset.uniformOffset += SlangInt(field->getOffset());
+        offset.bindingRangeIndex += GfxIndex(layout->getFieldBindingRangeOffset(fieldIndex));
+        if (!nameEnd)
+        {
+            outOffset = offset;
+            return true;
+        }
+
+        layout = field->getTypeLayout();
+        nameBegin = nameEnd + 1;
+    }
+    return false;
+}
+
+SlangResult CreateFloatBuffer(IDevice* device, size_t count, const float* initialData, IBufferResource** outBuffer, IResourceView** outView)
+{
+    IBufferResource::Desc bufferDesc = {};
+    bufferDesc.type = IResource::Type::Buffer;
+    bufferDesc.sizeInBytes = Size(count * sizeof(float));
+    bufferDesc.format = Format::R32_FLOAT;
+    bufferDesc.elementSize = 0;
+    bufferDesc.defaultState = ResourceState::UnorderedAccess;
+    bufferDesc.allowedStates = ResourceStateSet(
+        ResourceState::ShaderResource,
+        ResourceState::UnorderedAccess,
+        ResourceState::CopySource,
+        ResourceState::CopyDestination);
+    bufferDesc.memoryType = MemoryType::DeviceLocal;
+    SLANG_RETURN_ON_FAIL(device->createBufferResource(bufferDesc, initialData, outBuffer));
+
+    IResourceView::Desc viewDesc = {};
+    viewDesc.type = IResourceView::Type::UnorderedAccess;
+    viewDesc.format = Format::R32_FLOAT;
+    return device->createBufferView(*outBuffer, nullptr, viewDesc, outView);
+}
+
+SlangResult DispatchAndWait(
+    GfxComputeContext& context,
+    const GfxComputeKernel& kernel,
+    const char* parameterName,
+    IResourceView* view,
+    int groupCountX, int groupCountY, int groupCountZ)
+{
+    SLANG_RETURN_ON_FAIL(context.transientHeap->synchronizeAndReset());
+
+    ComPtr<ICommandBuffer> commandBuffer;
+    SLANG_RETURN_ON_FAIL(context.transientHeap->createCommandBuffer(commandBuffer.writeRef()));
+
+    IComputeCommandEncoder* encoder = commandBuffer->encodeComputeCommands();
+    IShaderObject* rootObject = encoder->bindPipeline(kernel.pipeline);
+    ShaderOffset offset;
+    if (!rootObject || !FindShaderOffset(rootObject, parameterName, offset))
+    {
+        printf("No shader parameter named \"%s\".\n", parameterName);
+        encoder->endEncoding();
+        return SLANG_E_NOT_FOUND;
+    }
+    rootObject->setResource(offset, view);
+    encoder->dispatchCompute(groupCountX, groupCountY, groupCountZ);
+    encoder->endEncoding();
+    commandBuffer->close();
+
+    context.queue->executeCommandBuffer(commandBuffer);
+    context.queue->waitOnHost();
+    return context.transientHeap->finish();
+}
+
+SlangResult DispatchWithRootObjectAndWait(
+    GfxComputeContext& context,
+    const GfxComputeKernel& kernel,
+    IShaderObject* rootObject,
+    int groupCountX, int groupCountY, int groupCountZ)
+{
+    SLANG_RETURN_ON_FAIL(context.transientHeap->synchronizeAndReset());
+
+    ComPtr<ICommandBuffer> commandBuffer;
+    SLANG_RETURN_ON_FAIL(context.transientHeap->createCommandBuffer(commandBuffer.writeRef()));
+
+    IComputeCommandEncoder* encoder = commandBuffer->encodeComputeCommands();
+    encoder->bindPipelineWithRootObject(kernel.pipeline, rootObject);
+    encoder->dispatchCompute(groupCountX, groupCountY, groupCountZ);
+    encoder->endEncoding();
+    commandBuffer->close();
+
+    context.queue->executeCommandBuffer(commandBuffer);
+    context.queue->waitOnHost();
+    return context.transientHeap->finish();
+}
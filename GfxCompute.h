@@ -0,0 +1,62 @@
+#pragma once
+
+// Helpers for running test.slang style compute kernels through slang-gfx, with no window or swapchain.
+//
+// With DeviceType::CPU the kernel is compiled to host callable C++ and run by gfx's CPU device, so the whole
+// load/bind/dispatch/readback path can run without a GPU. Any other device type goes through the same calls.
+
+#include "slang/slang-gfx.h"
+
+/// A compute kernel loaded through a device: the linked slang program, the gfx program and its pipeline.
+struct GfxComputeKernel
+{
+    Slang::ComPtr<slang::IComponentType>    linkedProgram;
+    Slang::ComPtr<gfx::IShaderProgram>      program;
+    Slang::ComPtr<gfx::IPipelineState>      pipeline;
+    SlangUInt                               numThreads[3] = { 1, 1, 1 };
+};
+
+/// The objects needed to submit work to a device: one queue and one transient heap.
+struct GfxComputeContext
+{
+    Slang::ComPtr<gfx::IDevice>                 device;
+    Slang::ComPtr<gfx::ICommandQueue>           queue;
+    Slang::ComPtr<gfx::ITransientResourceHeap>  transientHeap;
+};
+
+/// Creates a device of the given type, finding modules in the working directory, plus a queue and transient heap.
+/// Fields of baseDesc other than the device type and search paths are kept, if it's given.
+SlangResult CreateGfxComputeContext(gfx::DeviceType deviceType, GfxComputeContext& outContext, const gfx::IDevice::Desc* baseDesc = nullptr);
+
+/// Loads a module by name, links it with one entry point and creates the compute pipeline. Diagnostics are printed.
+/// A generic entry point or module is specialized with the named types first.
+SlangResult LoadComputeKernel(
+    gfx::IDevice* device,
+    const char* moduleName,
+    const char* entryPointName,
+    GfxComputeKernel& outKernel,
+    const char* const* specializationArgs = nullptr,
+    int specializationArgCount = 0);
+
+/// The offset of a shader parameter, for IShaderObject::setResource/setData. The name is a path through struct
+/// fields, like "Data" or "params.transform.scale". Returns false if there's no parameter of that name.
+bool FindShaderOffset(gfx::IShaderObject* object, const char* name, gfx::ShaderOffset& outOffset);
+
+/// Creates a buffer of floats that binds as a RWBuffer<float>, and its unordered access view.
+SlangResult CreateFloatBuffer(gfx::IDevice* device, size_t count, const float* initialData, gfx::IBufferResource** outBuffer, gfx::IResourceView** outView);
+
+/// Records one dispatch of the kernel with `view` bound to the named parameter, submits it and waits for it.
+SlangResult DispatchAndWait(
+    GfxComputeContext& context,
+    const GfxComputeKernel& kernel,
+    const char* parameterName,
+    gfx::IResourceView* view,
+    int groupCountX, int groupCountY = 1, int groupCountZ = 1);
+
+/// Records one dispatch of the kernel with a prebuilt root object (e.g. from IDevice::createMutableRootShaderObject),
+/// submits it and waits for it.
+SlangResult DispatchWithRootObjectAndWait(
+    GfxComputeContext& context,
+    const GfxComputeKernel& kernel,
+    gfx::IShaderObject* rootObject,
+    int groupCountX, int groupCountY = 1, int groupCountZ = 1);
@@ -0,0 +1,264 @@
+#include "GroupFibers.h"
+
+#include <memory>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <ucontext.h>
+#endif
+
+static const size_t c_groupSharedAlignment = 64;
+
+struct GroupFiberRunner::Fiber
+{
+    GroupFiberRunner*   runner = nullptr;
+    uint32_t            index = 0;
+    uint3               groupThreadID;
+    bool                finished = false;
+
+#ifdef _WIN32
+    void*               handle = nullptr;
+#else
+    ucontext_t          context;
+    std::vector<char>   stack;
+#endif
+
+    // Each fiber runs the kernel once per group, then hands over to the next fiber until it's resumed for the next group
+    static void entry(Fiber* fiber)
+    {
+        GroupFiberRunner* runner = fiber->runner;
+        for (;;)
+        {
+            runner->m_func(fiber->groupThreadID, runner->m_groupID, runner->m_userData);
+            fiber->finished = true;
+            runner->m_runningCount--;
+            runner->_switchToNext(fiber);
+        }
+    }
+
+#ifdef _WIN32
+    static VOID CALLBACK winEntry(LPVOID param)
+    {
+        entry((Fiber*)param);
+    }
+#else
+    // makecontext passes int arguments, so the pointer is split in two
+    static void posixEntry(int high, int low)
+    {
+        uintptr_t address = (uintptr_t(uint32_t(high)) << 16 << 16) | uintptr_t(uint32_t(low));
+        entry((Fiber*)address);
+    }
+
+    // Kept out of the constructor's loop: getcontext returns twice, so locals live across it could be clobbered
+    void initContext(size_t stackSize)
+    {
+        stack.resize(stackSize);
+        getcontext(&context);
+        context.uc_stack.ss_sp = stack.data();
+        context.uc_stack.ss_size = stack.size();
+        context.uc_link = nullptr;
+        const uintptr_t address = uintptr_t(this);
+        makecontext(&context, (void (*)())&Fiber::posixEntry, 2, int(uint32_t(address >> 16 >> 16)), int(uint32_t(address)));
+    }
+#endif
+};
+
+#ifdef _WIN32
+// A thread is turned into a fiber once, the first time a runner is made on it, and back when the thread exits. Were
+// each runner to do it, a runner made while another was alive would keep the fiber the other one frees.
+struct ThreadFiber
+{
+    void*   handle = nullptr;
+    bool    convertedThread = false;
+
+    ~ThreadFiber()
+    {
+        if (convertedThread)
+            ConvertFiberToThread();
+    }
+};
+
+static void* GetThreadFiber()
+{
+    static thread_local ThreadFiber s_threadFiber;
+    if (!s_threadFiber.handle)
+    {
+        s_threadFiber.convertedThread = !IsThreadAFiber();
+        s_threadFiber.handle = s_threadFiber.convertedThread ? ConvertThreadToFiber(nullptr) : GetCurrentFiber();
+    }
+    return s_threadFiber.handle;
+}
+#endif
+
+GroupFiberRunner*& GroupFiberRunner::current()
+{
+    static thread_local GroupFiberRunner* s_current = nullptr;
+    return s_current;
+}
+
+GroupFiberRunner::GroupFiberRunner(const uint3& numThreads, size_t groupSharedBytes, size_t stackSize)
+    : m_numThreads(numThreads)
+    , m_groupSharedBytes(groupSharedBytes)
+{
+    const size_t allocBytes = ((groupSharedBytes ? groupSharedBytes : 1) + c_groupSharedAlignment - 1) & ~(c_groupSharedAlignment - 1);
+#ifdef _WIN32
+    m_groupShared = _aligned_malloc(allocBytes, c_groupSharedAlignment);
+#else
+    m_groupShared = aligned_alloc(c_groupSharedAlignment, allocBytes);
+#endif
+
+    m_mainFiber = new Fiber;
+    m_mainFiber->runner = this;
+#ifdef _WIN32
+    m_mainFiber->handle = GetThreadFiber();
+#endif
+
+    const uint32_t threadCount = numThreads.x * numThreads.y * numThreads.z;
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        Fiber* fiber = new Fiber;
+        fiber->runner = this;
+        fiber->index = i;
+        fiber->groupThreadID = uint3(i % numThreads.x, (i / numThreads.x) % numThreads.y, i / (numThreads.x * numThreads.y));
+#ifdef _WIN32
+        fiber->handle = CreateFiber(stackSize, &Fiber::winEntry, fiber);
+#else
+        fiber->initContext(stackSize);
+#endif
+        m_fibers.push_back(fiber);
+    }
+}
+
+GroupFiberRunner::~GroupFiberRunner()
+{
+    for (Fiber* fiber : m_fibers)
+    {
+#ifdef _WIN32
+        DeleteFiber(fiber->handle);
+#endif
+        delete fiber;
+    }
+    delete m_mainFiber;
+
+#ifdef _WIN32
+    _aligned_free(m_groupShared);
+#else
+    free(m_groupShared);
+#endif
+}
+
+void GroupFiberRunner::runGroup(GroupThreadFunc func, const uint3& groupID, void* userData)
+{
+    GroupFiberRunner* previous = current();
+    current() = this;
+
+    m_func = func;
+    m_groupID = groupID;
+    m_userData = userData;
+    for (Fiber* fiber : m_fibers)
+        fiber->finished = false;
+    m_runningCount = uint32_t(m_fibers.size());
+
+    // Each pass runs every unfinished fiber up to its next barrier (or its end), in group thread order
+    while (m_runningCount)
+    {
+        for (Fiber* fiber : m_fibers)
+        {
+            if (!fiber->finished)
+            {
+                _switch(m_mainFiber, fiber);
+                break;
+            }
+        }
+    }
+
+    current() = previous;
+}
+
+void GroupFiberRunner::barrier()
+{
+    _switchToNext(m_currentFiber);
+}
+
+void GroupFiberRunner::_switchToNext(Fiber* from)
+{
+    // Hand over to the next fiber still running this group. After the last one the pass is complete,
+    // so go back to runGroup to start the next pass.
+    for (size_t i = from->index + 1; i < m_fibers.size(); i++)
+    {
+        if (!m_fibers[i]->finished)
+        {
+            _switch(from, m_fibers[i]);
+            return;
+        }
+    }
+    _switch(from, m_mainFiber);
+}
+
+void GroupFiberRunner::_switch(Fiber* from, Fiber* to)
+{
+    m_switchCount++;
+    m_currentFiber = to;
+#ifdef _WIN32
+    (void)from;
+    SwitchToFiber(to->handle);
+#else
+    swapcontext(&from->context, &to->context);
+#endif
+}
+
+uint3 GetNumThreads(slang::EntryPointReflection* entryPoint)
+{
+    SlangUInt sizes[3] = { 1, 1, 1 };
+    entryPoint->getComputeThreadGroupSize(3, sizes);
+    return uint3(uint32_t(sizes[0]), uint32_t(sizes[1]), uint32_t(sizes[2]));
+}
+
+struct FiberDispatch
+{
+    GroupThreadFunc func;
+    uint3           numThreads;
+    size_t          groupSharedBytes;
+    void*           userData;
+};
+
+// The ComputeFunc each dispatcher worker runs. Workers keep their runner (and so their fibers and groupshared
+// block) between dispatches, and only rebuild it if the group shape changes.
+static void FiberGroupsFunc(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    const FiberDispatch* dispatch = (const FiberDispatch*)uniformEntryPointParams;
+
+    static thread_local std::unique_ptr<GroupFiberRunner> runner;
+    if (!runner ||
+        runner->getGroupSharedSize() < dispatch->groupSharedBytes ||
+        runner->getNumThreads().x != dispatch->numThreads.x ||
+        runner->getNumThreads().y != dispatch->numThreads.y ||
+        runner->getNumThreads().z != dispatch->numThreads.z)
+    {
+        // The old runner goes first, so the two never hold the thread's fibers and groupshared blocks at once
+        runner.reset();
+        runner.reset(new GroupFiberRunner(dispatch->numThreads, dispatch->groupSharedBytes));
+    }
+
+    for (uint32_t z = varyingInput->startGroupID.z; z < varyingInput->endGroupID.z; z++)
+        for (uint32_t y = varyingInput->startGroupID.y; y < varyingInput->endGroupID.y; y++)
+            for (uint32_t x = varyingInput->startGroupID.x; x < varyingInput->endGroupID.x; x++)
+                runner->runGroup(dispatch->func, uint3(x, y, z), dispatch->userData);
+}
+
+void DispatchGroupsWithFibers(
+    CPUDispatcher& dispatcher,
+    GroupThreadFunc func,
+    const uint3& groupCount,
+    const uint3& numThreads,
+    size_t groupSharedBytes,
+    void* userData)
+{
+    FiberDispatch dispatch = { func, numThreads, groupSharedBytes, userData };
+    dispatcher.dispatch(FiberGroupsFunc, groupCount, &dispatch, nullptr);
+}
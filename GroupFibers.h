@@ -0,0 +1,97 @@
+#pragma once
+
+// Runs the threads of a compute group as fibers on one core, so kernels can use groupshared memory and
+// GroupMemoryBarrierWithGroupSync on the CPU.
+//
+// The emitted C++ for an entry point runs a group's threads one after another, which is only correct while no
+// thread waits on another. Here every group thread is a fiber. A barrier switches directly to the next fiber in
+// the group (no OS threads or locks are involved), and once the last fiber reaches the barrier the whole group has
+// arrived and the first fiber carries on. Fibers are created once per runner and reused for every group.
+//
+// Groupshared storage is one cache line aligned block per runner, reused group after group so it stays in cache.
+// The group size comes from the entry point's [numthreads] via reflection (GetNumThreads). Reflection does not
+// report groupshared usage, so its size in bytes is given by the caller.
+//
+// Fibers are Win32 fibers on Windows and ucontext elsewhere. swapcontext also saves the signal mask, a system call
+// per switch, so barriers are several times dearer off Windows.
+
+#include <vector>
+
+#include "CPUPrelude.h"
+#include "CPUDispatcher.h"
+
+/// The per thread body of a kernel. Reads groupshared memory with GroupShared<T>() and syncs with
+/// GroupMemoryBarrierWithGroupSync().
+typedef void (*GroupThreadFunc)(const uint3& groupThreadID, const uint3& groupID, void* userData);
+
+class GroupFiberRunner
+{
+public:
+    static const size_t kDefaultStackSize = 64 * 1024;
+
+    GroupFiberRunner(const uint3& numThreads, size_t groupSharedBytes, size_t stackSize = kDefaultStackSize);
+    ~GroupFiberRunner();
+
+    GroupFiberRunner(const GroupFiberRunner&) = delete;
+    GroupFiberRunner& operator=(const GroupFiberRunner&) = delete;
+
+    /// Runs every thread of the group to completion. Must be called on the thread that created the runner.
+    void runGroup(GroupThreadFunc func, const uint3& groupID, void* userData);
+
+    /// Called by a group thread. Returns once every thread in the group has reached the barrier.
+    void barrier();
+
+    void* getGroupShared() const { return m_groupShared; }
+    size_t getGroupSharedSize() const { return m_groupSharedBytes; }
+    const uint3& getNumThreads() const { return m_numThreads; }
+    uint32_t getThreadCount() const { return uint32_t(m_fibers.size()); }
+
+    /// Fiber switches made so far, for reporting.
+    uint64_t getSwitchCount() const { return m_switchCount; }
+
+    /// The runner whose group is running on the calling thread, or nullptr.
+    static GroupFiberRunner*& current();
+
+protected:
+    struct Fiber;
+
+    void _switchToNext(Fiber* from);
+    void _switch(Fiber* from, Fiber* to);
+
+    uint3                   m_numThreads;
+    size_t                  m_groupSharedBytes;
+    void*                   m_groupShared = nullptr;
+    std::vector<Fiber*>     m_fibers;
+    Fiber*                  m_mainFiber = nullptr;
+    Fiber*                  m_currentFiber = nullptr;
+    uint32_t                m_runningCount = 0;     ///< Fibers that have not finished the current group
+    uint64_t                m_switchCount = 0;
+
+    GroupThreadFunc         m_func = nullptr;
+    uint3                   m_groupID;
+    void*                   m_userData = nullptr;
+};
+
+SLANG_FORCE_INLINE void GroupMemoryBarrierWithGroupSync()
+{
+    GroupFiberRunner::current()->barrier();
+}
+
+/// The current group's groupshared memory viewed as a T, at a byte offset.
+template <typename T>
+SLANG_FORCE_INLINE T& GroupShared(size_t byteOffset = 0)
+{
+    return *(T*)((char*)GroupFiberRunner::current()->getGroupShared() + byteOffset);
+}
+
+/// The [numthreads] of an entry point, from reflection.
+uint3 GetNumThreads(slang::EntryPointReflection* entryPoint);
+
+/// Runs every group in [0, groupCount) on the dispatcher's workers, each worker running its groups as fibers.
+void DispatchGroupsWithFibers(
+    CPUDispatcher& dispatcher,
+    GroupThreadFunc func,
+    const uint3& groupCount,
+    const uint3& numThreads,
+    size_t groupSharedBytes,
+    void* userData);
@@ -0,0 +1,150 @@
+// Checks and benchmarks groupshared kernels run as fibers (GroupFibers.h): a tiled tree reduction and a
+// shared memory 1D convolution, both needing GroupMemoryBarrierWithGroupSync between phases.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Bench.h"
+#include "GroupFibers.h"
+#include "RunModes.h"
+
+static const uint32_t   c_defaultElementCount   = 1 << 18;
+static const uint32_t   c_threadsPerGroup       = 256;      // [numthreads(256, 1, 1)]
+static const int        c_convolutionRadius     = 4;
+static const int        c_repeatCount           = 5;
+
+struct GroupSharedParams
+{
+    StructuredBuffer<float>     input;
+    RWStructuredBuffer<float>   output;
+};
+
+// groupshared float shared[256]; tree reduction of one element per thread, thread 0 writes the group's sum
+static void TiledReduceKernel(const uint3& groupThreadID, const uint3& groupID, void* userData)
+{
+    GroupSharedParams* params = (GroupSharedParams*)userData;
+    float* shared = &GroupShared<float>();
+
+    const uint32_t index = groupID.x * c_threadsPerGroup + groupThreadID.x;
+    shared[groupThreadID.x] = index < params->input.count ? params->input[index] : 0.0f;
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint32_t stride = c_threadsPerGroup / 2; stride > 0; stride >>= 1)
+    {
+        if (groupThreadID.x < stride)
+            shared[groupThreadID.x] += shared[groupThreadID.x + stride];
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (groupThreadID.x == 0)
+        params->output[groupID.x] = shared[0];
+}
+
+// groupshared float tile[256 + 2 * radius]; each thread loads its element (and the edge threads the halo),
+// then sums its neighbourhood out of the tile
+static void ConvolutionKernel(const uint3& groupThreadID, const uint3& groupID, void* userData)
+{
+    GroupSharedParams* params = (GroupSharedParams*)userData;
+    float* tile = &GroupShared<float>();
+
+    const int count = int(params->input.count);
+    const int index = int(groupID.x * c_threadsPerGroup + groupThreadID.x);
+    auto load = [&](int i) { return params->input[size_t(i < 0 ? 0 : (i >= count ? count - 1 : i))]; };
+
+    tile[groupThreadID.x + c_convolutionRadius] = load(index);
+    if (groupThreadID.x < uint32_t(c_convolutionRadius))
+    {
+        tile[groupThreadID.x] = load(index - c_convolutionRadius);
+        tile[groupThreadID.x + c_threadsPerGroup + c_convolutionRadius] = load(index + int(c_threadsPerGroup));
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    float sum = 0.0f;
+    for (int offset = -c_convolutionRadius; offset <= c_convolutionRadius; offset++)
+        sum += tile[int(groupThreadID.x) + c_convolutionRadius + offset];
+    if (index < count)
+        params->output[size_t(index)] = sum;
+}
+
+int RunGroupSharedBenchmark(int argc, char** argv)
+{
+    const uint32_t elementCount = uint32_t(argc > 1 ? atoi(argv[1]) : c_defaultElementCount);
+    const int threadCount = argc > 2 ? atoi(argv[2]) : 0;
+    if (elementCount == 0)
+    {
+        printf("Element count must be at least 1.\n");
+        return 1;
+    }
+
+    // Small integers keep every float sum exact, whatever order it's done in
+    std::vector<float> input(elementCount);
+    for (uint32_t i = 0; i < elementCount; i++)
+        input[i] = float(rand() % 16);
+
+    const uint32_t groupCount = (elementCount + c_threadsPerGroup - 1) / c_threadsPerGroup;
+    std::vector<float> output(elementCount > groupCount ? elementCount : groupCount);
+    GroupSharedParams params = { { input.data(), input.size() }, { output.data(), output.size() } };
+
+    CPUDispatcher dispatcher(threadCount);
+    const uint3 numThreads = uint3(c_threadsPerGroup, 1, 1);
+    printf("groupshared with fibers: %u elements, %u groups of %u threads on %i worker threads, best of %i runs\n\n",
+        elementCount, groupCount, c_threadsPerGroup, dispatcher.getThreadCount(), c_repeatCount);
+
+    int failures = 0;
+
+    // Tiled reduction: 1 + log2(256) barriers per group
+    {
+        double ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            DispatchGroupsWithFibers(dispatcher, TiledReduceKernel, uint3(groupCount, 1, 1), numThreads, sizeof(float) * c_threadsPerGroup, &params);
+        });
+        PrintBenchResult("tiled reduction", ms, double(elementCount), "elements");
+
+        int barrierCount = 1;
+        for (uint32_t stride = c_threadsPerGroup / 2; stride > 0; stride >>= 1)
+            barrierCount++;
+        PrintBenchResult("    fiber switches", ms, double(groupCount) * c_threadsPerGroup * barrierCount, "switches");
+
+        for (uint32_t group = 0; group < groupCount; group++)
+        {
+            float expected = 0.0f;
+            for (uint32_t i = group * c_threadsPerGroup; i < (group + 1) * c_threadsPerGroup && i < elementCount; i++)
+                expected += input[i];
+            if (output[group] != expected)
+            {
+                printf("    ERROR: group %u sum is %f, expected %f\n", group, output[group], expected);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    // Shared memory convolution: one barrier per group
+    {
+        double ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            DispatchGroupsWithFibers(dispatcher, ConvolutionKernel, uint3(groupCount, 1, 1), numThreads,
+                sizeof(float) * (c_threadsPerGroup + 2 * c_convolutionRadius), &params);
+        });
+        PrintBenchResult("9 tap convolution", ms, double(elementCount), "elements");
+
+        for (int i = 0; i < int(elementCount); i++)
+        {
+            float expected = 0.0f;
+            for (int offset = -c_convolutionRadius; offset <= c_convolutionRadius; offset++)
+            {
+                int clamped = i + offset < 0 ? 0 : (i + offset >= int(elementCount) ? int(elementCount) - 1 : i + offset);
+                expected += input[clamped];
+            }
+            if (output[i] != expected)
+            {
+                printf("    ERROR: element %i is %f, expected %f\n", i, output[i], expected);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    return failures ? 1 : 0;
+}
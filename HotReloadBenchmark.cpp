@@ -0,0 +1,342 @@
+// Hot reload of CPU kernels with HotReloader (HotReloader.h): a dispatch loop runs kernels on CPUDispatcher workers
+// continuously while their source is edited, and picks up each new kernel with an atomic pointer load rather than
+// waiting for the compiler.
+//
+// By default two generated entry points are used, in out_hotreload: kernel.slang, which #includes common.slang, and
+// other.slang. Edits alternate between common.slang, which must recompile kernel.slang and only it, and other.slang.
+// Each edit changes the value a kernel writes, and its edit to effect latency is the time from writing the file until
+// the dispatch loop's output has the new value. Then common.slang is broken, which must leave the last good kernel
+// running, and fixed again.
+//
+// "hotreload watch [seconds]" instead watches test.slang's csmain, so it can be edited by hand while it runs. Each
+// version is dispatched over at least c_elementCount threads in groups of its numthreads, with the buffer sized to
+// every thread dispatched, and a version whose globals no longer match HotReloadGlobals is refused.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <iterator>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+#include "CPUDispatcher.h"
+#include "HotReloader.h"
+#include "RunModes.h"
+
+static const char*  c_directory             = "out_hotreload";
+static const char*  c_fileNameWatched       = "test.slang";
+static const int    c_defaultEditCount      = 6;
+static const int    c_defaultWatchSeconds   = 60;
+static const int    c_elementCount          = 4096;
+static const int    c_threadsPerGroup       = 64;
+static const int    c_editTimeoutMs         = 60000;
+static const int    c_firstEditValue        = 1000;
+static const int    c_kernelEntryPoint      = 0;
+static const int    c_otherEntryPoint       = 1;
+
+/// The globals of every kernel here as the C++ target lays them out
+struct HotReloadGlobals
+{
+    RWBuffer<float>     Data;
+};
+
+/// HotReloadGlobals as HotKernel::globals describes it
+static const char* c_boundGlobals[] = { "RWBuffer<float> Data" };
+
+/// What the dispatch loop should see after the latest edit
+struct EditProbe
+{
+    std::mutex                              mutex;
+    std::condition_variable                 seen;
+    int                                     entryPoint = -1;
+    float                                   value = 0.0f;
+    bool                                    observed = false;
+    std::chrono::steady_clock::time_point   observedTime;
+};
+
+static bool WriteTextFile(const std::string& fileName, const std::string& text)
+{
+    FILE* file = nullptr;
+    fopen_s(&file, fileName.c_str(), "wb");
+    if (!file)
+        return false;
+    const bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+    fclose(file);
+    return written;
+}
+
+static std::string MakeCommonSource(int value, bool broken)
+{
+    return "static const float c_value = " + std::to_string(value) + ".0" + (broken ? " +;\n" : ";\n");
+}
+
+static std::string MakeKernelSource(bool includeCommon, int value)
+{
+    std::string source = includeCommon ? "#include \"common.slang\"\n" : "static const float c_value = " + std::to_string(value) + ".0;\n";
+    source +=
+        "RWBuffer<float> Data;\n"
+        "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\n"
+        "void csmain(uint3 DTid : SV_DispatchThreadID)\n{\n"
+        "    Data[DTid.x] = c_value + float(DTid.x % 4);\n}\n";
+    return source;
+}
+
+static double MsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool MatchesBoundGlobals(const HotKernel& kernel)
+{
+    const size_t boundCount = sizeof(c_boundGlobals) / sizeof(c_boundGlobals[0]);
+    if (kernel.globals.size() != boundCount)
+        return false;
+    for (size_t i = 0; i < boundCount; i++)
+    {
+        if (kernel.globals[i] != c_boundGlobals[i])
+            return false;
+    }
+    return true;
+}
+
+static std::string JoinGlobals(const std::vector<std::string>& globals)
+{
+    std::string joined;
+    for (const std::string& global : globals)
+        joined += (joined.empty() ? "" : ", ") + global;
+    return joined.empty() ? "none" : joined;
+}
+
+static int RunWatch(int argc, char** argv)
+{
+    const int seconds = argc > 2 ? atoi(argv[2]) : c_defaultWatchSeconds;
+
+    HotReloadDesc desc;
+    desc.entryPoints.push_back({ c_fileNameWatched, "csmain" });
+    desc.onReload = [](int, const std::shared_ptr<const HotKernel>& kernel, const std::string& diagnostics)
+    {
+        if (kernel)
+            printf("    compiled version %i in %.1f ms\n", kernel->version, kernel->compileMs);
+        else
+            printf("    compile failed, keeping the last good kernel:\n%s", diagnostics.c_str());
+    };
+
+    HotReloader reloader(desc);
+    std::string diagnostics;
+    if (SLANG_FAILED(reloader.start(diagnostics)))
+    {
+        printf("Could not compile %s:\n%s", c_fileNameWatched, diagnostics.c_str());
+        return 1;
+    }
+    printf("Watching %s for %i seconds (%s); edit it to reload csmain\n\n", c_fileNameWatched, seconds,
+        reloader.usesNotifications() ? "notifications" : "polling");
+
+    // The prelude only asserts on out of bounds accesses, so a kernel only runs if its globals are what's bound, and
+    // the buffer covers every thread of the dispatch
+    CPUDispatcher dispatcher;
+    std::vector<float> data;
+    HotReloadGlobals globals = {};
+    uint3 groupCount;
+    std::shared_ptr<const HotKernel> running;
+    int lastVersion = -1;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (MsSince(start) < seconds * 1000.0)
+    {
+        const std::shared_ptr<const HotKernel> kernel = reloader.getKernel(0);
+        if (kernel->version != lastVersion)
+        {
+            lastVersion = kernel->version;
+            if (!MatchesBoundGlobals(*kernel))
+            {
+                printf("    ERROR: version %i has globals %s, but %s is bound; %s\n", kernel->version, JoinGlobals(kernel->globals).c_str(),
+                    JoinGlobals(std::vector<std::string>(std::begin(c_boundGlobals), std::end(c_boundGlobals))).c_str(),
+                    running ? "keeping the last version that matched" : "nothing to run until it's fixed");
+            }
+            else
+            {
+                running = kernel;
+                const SlangUInt* groupSize = kernel->threadGroupSize;
+                groupCount = uint3(uint32_t((c_elementCount + groupSize[0] - 1) / groupSize[0]), 1, 1);
+                data.assign(size_t(groupCount.x) * groupSize[0] * groupSize[1] * groupSize[2], 0.0f);
+                globals.Data.data = data.data();
+                globals.Data.count = data.size();
+                dispatcher.dispatch(running->func, groupCount, nullptr, &globals);
+                printf("    running version %i, numthreads(%u, %u, %u): Data[0] = %f, %.1f ms from the change being seen\n",
+                    kernel->version, unsigned(groupSize[0]), unsigned(groupSize[1]), unsigned(groupSize[2]), data[0],
+                    MsSince(kernel->changeTime));
+            }
+        }
+        if (running)
+            dispatcher.dispatch(running->func, groupCount, nullptr, &globals);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return 0;
+}
+
+int RunHotReloadBenchmark(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "watch") == 0)
+        return RunWatch(argc, argv);
+
+    const int editCount = argc > 1 ? atoi(argv[1]) : c_defaultEditCount;
+    if (editCount < 2)
+    {
+        printf("Edit count must be at least 2.\n");
+        return 1;
+    }
+
+    const std::filesystem::path directory(c_directory);
+    const std::string commonPath = (directory / "common.slang").string();
+    const std::string kernelPath = (directory / "kernel.slang").string();
+    const std::string otherPath = (directory / "other.slang").string();
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (!WriteTextFile(commonPath, MakeCommonSource(1, false)) || !WriteTextFile(kernelPath, MakeKernelSource(true, 0)) ||
+        !WriteTextFile(otherPath, MakeKernelSource(false, 2)))
+    {
+        printf("Could not write the kernels to %s.\n", c_directory);
+        return 1;
+    }
+
+    HotReloadDesc desc;
+    desc.entryPoints.push_back({ kernelPath, "csmain" });
+    desc.entryPoints.push_back({ otherPath, "csmain" });
+    HotReloader reloader(desc);
+    std::string diagnostics;
+    if (SLANG_FAILED(reloader.start(diagnostics)))
+    {
+        printf("Could not compile the kernels:\n%s", diagnostics.c_str());
+        return 1;
+    }
+
+    printf("Hot reload: %i edits to %s, dispatch loop over %i elements, %s\n\n", editCount, c_directory, c_elementCount,
+        reloader.usesNotifications() ? "file change notifications" : "polling");
+
+    // The dispatch loop, which must never wait for the compiler
+    EditProbe probe;
+    std::atomic<bool> stopLoop{ false };
+    std::atomic<uint64_t> iterationCount{ 0 };
+    double maxIterationMs = 0.0;
+    std::thread loop([&]()
+    {
+        CPUDispatcher dispatcher;
+        std::vector<float> data(c_elementCount);
+        HotReloadGlobals globals = {};
+        globals.Data.data = data.data();
+        globals.Data.count = data.size();
+        const uint3 groupCount(c_elementCount / c_threadsPerGroup, 1, 1);
+
+        while (!stopLoop)
+        {
+            Timer timer;
+            for (int entryPoint = 0; entryPoint < 2; entryPoint++)
+            {
+                const std::shared_ptr<const HotKernel> kernel = reloader.getKernel(entryPoint);
+                dispatcher.dispatch(kernel->func, groupCount, nullptr, &globals);
+
+                std::lock_guard<std::mutex> lock(probe.mutex);
+                if (probe.entryPoint == entryPoint && !probe.observed && data[0] == probe.value)
+                {
+                    probe.observed = true;
+                    probe.observedTime = std::chrono::steady_clock::now();
+                    probe.seen.notify_all();
+                }
+            }
+            maxIterationMs = std::max(maxIterationMs, timer.elapsedMs());
+            iterationCount++;
+        }
+    });
+
+    // Writes an edit and waits for the dispatch loop to see its value, returning the latency, or -1 if it never did
+    auto applyEdit = [&](int entryPoint, int value, const std::string& fileName, const std::string& source)
+    {
+        {
+            std::lock_guard<std::mutex> lock(probe.mutex);
+            probe.entryPoint = entryPoint;
+            probe.value = float(value);
+            probe.observed = false;
+        }
+        const std::chrono::steady_clock::time_point editTime = std::chrono::steady_clock::now();
+        if (!WriteTextFile(fileName, source))
+            return -1.0;
+        std::unique_lock<std::mutex> lock(probe.mutex);
+        if (!probe.seen.wait_for(lock, std::chrono::milliseconds(c_editTimeoutMs), [&]() { return probe.observed; }))
+            return -1.0;
+        return std::chrono::duration<double, std::milli>(probe.observedTime - editTime).count();
+    };
+
+    int failures = 0;
+    int editsPerEntryPoint[2] = {};
+    std::vector<double> latencies;
+    printf("    %-6s %-14s %8s %18s\n", "edit", "file", "value", "edit to effect ms");
+    for (int edit = 0; edit < editCount; edit++)
+    {
+        const int entryPoint = edit % 2 == 0 ? c_kernelEntryPoint : c_otherEntryPoint;
+        const int value = c_firstEditValue + edit;
+        const char* fileName = entryPoint == c_kernelEntryPoint ? "common.slang" : "other.slang";
+        const double latencyMs = entryPoint == c_kernelEntryPoint ? applyEdit(entryPoint, value, commonPath, MakeCommonSource(value, false))
+            : applyEdit(entryPoint, value, otherPath, MakeKernelSource(false, value));
+        editsPerEntryPoint[entryPoint]++;
+        if (latencyMs < 0.0)
+        {
+            printf("    ERROR: edit %i to %s never took effect\n", edit, fileName);
+            failures++;
+            continue;
+        }
+        latencies.push_back(latencyMs);
+        printf("    %-6i %-14s %8i %18.1f\n", edit, fileName, value, latencyMs);
+    }
+
+    // A broken edit keeps the last good kernel running, and fixing it reloads
+    const int failuresBeforeBroken = reloader.getStats().failures;
+    const std::shared_ptr<const HotKernel> lastGood = reloader.getKernel(c_kernelEntryPoint);
+    const std::chrono::steady_clock::time_point brokenTime = std::chrono::steady_clock::now();
+    WriteTextFile(commonPath, MakeCommonSource(0, true));
+    while (reloader.getStats().failures == failuresBeforeBroken && MsSince(brokenTime) < c_editTimeoutMs)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (reloader.getStats().failures == failuresBeforeBroken || reloader.getKernel(c_kernelEntryPoint) != lastGood)
+    {
+        printf("    ERROR: the broken edit should have failed and left the last good kernel running\n");
+        failures++;
+    }
+    const double fixLatencyMs = applyEdit(c_kernelEntryPoint, c_firstEditValue - 1, commonPath, MakeCommonSource(c_firstEditValue - 1, false));
+    editsPerEntryPoint[c_kernelEntryPoint]++;
+    if (fixLatencyMs < 0.0)
+    {
+        printf("    ERROR: fixing the broken edit never took effect\n");
+        failures++;
+    }
+    else
+        printf("    %-6s %-14s %8i %18.1f\n", "fix", "common.slang", c_firstEditValue - 1, fixLatencyMs);
+
+    stopLoop = true;
+    loop.join();
+    reloader.stop();
+
+    // Editing common.slang must only have reloaded kernel.slang, and other.slang only itself
+    const HotReloadStats stats = reloader.getStats();
+    for (int entryPoint = 0; entryPoint < 2; entryPoint++)
+    {
+        if (stats.reloads[entryPoint] != editsPerEntryPoint[entryPoint])
+        {
+            printf("    ERROR: entry point %i was edited %i times and reloaded %i times\n", entryPoint, editsPerEntryPoint[entryPoint], stats.reloads[entryPoint]);
+            failures++;
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const int reloadCount = stats.reloads[0] + stats.reloads[1];
+    printf("\n    %-40s %.1f\n", "median edit to effect ms", latencies.empty() ? 0.0 : latencies[latencies.size() / 2]);
+    printf("    %-40s %.1f\n", "max edit to effect ms", latencies.empty() ? 0.0 : latencies.back());
+    printf("    %-40s %.1f\n", "mean change seen to published ms", reloadCount ? stats.totalChangeToPublishMs / reloadCount : 0.0);
+    printf("    %-40s %.3f over %llu iterations\n", "longest dispatch loop iteration ms", maxIterationMs, (unsigned long long)iterationCount);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+#include "HotReloader.h"
+
+#include <algorithm>
+
+#include "FileWatcher.h"
+
+static const int c_stopCheckMs = 100;
+
+static double MsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+HotReloader::HotReloader(const HotReloadDesc& desc)
+    : m_desc(desc)
+    , m_kernels(desc.entryPoints.size())
+    , m_dependencies(desc.entryPoints.size())
+{
+    m_session = spCreateSession(NULL);
+    m_stats.reloads.resize(desc.entryPoints.size());
+}
+
+HotReloader::~HotReloader()
+{
+    stop();
+    spDestroySession(m_session);
+}
+
+SlangResult HotReloader::start(std::string& outDiagnostics)
+{
+    outDiagnostics.clear();
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    SlangResult result = SLANG_OK;
+    for (int i = 0; i < int(m_desc.entryPoints.size()); i++)
+    {
+        std::string diagnostics;
+        if (SLANG_FAILED(_compile(i, now, diagnostics)))
+            result = SLANG_FAIL;
+        outDiagnostics += diagnostics;
+    }
+    if (SLANG_FAILED(result))
+        return result;
+
+    m_watcher.reset(new FileWatcher);
+    m_watcher->setFiles(_getWatchedFiles());
+    m_usesNotifications = m_watcher->usesNotifications();
+    m_watchThread = std::thread([this]() { _watchLoop(); });
+    return result;
+}
+
+void HotReloader::stop()
+{
+    m_stopping = true;
+    if (m_watchThread.joinable())
+        m_watchThread.join();
+}
+
+HotReloadStats HotReloader::getStats()
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+/// "RWBuffer<float> Data", to check a kernel's globals against what the host binds
+static std::string DescribeGlobal(slang::VariableLayoutReflection* parameter)
+{
+    slang::TypeReflection* type = parameter->getType();
+    std::string description = type && type->getName() ? type->getName() : "?";
+    slang::TypeReflection* resultType = type ? type->getResourceResultType() : nullptr;
+    if (resultType && resultType->getName())
+        description += std::string("<") + resultType->getName() + ">";
+    return description + " " + (parameter->getName() ? parameter->getName() : "");
+}
+
+SlangResult HotReloader::_compile(int entryPoint, std::chrono::steady_clock::time_point changeTime, std::string& outDiagnostics)
+{
+    const HotReloadEntryPoint& desc = m_desc.entryPoints[entryPoint];
+    SlangCompileRequest* request = spCreateCompileRequest(m_session);
+    spSetCodeGenTarget(request, m_desc.target);
+    if (!m_desc.profile.empty())
+        spSetTargetProfile(request, 0, spFindProfile(m_session, m_desc.profile.c_str()));
+    const int translationUnitIndex = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_SLANG, "");
+    spAddTranslationUnitSourceFile(request, translationUnitIndex, desc.sourcePath.c_str());
+    spAddEntryPoint(request, translationUnitIndex, desc.entryPointName.c_str(), SLANG_STAGE_COMPUTE);
+
+    const std::chrono::steady_clock::time_point compileStart = std::chrono::steady_clock::now();
+    std::shared_ptr<HotKernel> kernel = std::make_shared<HotKernel>();
+    SlangResult result = spCompile(request);
+    if (SLANG_SUCCEEDED(result))
+    {
+        if (m_desc.target == SLANG_SHADER_HOST_CALLABLE)
+        {
+            result = spGetEntryPointHostCallable(request, 0, 0, kernel->library.writeRef());
+            kernel->func = SLANG_SUCCEEDED(result) ? (ComputeFunc)kernel->library->findFuncByName(desc.entryPointName.c_str()) : nullptr;
+            if (SLANG_SUCCEEDED(result) && !kernel->func)
+                result = SLANG_E_NOT_FOUND;
+        }
+        else
+            result = spGetEntryPointCodeBlob(request, 0, 0, kernel->code.writeRef());
+    }
+    slang::ShaderReflection* reflection = SLANG_SUCCEEDED(result) ? slang::ShaderReflection::get(request) : nullptr;
+    if (reflection)
+    {
+        if (slang::EntryPointReflection* entryPointReflection = reflection->getEntryPointByIndex(0))
+            entryPointReflection->getComputeThreadGroupSize(3, kernel->threadGroupSize);
+        for (unsigned i = 0; i < reflection->getParameterCount(); i++)
+            kernel->globals.push_back(DescribeGlobal(reflection->getParameterByIndex(i)));
+    }
+    kernel->compileMs = MsBetween(compileStart, std::chrono::steady_clock::now());
+    const char* diagnostics = spGetDiagnosticOutput(request);
+    outDiagnostics = diagnostics ? diagnostics : "";
+
+    // A failed compile may not have read every file, so its dependencies are added to the last good ones rather than
+    // replacing them: fixing any file the entry point used still triggers a compile
+    std::vector<std::string> dependencies = SLANG_SUCCEEDED(result) ? std::vector<std::string>() : m_dependencies[entryPoint];
+    dependencies.push_back(FileWatcher::NormalizePath(desc.sourcePath));
+    for (int i = 0; i < spGetDependencyFileCount(request); i++)
+        dependencies.push_back(FileWatcher::NormalizePath(spGetDependencyFilePath(request, i)));
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+    m_dependencies[entryPoint] = dependencies;
+    spDestroyCompileRequest(request);
+
+    std::shared_ptr<const HotKernel> published;
+    if (SLANG_SUCCEEDED(result))
+    {
+        const std::shared_ptr<const HotKernel> previous = std::atomic_load(&m_kernels[entryPoint]);
+        kernel->version = previous ? previous->version + 1 : 0;
+        kernel->changeTime = changeTime;
+        kernel->publishTime = std::chrono::steady_clock::now();
+        published = kernel;
+        std::atomic_store(&m_kernels[entryPoint], published);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        if (SLANG_FAILED(result))
+            m_stats.failures++;
+        else if (published->version > 0)
+        {
+            const double changeToPublishMs = MsBetween(changeTime, published->publishTime);
+            m_stats.reloads[entryPoint]++;
+            m_stats.totalChangeToPublishMs += changeToPublishMs;
+            m_stats.maxChangeToPublishMs = std::max(m_stats.maxChangeToPublishMs, changeToPublishMs);
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> HotReloader::_getWatchedFiles()
+{
+    std::vector<std::string> files;
+    for (const std::vector<std::string>& dependencies : m_dependencies)
+        files.insert(files.end(), dependencies.begin(), dependencies.end());
+    return files;
+}
+
+void HotReloader::_watchLoop()
+{
+    FileWatcher& watcher = *m_watcher;
+    std::vector<std::string> changed;
+    while (!m_stopping)
+    {
+        if (!watcher.wait(c_stopCheckMs, changed))
+            continue;
+
+        const std::chrono::steady_clock::time_point changeTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < int(m_desc.entryPoints.size()) && !m_stopping; i++)
+        {
+            const std::vector<std::string>& dependencies = m_dependencies[i];
+            const bool affected = std::any_of(changed.begin(), changed.end(), [&](const std::string& file)
+            {
+                return std::binary_search(dependencies.begin(), dependencies.end(), file);
+            });
+            if (!affected)
+                continue;
+
+            std::string diagnostics;
+            const SlangResult result = _compile(i, changeTime, diagnostics);
+            if (m_desc.onReload)
+                m_desc.onReload(i, SLANG_SUCCEEDED(result) ? getKernel(i) : nullptr, diagnostics);
+        }
+
+        // A compile may have picked up or dropped an include
+        watcher.setFiles(_getWatchedFiles());
+        m_usesNotifications = watcher.usesNotifications();
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// Keeps compiled entry points up to date with their source while the program runs, without it ever waiting on a compile.
+//
+// start() compiles every entry point, then a background thread watches their source files and everything they
+// #include or import (FileWatcher.h, with the dependency list slang reports for each compile). When files change, only
+// the entry points that depend on them are compiled again.
+//
+// Each entry point's current kernel is held by a shared_ptr that is swapped atomically when a compile succeeds. The
+// thread running kernels loads it with getKernel() before each dispatch and holds it for the dispatch, so it never
+// waits for the compiler and a kernel's shared library isn't unloaded while it runs; the old one goes when the last
+// dispatch that holds it lets go. A compile that fails leaves the previous kernel in place and keeps watching.
+//
+// Host callable targets (SLANG_SHADER_HOST_CALLABLE) produce a loaded library and the entry point's function; other
+// targets the code blob. Each kernel also has its thread group size and global parameters from reflection, as an edit
+// can change them: check them against what's bound before dispatching a new version.
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "slang/slang.h"
+#include "slang/slang-com-ptr.h"
+
+#include "CPUPrelude.h"
+
+class FileWatcher;
+
+struct HotReloadEntryPoint
+{
+    std::string                             sourcePath;
+    std::string                             entryPointName = "csmain";
+};
+
+struct HotKernel
+{
+    int                                     version = 0;        ///< 0 for the compile in start(), then counts reloads
+    ComputeFunc                             func = nullptr;     ///< Host callable targets
+    Slang::ComPtr<ISlangSharedLibrary>      library;            ///< Keeps func loaded
+    Slang::ComPtr<ISlangBlob>               code;               ///< Other targets
+    SlangUInt                               threadGroupSize[3] = { 1, 1, 1 };   ///< From numthreads
+    std::vector<std::string>                globals;            ///< Global parameters in order, as "RWBuffer<float> Data"
+    double                                  compileMs = 0.0;
+    std::chrono::steady_clock::time_point   changeTime;         ///< When the change it was compiled for was seen
+    std::chrono::steady_clock::time_point   publishTime;        ///< When it replaced the previous kernel
+};
+
+struct HotReloadDesc
+{
+    std::vector<HotReloadEntryPoint>        entryPoints;
+    SlangCompileTarget                      target = SLANG_SHADER_HOST_CALLABLE;
+    std::string                             profile;            ///< Target default if empty
+    /// Called on the watch thread after each compile following a change, with the entry point's index. The kernel is
+    /// null if the compile failed.
+    std::function<void(int entryPoint, const std::shared_ptr<const HotKernel>& kernel, const std::string& diagnostics)> onReload;
+};
+
+struct HotReloadStats
+{
+    std::vector<int>                        reloads;            ///< Per entry point
+    int                                     failures = 0;
+    double                                  maxChangeToPublishMs = 0.0;
+    double                                  totalChangeToPublishMs = 0.0;
+};
+
+class HotReloader
+{
+public:
+    explicit HotReloader(const HotReloadDesc& desc);
+
+    /// Stops watching
+    ~HotReloader();
+
+    HotReloader(const HotReloader&) = delete;
+    HotReloader& operator=(const HotReloader&) = delete;
+
+    /// Compiles every entry point, then starts watching. Fails, without watching, if any entry point doesn't compile.
+    SlangResult start(std::string& outDiagnostics);
+    void stop();
+
+    /// The entry point's current kernel. Never blocks on a compile; hold the pointer for as long as the kernel is used.
+    std::shared_ptr<const HotKernel> getKernel(int entryPoint) const { return std::atomic_load(&m_kernels[entryPoint]); }
+
+    HotReloadStats getStats();
+    bool usesNotifications() const { return m_usesNotifications; }
+
+protected:
+    void _watchLoop();
+    SlangResult _compile(int entryPoint, std::chrono::steady_clock::time_point changeTime, std::string& outDiagnostics);
+    std::vector<std::string> _getWatchedFiles();
+
+    HotReloadDesc                                       m_desc;
+    SlangSession*                                       m_session = nullptr;    ///< Only used by one thread at a time
+    std::vector<std::shared_ptr<const HotKernel>>       m_kernels;              ///< Accessed with atomic_load/atomic_store
+    std::vector<std::vector<std::string>>               m_dependencies;         ///< Per entry point, normalized paths
+    std::unique_ptr<FileWatcher>                        m_watcher;              ///< Used by the watch thread once started
+    std::thread                                         m_watchThread;
+    std::atomic<bool>                                   m_stopping{ false };
+    std::atomic<bool>                                   m_usesNotifications{ false };
+
+    std::mutex                                          m_statsMutex;
+    HotReloadStats                                      m_stats;
+};
@@ -0,0 +1,261 @@
+// Starts a set of generated CPU kernels through CPUKernelCache (CPUKernelCache.h), the way a process would: cold, with
+// the cache directory empty, so every kernel goes through slang and the downstream C++ compiler to a shared library;
+// again in the same process, where they're already loaded; through a new cache on the same directory in the same
+// process, which reads the index but gets back libraries the process already has loaded; and finally in a new
+// process, this program started again, which loads each library from disk by its entry point hash without compiling
+// anything.
+//
+// The new process then dispatches a few kernels on CPUDispatcher workers and checks their output.
+
+#include <filesystem>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <unistd.h>
+#endif
+
+#include "Bench.h"
+#include "CPUDispatcher.h"
+#include "CPUKernelCache.h"
+#include "RunModes.h"
+
+static const char*      c_entryPointName        = "csmain";
+static const uint32_t   c_threadsPerGroup       = 64;
+static const int        c_defaultKernelCount    = 32;
+static const int        c_defaultElementCount   = 1 << 16;
+static const int        c_checkedKernelCount    = 4;
+static const float      c_tolerance             = 1e-5f;
+static const char*      c_childArgument         = "--restarted";    // Runs the new process phase
+static const char*      c_restartMsPrefix       = "restartMs=";     // How the new process reports its start time
+
+/// The globals of every generated kernel as the C++ target lays them out
+struct KernelGlobals
+{
+    RWStructuredBuffer<float>       Data;
+};
+
+static float KernelScale(int kernel) { return 1.0f + float(kernel) / 1024.0f; }
+static float KernelOffset(int kernel) { return float(kernel % 17) * 0.25f; }
+
+/// Kernel k scales Data in place by KernelScale(k) and adds KernelOffset(k), each written out as a literal
+static std::string MakeKernelSource(int kernel)
+{
+    char constants[64];
+    snprintf(constants, sizeof(constants), "%.9g, %.9g", KernelScale(kernel), KernelOffset(kernel));
+    return std::string(
+        "RWStructuredBuffer<float> Data;\n"
+        "float apply(float x, float scale, float offset) { return x * scale + offset; }\n"
+        "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\n"
+        "void csmain(uint3 DTid : SV_DispatchThreadID)\n{\n"
+        "    uint count, stride;\n    Data.GetDimensions(count, stride);\n    if (DTid.x >= count) return;\n"
+        "    Data[DTid.x] = apply(Data[DTid.x], ") + constants + ");\n}\n";
+}
+
+static std::string FirstLine(const std::string& text)
+{
+    const size_t end = text.find_first_of("\r\n");
+    return end == std::string::npos ? text : text.substr(0, end);
+}
+
+/// Gets every kernel from the cache. False on the first that fails.
+static bool StartKernels(CPUKernelCache& cache, const std::vector<std::string>& sources, std::vector<CPUKernel>& outKernels)
+{
+    outKernels.assign(sources.size(), CPUKernel());
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        const std::string moduleName = "kernel" + std::to_string(i);
+        std::string diagnostics;
+        if (SLANG_FAILED(cache.getKernel(moduleName.c_str(), sources[i], c_entryPointName, outKernels[i], diagnostics)))
+        {
+            printf("    ERROR: %s failed: %s\n", moduleName.c_str(), FirstLine(diagnostics).c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+static void PrintPhase(const char* phase, double ms, int kernelCount, const CPUKernelCacheStats& before, const CPUKernelCacheStats& after)
+{
+    printf("    %-24s %12.3f %12.3f %9i %9i %9i\n", phase, ms, ms / double(kernelCount),
+        after.memoryHits - before.memoryHits, after.diskHits - before.diskHits, after.compiles - before.compiles);
+}
+
+static bool CheckKernel(CPUDispatcher& dispatcher, const CPUKernel& kernel, int index, std::vector<float>& data)
+{
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = float(i % 1024) / 1024.0f;
+
+    KernelGlobals globals = {};
+    globals.Data.data = data.data();
+    globals.Data.count = data.size();
+    dispatcher.dispatch(kernel.func, uint3(uint32_t((data.size() + c_threadsPerGroup - 1) / c_threadsPerGroup), 1, 1), nullptr, &globals);
+
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        const float expected = (float(i % 1024) / 1024.0f) * KernelScale(index) + KernelOffset(index);
+        if (!(fabsf(data[i] - expected) <= c_tolerance * (fabsf(expected) > 1.0f ? fabsf(expected) : 1.0f)))
+        {
+            printf("    ERROR: kernel%i Data[%zu] is %f, expected %f\n", index, i, data[i], expected);
+            return false;
+        }
+    }
+    return true;
+}
+
+/// This executable's path, to start it again as the next process. Empty if it can't be found.
+static std::string GetExecutablePath()
+{
+#ifdef _WIN32
+    char path[MAX_PATH];
+    const DWORD length = GetModuleFileNameA(nullptr, path, MAX_PATH);
+    return length && length < MAX_PATH ? std::string(path, length) : std::string();
+#else
+    char path[4096];
+    const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    return length > 0 ? std::string(path, size_t(length)) : std::string();
+#endif
+}
+
+/// The child process: starts the kernels from the cache the parent left, as the next run of a program would, then
+/// dispatches a few and checks their output. Its last line is the start time for the parent.
+static int RunRestartedProcess(const std::vector<std::string>& sources, int elementCount)
+{
+    const int kernelCount = int(sources.size());
+
+    // Creating the cache, which creates its loader's global session and reads the index, is part of starting
+    Timer timer;
+    CPUKernelCache& cache = GetCPUKernelCache();
+    std::vector<CPUKernel> kernels;
+    if (!StartKernels(cache, sources, kernels))
+        return 1;
+    const double restartMs = timer.elapsedMs();
+    PrintPhase("new process", restartMs, kernelCount, CPUKernelCacheStats(), cache.getStats());
+
+    int failures = 0;
+    if (cache.getStats().compiles)
+    {
+        printf("    ERROR: the new process compiled kernels that were in the cache\n");
+        failures++;
+    }
+
+    CPUDispatcher dispatcher;
+    const size_t count = size_t(elementCount);
+    std::vector<float> data(count);
+    const int checkedCount = kernelCount < c_checkedKernelCount ? kernelCount : c_checkedKernelCount;
+    int passedCount = 0;
+    for (int i = 0; i < checkedCount; i++)
+    {
+        const int index = i * (kernelCount - 1) / (checkedCount > 1 ? checkedCount - 1 : 1);
+        passedCount += CheckKernel(dispatcher, kernels[index], index, data) ? 1 : 0;
+    }
+    failures += checkedCount - passedCount;
+
+    printf("\n    %-40s %i of %i\n", "kernels dispatched and checked", passedCount, checkedCount);
+    printf("%s%.6f\n", c_restartMsPrefix, restartMs);
+    return failures ? 1 : 0;
+}
+
+int RunKernelCacheBenchmark(int argc, char** argv)
+{
+    const int kernelCount = argc > 1 ? atoi(argv[1]) : c_defaultKernelCount;
+    const int elementCount = argc > 2 ? atoi(argv[2]) : c_defaultElementCount;
+    if (kernelCount < 1 || elementCount < 1)
+    {
+        printf("Kernel and element counts must be at least 1.\n");
+        return 1;
+    }
+
+    std::vector<std::string> sources;
+    for (int i = 0; i < kernelCount; i++)
+        sources.push_back(MakeKernelSource(i));
+
+    if (argc > 3 && strcmp(argv[3], c_childArgument) == 0)
+        return RunRestartedProcess(sources, elementCount);
+
+    // Start cold. The process wide cache reads its index when first used, so the directory goes before that.
+    std::error_code error;
+    std::filesystem::remove_all(c_defaultKernelCacheDirectory, error);
+    CPUKernelCache& cache = GetCPUKernelCache();
+
+    printf("CPU kernel cache: %i kernels in %s\n\n", kernelCount, cache.getDirectory().c_str());
+    printf("    %-24s %12s %12s %9s %9s %9s\n", "phase", "total ms", "per kernel", "memory", "disk", "compiled");
+
+    std::vector<CPUKernel> kernels;
+    CPUKernelCacheStats before = cache.getStats();
+    Timer timer;
+    if (!StartKernels(cache, sources, kernels))
+        return 1;
+    const double coldMs = timer.elapsedMs();
+    CPUKernelCacheStats after = cache.getStats();
+    PrintPhase("cold", coldMs, kernelCount, before, after);
+
+    before = after;
+    timer.reset();
+    if (!StartKernels(cache, sources, kernels))
+        return 1;
+    const double loadedMs = timer.elapsedMs();
+    after = cache.getStats();
+    PrintPhase("same process", loadedMs, kernelCount, before, after);
+
+    // A new cache in this process reads the index and goes to disk, but the libraries are already loaded, so the
+    // loader hands back the same modules
+    {
+        timer.reset();
+        CPUKernelCache reloaded(cache.getDirectory().c_str());
+        std::vector<CPUKernel> reloadedKernels;
+        if (!StartKernels(reloaded, sources, reloadedKernels))
+            return 1;
+        const double reloadMs = timer.elapsedMs();
+        PrintPhase("new cache, same process", reloadMs, kernelCount, CPUKernelCacheStats(), reloaded.getStats());
+    }
+
+    // The real warm start: this program again, in a process that has loaded nothing
+    fflush(stdout);
+    int failures = 0;
+    const std::string executablePath = GetExecutablePath();
+    std::string command = "\"" + executablePath + "\" kernelcache " + std::to_string(kernelCount) + " " +
+        std::to_string(elementCount) + " " + c_childArgument;
+#ifdef _WIN32
+    // cmd strips the outer quotes, so the quoted path survives
+    command = "\"" + command + "\"";
+    FILE* child = executablePath.empty() ? nullptr : _popen(command.c_str(), "r");
+#else
+    FILE* child = executablePath.empty() ? nullptr : popen(command.c_str(), "r");
+#endif
+    if (!child)
+    {
+        printf("    ERROR: could not start %s as a new process\n", executablePath.empty() ? "this program" : executablePath.c_str());
+        return 1;
+    }
+    double restartMs = 0.0;
+    char line[1024];
+    while (fgets(line, sizeof(line), child))
+    {
+        if (strncmp(line, c_restartMsPrefix, strlen(c_restartMsPrefix)) == 0)
+            restartMs = atof(line + strlen(c_restartMsPrefix));
+        else
+            fputs(line, stdout);
+    }
+#ifdef _WIN32
+    const int childStatus = _pclose(child);
+#else
+    const int childStatus = pclose(child);
+#endif
+    if (childStatus != 0 || restartMs <= 0.0)
+    {
+        printf("    ERROR: the new process failed\n");
+        failures++;
+    }
+
+    printf("    %-40s %.1fx\n", "new process speedup over cold", restartMs > 0.0 ? coldMs / restartMs : 0.0);
+    return failures ? 1 : 0;
+}
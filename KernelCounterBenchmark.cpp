@@ -0,0 +1,180 @@
+// Runs two kernels built with KERNEL_COUNTERS (KernelCounters.h) on CPUDispatcher worker threads, prints the counter
+// report after each dispatch, and checks the counts against what the kernels are known to do.
+
+#define KERNEL_COUNTERS 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Bench.h"
+#include "CPUDispatcher.h"
+#include "CPUTexture.h"
+#include "RunModes.h"
+
+static const uint32_t   c_threadsPerGroup       = 64;
+static const uint32_t   c_defaultElementCount   = 1 << 20;
+static const uint32_t   c_textureSize           = 256;
+
+// Typed buffers, like test.slang's RWBuffer<float> Data
+struct ScaleKernelParams
+{
+    KernelBuffer<float>                 input;
+    KernelRWBuffer<float>               output;
+};
+
+struct SampleKernelParams
+{
+    Texture2D<float4>                   source;
+    SamplerState                        samplerState;
+    KernelRWStructuredBuffer<float>     output;
+    uint32_t                            width;
+};
+
+// Written the way the C++ target emits a kernel: the thread body, then the group loop for [numthreads(64, 1, 1)]
+static void ScaleKernelThread(const uint3& dispatchThreadID, ScaleKernelParams* params)
+{
+    params->output[dispatchThreadID.x] = params->input[dispatchThreadID.x] * 2.0f + 1.0f;
+}
+
+static void ScaleKernel(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    ScaleKernelParams* params = (ScaleKernelParams*)uniformEntryPointParams;
+    for (uint32_t groupX = varyingInput->startGroupID.x; groupX < varyingInput->endGroupID.x; groupX++)
+    {
+        for (uint32_t threadX = 0; threadX < c_threadsPerGroup; threadX++)
+            ScaleKernelThread(uint3(groupX * c_threadsPerGroup + threadX, 0, 0), params);
+    }
+}
+
+// Adds a texel of the source texture to each element, one sample per thread
+static void SampleKernelThread(const uint3& dispatchThreadID, SampleKernelParams* params)
+{
+    const uint32_t x = dispatchThreadID.x % params->width;
+    const uint32_t y = (dispatchThreadID.x / params->width) % params->width;
+    const float2 loc = float2((float(x) + 0.5f) / float(params->width), (float(y) + 0.5f) / float(params->width));
+    params->output[dispatchThreadID.x] += params->source.SampleLevel(params->samplerState, loc, 0.0f).x;
+}
+
+static void SampleKernel(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    SampleKernelParams* params = (SampleKernelParams*)uniformEntryPointParams;
+    for (uint32_t groupX = varyingInput->startGroupID.x; groupX < varyingInput->endGroupID.x; groupX++)
+    {
+        for (uint32_t threadX = 0; threadX < c_threadsPerGroup; threadX++)
+            SampleKernelThread(uint3(groupX * c_threadsPerGroup + threadX, 0, 0), params);
+    }
+}
+
+KERNEL_ENTRY_POINT(ScaleKernel, c_threadsPerGroup)
+KERNEL_ENTRY_POINT(SampleKernel, c_threadsPerGroup)
+
+/// Compares the counters of the one entry point that ran against the expected ones, printing differences.
+static int CheckCounters(const std::vector<KernelCounters>& counters, const KernelCounters& expected)
+{
+    const KernelCounters* ran = nullptr;
+    for (const KernelCounters& c : counters)
+    {
+        if (c.groups)
+            ran = &c;
+    }
+    if (!ran)
+    {
+        printf("    ERROR: no counted entry point ran\n");
+        return 1;
+    }
+
+    int failures = 0;
+    auto check = [&](const char* name, uint64_t actual, uint64_t wanted)
+    {
+        if (actual == wanted)
+            return;
+        printf("    ERROR: %s is %llu, expected %llu\n", name, (unsigned long long)actual, (unsigned long long)wanted);
+        failures++;
+    };
+    check("invocations", ran->invocations, expected.invocations);
+    check("groups", ran->groups, expected.groups);
+    check("bytes read", ran->bytesRead, expected.bytesRead);
+    check("bytes written", ran->bytesWritten, expected.bytesWritten);
+    check("texture samples", ran->textureSamples, expected.textureSamples);
+    check("texture loads", ran->textureLoads, expected.textureLoads);
+    return failures ? 1 : 0;
+}
+
+int RunKernelCounterBenchmark(int argc, char** argv)
+{
+    const uint32_t requestedCount = argc > 1 ? uint32_t(atoi(argv[1])) : c_defaultElementCount;
+    const int threadCount = argc > 2 ? atoi(argv[2]) : 0;
+    const uint32_t groupCount = (requestedCount + c_threadsPerGroup - 1) / c_threadsPerGroup;
+    const uint32_t elementCount = groupCount * c_threadsPerGroup;
+    if (!groupCount)
+    {
+        printf("Element count must be at least 1.\n");
+        return 1;
+    }
+
+    std::vector<float> input(elementCount);
+    std::vector<float> output(elementCount, 0.0f);
+    for (uint32_t i = 0; i < elementCount; i++)
+        input[i] = float(i % 1024);
+
+    std::vector<float> texels(size_t(c_textureSize) * c_textureSize * 4, 0.25f);
+    CPUTexture2D texture(c_textureSize, c_textureSize, 4, texels.data(), TextureLayout::MortonTiled, TextureFilter::Point);
+    CountingTexture countingTexture(&texture);
+
+    CPUDispatcher dispatcher(threadCount);
+    printf("Kernel counters: %u elements, %u groups of %u threads, %i worker threads\n\n",
+        elementCount, groupCount, c_threadsPerGroup, dispatcher.getThreadCount());
+
+    int failures = 0;
+
+    ScaleKernelParams scaleParams = { { input.data(), input.size() }, { output.data(), output.size() } };
+    Timer timer;
+    dispatcher.dispatch(ScaleKernelEntry, uint3(groupCount, 1, 1), &scaleParams, nullptr);
+    printf("    dispatch wall time %.3f ms\n", timer.elapsedMs());
+    std::vector<KernelCounters> counters = dispatcher.getKernelCounters();
+    PrintKernelCounterReport(counters);
+
+    KernelCounters expected;
+    expected.invocations = elementCount;
+    expected.groups = groupCount;
+    expected.bytesRead = uint64_t(elementCount) * sizeof(float);
+    expected.bytesWritten = uint64_t(elementCount) * sizeof(float);
+    failures += CheckCounters(counters, expected);
+    for (uint32_t i = 0; i < elementCount; i++)
+    {
+        if (output[i] != input[i] * 2.0f + 1.0f)
+        {
+            printf("    ERROR: ScaleKernel output[%u] is %f, expected %f\n", i, output[i], input[i] * 2.0f + 1.0f);
+            failures++;
+            break;
+        }
+    }
+
+    // Counters are per dispatch from here on
+    dispatcher.resetKernelCounters();
+    printf("\n");
+
+    SampleKernelParams sampleParams = { { &countingTexture }, { nullptr }, { output.data(), output.size() }, c_textureSize };
+    timer.reset();
+    dispatcher.dispatch(SampleKernelEntry, uint3(groupCount, 1, 1), &sampleParams, nullptr);
+    printf("    dispatch wall time %.3f ms\n", timer.elapsedMs());
+    counters = dispatcher.getKernelCounters();
+    PrintKernelCounterReport(counters);
+
+    expected.textureSamples = elementCount;
+    failures += CheckCounters(counters, expected);
+    for (uint32_t i = 0; i < elementCount; i++)
+    {
+        if (output[i] != input[i] * 2.0f + 1.25f)
+        {
+            printf("    ERROR: SampleKernel output[%u] is %f, expected %f\n", i, output[i], input[i] * 2.0f + 1.25f);
+            failures++;
+            break;
+        }
+    }
+
+    return failures ? 1 : 0;
+}
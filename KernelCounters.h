@@ -0,0 +1,318 @@
+#pragma once
+
+// Opt-in counters for CPU target kernels: invocations and time per entry point, buffer bytes read and written, and
+// texture samples and loads.
+//
+// Counting is chosen at compile time, per translation unit: define KERNEL_COUNTERS to 1 before including this header
+// (or for the whole build) and the kernel aliases below become counting versions. Otherwise they are the plain
+// prelude types and the macros expand to nothing, so uninstrumented kernels are unchanged.
+//
+// Kernels in the shape the C++ target emits use
+//   KernelStructuredBuffer<T> / KernelRWStructuredBuffer<T>   for their buffers (bytes counted in operator[])
+//   KernelBuffer<T> / KernelRWBuffer<T>                       for typed buffers, such as test.slang's RWBuffer<float>
+//   KERNEL_ENTRY_POINT(func, threadsPerGroup)                  to define funcEntry, the ComputeFunc to dispatch
+// Textures are counted by wrapping their ITexture in a CountingTexture, which works without the define too.
+//
+// A writable buffer's operator[] returns a CountedElement, which supports reading, assignment and the arithmetic
+// compound assignments. C++ can't forward member access through it, so a kernel that writes one member of a struct
+// element (`buffer[i].member = x`) doesn't compile counted; read the element, change it and assign it back.
+//
+// Counts go to the calling thread's KernelCounterTable, which CPUDispatcher binds on each of its workers, so the hot
+// path is a thread local load and plain adds, no atomics. After a dispatch CPUDispatcher::getKernelCounters() sums
+// the workers' tables into one KernelCounters per entry point, which PrintKernelCounterReport() prints.
+
+#include <chrono>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "CPUPrelude.h"
+
+#ifndef KERNEL_COUNTERS
+#define KERNEL_COUNTERS 0
+#endif
+
+/// Counts for one entry point. Aligned to a cache line so tables of different workers never share one.
+struct alignas(64) KernelCounters
+{
+    uint64_t    invocations = 0;
+    uint64_t    groups = 0;
+    uint64_t    nanoseconds = 0;        ///< Summed over workers, so more than the dispatch's wall time
+    uint64_t    bytesRead = 0;
+    uint64_t    bytesWritten = 0;
+    uint64_t    textureSamples = 0;
+    uint64_t    textureLoads = 0;
+
+    void add(const KernelCounters& other)
+    {
+        invocations += other.invocations;
+        groups += other.groups;
+        nanoseconds += other.nanoseconds;
+        bytesRead += other.bytesRead;
+        bytesWritten += other.bytesWritten;
+        textureSamples += other.textureSamples;
+        textureLoads += other.textureLoads;
+    }
+};
+
+/// Gives every counted entry point a small id, used to index the tables.
+class KernelCounterRegistry
+{
+public:
+    static int registerEntryPoint(const char* name)
+    {
+        std::lock_guard<std::mutex> lock(_mutex());
+        std::vector<std::string>& names = _names();
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if (names[i] == name)
+                return int(i);
+        }
+        names.push_back(name);
+        return int(names.size() - 1);
+    }
+
+    static std::string getName(int id)
+    {
+        std::lock_guard<std::mutex> lock(_mutex());
+        const std::vector<std::string>& names = _names();
+        return id >= 0 && size_t(id) < names.size() ? names[id] : std::string();
+    }
+
+protected:
+    static std::mutex& _mutex() { static std::mutex mutex; return mutex; }
+    static std::vector<std::string>& _names() { static std::vector<std::string> names; return names; }
+};
+
+/// One thread's counters, indexed by entry point id.
+class KernelCounterTable
+{
+public:
+    KernelCounters& get(int id)
+    {
+        if (size_t(id) >= m_counters.size())
+            m_counters.resize(size_t(id) + 1);
+        return m_counters[id];
+    }
+
+    const std::vector<KernelCounters>& getCounters() const { return m_counters; }
+
+    void reset() { m_counters.clear(); }
+
+    /// The table bound to the calling thread, or nullptr.
+    static KernelCounterTable*& current()
+    {
+        static thread_local KernelCounterTable* table = nullptr;
+        return table;
+    }
+
+    /// The counters of the entry point running on the calling thread, or nullptr outside a counted entry point.
+    static KernelCounters*& currentCounters()
+    {
+        static thread_local KernelCounters* counters = nullptr;
+        return counters;
+    }
+
+protected:
+    std::vector<KernelCounters>     m_counters;
+};
+
+/// Binds an entry point's counters to the thread for the groups in `varyingInput`, and adds their time.
+class KernelCounterScope
+{
+public:
+    KernelCounterScope(int id, const ComputeVaryingInput* varyingInput, uint32_t threadsPerGroup)
+    {
+        KernelCounterTable* table = KernelCounterTable::current();
+        if (!table)
+            return;
+
+        m_counters = &table->get(id);
+        const uint64_t groupCount =
+            uint64_t(varyingInput->endGroupID.x - varyingInput->startGroupID.x) *
+            uint64_t(varyingInput->endGroupID.y - varyingInput->startGroupID.y) *
+            uint64_t(varyingInput->endGroupID.z - varyingInput->startGroupID.z);
+        m_counters->groups += groupCount;
+        m_counters->invocations += groupCount * threadsPerGroup;
+        KernelCounterTable::currentCounters() = m_counters;
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    ~KernelCounterScope()
+    {
+        if (!m_counters)
+            return;
+        m_counters->nanoseconds += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+        KernelCounterTable::currentCounters() = nullptr;
+    }
+
+    KernelCounterScope(const KernelCounterScope&) = delete;
+    KernelCounterScope& operator=(const KernelCounterScope&) = delete;
+
+protected:
+    KernelCounters*                         m_counters = nullptr;
+    std::chrono::steady_clock::time_point   m_start;
+};
+
+SLANG_FORCE_INLINE void CountBytesRead(size_t bytes)
+{
+    if (KernelCounters* counters = KernelCounterTable::currentCounters())
+        counters->bytesRead += bytes;
+}
+
+SLANG_FORCE_INLINE void CountBytesWritten(size_t bytes)
+{
+    if (KernelCounters* counters = KernelCounterTable::currentCounters())
+        counters->bytesWritten += bytes;
+}
+
+/// A buffer element reference that counts its reads and writes. Compound assignments count a read and a write.
+template <typename T>
+struct CountedElement
+{
+    T& element;
+
+    SLANG_FORCE_INLINE operator T() const { CountBytesRead(sizeof(T)); return element; }
+    SLANG_FORCE_INLINE CountedElement& operator=(const T& value) { CountBytesWritten(sizeof(T)); element = value; return *this; }
+    SLANG_FORCE_INLINE CountedElement& operator=(const CountedElement& other) { return *this = T(other); }
+    SLANG_FORCE_INLINE CountedElement& operator+=(const T& value) { _countReadWrite(); element += value; return *this; }
+    SLANG_FORCE_INLINE CountedElement& operator-=(const T& value) { _countReadWrite(); element -= value; return *this; }
+    SLANG_FORCE_INLINE CountedElement& operator*=(const T& value) { _countReadWrite(); element *= value; return *this; }
+    SLANG_FORCE_INLINE CountedElement& operator/=(const T& value) { _countReadWrite(); element /= value; return *this; }
+
+protected:
+    SLANG_FORCE_INLINE void _countReadWrite() const { CountBytesRead(sizeof(T)); CountBytesWritten(sizeof(T)); }
+};
+
+/// RWStructuredBuffer with the same layout, counting bytes through operator[] and Load.
+template <typename T>
+struct CountedRWStructuredBuffer
+{
+    SLANG_FORCE_INLINE CountedElement<T> operator[](size_t index) const { SLANG_BOUND_CHECK(index, count); return CountedElement<T>{ data[index] }; }
+    const T& Load(size_t index) const { SLANG_BOUND_CHECK(index, count); CountBytesRead(sizeof(T)); return data[index]; }
+    void GetDimensions(uint32_t* outNumStructs, uint32_t* outStride) { *outNumStructs = uint32_t(count); *outStride = uint32_t(sizeof(T)); }
+
+    T* data;
+    size_t count;
+};
+
+/// StructuredBuffer with the same layout, counting bytes read.
+template <typename T>
+struct CountedStructuredBuffer
+{
+    SLANG_FORCE_INLINE const T& operator[](size_t index) const { SLANG_BOUND_CHECK(index, count); CountBytesRead(sizeof(T)); return data[index]; }
+    const T& Load(size_t index) const { return (*this)[index]; }
+    void GetDimensions(uint32_t* outNumStructs, uint32_t* outStride) { *outNumStructs = uint32_t(count); *outStride = uint32_t(sizeof(T)); }
+
+    T* data;
+    size_t count;
+};
+
+/// RWBuffer with the same layout, counting bytes through operator[] and Load.
+template <typename T>
+struct CountedRWBuffer
+{
+    SLANG_FORCE_INLINE CountedElement<T> operator[](size_t index) const { SLANG_BOUND_CHECK(index, count); return CountedElement<T>{ data[index] }; }
+    const T& Load(size_t index) const { SLANG_BOUND_CHECK(index, count); CountBytesRead(sizeof(T)); return data[index]; }
+    void GetDimensions(uint32_t* outCount) { *outCount = uint32_t(count); }
+
+    T* data;
+    size_t count;
+};
+
+/// Buffer with the same layout, counting bytes read.
+template <typename T>
+struct CountedBuffer
+{
+    SLANG_FORCE_INLINE const T& operator[](size_t index) const { SLANG_BOUND_CHECK(index, count); CountBytesRead(sizeof(T)); return data[index]; }
+    const T& Load(size_t index) const { return (*this)[index]; }
+    void GetDimensions(uint32_t* outCount) { *outCount = uint32_t(count); }
+
+    T* data;
+    size_t count;
+};
+
+/// Wraps an ITexture, counting samples and loads for the running entry point. Use it in place of the texture it
+/// wraps: `Texture2D<float4> source = { &countingTexture };`.
+class CountingTexture final : public ITexture
+{
+public:
+    explicit CountingTexture(ITexture* texture) : m_texture(texture) {}
+
+    virtual TextureDimensions GetDimensions(int mipLevel = -1) override
+    {
+        return m_texture->GetDimensions(mipLevel);
+    }
+
+    virtual void Load(const int32_t* v, void* outData, size_t dataSize) override
+    {
+        if (KernelCounters* counters = KernelCounterTable::currentCounters())
+            counters->textureLoads++;
+        m_texture->Load(v, outData, dataSize);
+    }
+
+    virtual void Sample(SamplerState samplerState, const float* loc, void* outData, size_t dataSize) override
+    {
+        if (KernelCounters* counters = KernelCounterTable::currentCounters())
+            counters->textureSamples++;
+        m_texture->Sample(samplerState, loc, outData, dataSize);
+    }
+
+    virtual void SampleLevel(SamplerState samplerState, const float* loc, float level, void* outData, size_t dataSize) override
+    {
+        if (KernelCounters* counters = KernelCounterTable::currentCounters())
+            counters->textureSamples++;
+        m_texture->SampleLevel(samplerState, loc, level, outData, dataSize);
+    }
+
+protected:
+    ITexture*   m_texture;
+};
+
+#if KERNEL_COUNTERS
+
+template <typename T> using KernelRWStructuredBuffer = CountedRWStructuredBuffer<T>;
+template <typename T> using KernelStructuredBuffer = CountedStructuredBuffer<T>;
+template <typename T> using KernelRWBuffer = CountedRWBuffer<T>;
+template <typename T> using KernelBuffer = CountedBuffer<T>;
+
+#define KERNEL_ENTRY_POINT(func, threadsPerGroup) \
+    static void func##Entry(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState) \
+    { \
+        static const int counterId = KernelCounterRegistry::registerEntryPoint(#func); \
+        KernelCounterScope counterScope(counterId, varyingInput, threadsPerGroup); \
+        func(varyingInput, uniformEntryPointParams, uniformState); \
+    }
+
+#else
+
+template <typename T> using KernelRWStructuredBuffer = RWStructuredBuffer<T>;
+template <typename T> using KernelStructuredBuffer = StructuredBuffer<T>;
+template <typename T> using KernelRWBuffer = RWBuffer<T>;
+template <typename T> using KernelBuffer = Buffer<T>;
+
+#define KERNEL_ENTRY_POINT(func, threadsPerGroup) \
+    static const ComputeFunc func##Entry = func;
+
+#endif
+
+/// Prints one line per entry point in `counters` (indexed by entry point id) that ran.
+inline void PrintKernelCounterReport(const std::vector<KernelCounters>& counters)
+{
+    printf("    %-20s %12s %10s %10s %10s %14s %14s %10s %10s\n",
+        "entry point", "invocations", "groups", "cpu ms", "ns/inv", "bytes read", "bytes written", "samples", "loads");
+    for (size_t id = 0; id < counters.size(); id++)
+    {
+        const KernelCounters& c = counters[id];
+        if (!c.groups)
+            continue;
+        printf("    %-20s %12llu %10llu %10.3f %10.2f %14llu %14llu %10llu %10llu\n",
+            KernelCounterRegistry::getName(int(id)).c_str(),
+            (unsigned long long)c.invocations, (unsigned long long)c.groups,
+            double(c.nanoseconds) / 1000000.0, c.invocations ? double(c.nanoseconds) / double(c.invocations) : 0.0,
+            (unsigned long long)c.bytesRead, (unsigned long long)c.bytesWritten,
+            (unsigned long long)c.textureSamples, (unsigned long long)c.textureLoads);
+    }
+}
@@ -0,0 +1,96 @@
+#include "KernelTuning.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+#ifndef _WIN32
+#   include <unistd.h>
+#endif
+
+static const char* c_groupSizeMacroNames[3] = { "GROUP_SIZE_X", "GROUP_SIZE_Y", "GROUP_SIZE_Z" };
+
+bool TuningDatabase::load(const char* fileName)
+{
+    FILE* file = nullptr;
+    fopen_s(&file, fileName, "rb");
+    if (!file)
+        return false;
+
+    char line[1024];
+    while (fgets(line, sizeof(line), file))
+    {
+        if (line[0] == '#')
+            continue;
+
+        char kernel[256], target[64], machine[256];
+        TuningResult result;
+        if (sscanf(line, "%255s %63s %255s %i %i %i %lf %lf", kernel, target, machine,
+            &result.groupSize[0], &result.groupSize[1], &result.groupSize[2], &result.meanMs, &result.ci95Ms) == 8)
+        {
+            set({ kernel, target, machine }, result);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+bool TuningDatabase::save(const char* fileName) const
+{
+    FILE* file = nullptr;
+    fopen_s(&file, fileName, "wb");
+    if (!file)
+        return false;
+
+    fprintf(file, "# kernel target machine groupSizeX groupSizeY groupSizeZ meanMs ci95Ms\n");
+    for (const auto& entry : m_results)
+    {
+        const TuningResult& result = entry.second;
+        fprintf(file, "%s %i %i %i %.6f %.6f\n", entry.first.c_str(),
+            result.groupSize[0], result.groupSize[1], result.groupSize[2], result.meanMs, result.ci95Ms);
+    }
+    fclose(file);
+    return true;
+}
+
+bool TuningDatabase::find(const TuningKey& key, TuningResult& outResult) const
+{
+    auto it = m_results.find(key.toString());
+    if (it == m_results.end())
+        return false;
+    outResult = it->second;
+    return true;
+}
+
+void TuningDatabase::set(const TuningKey& key, const TuningResult& result)
+{
+    m_results[key.toString()] = result;
+}
+
+std::string GetTuningMachineName()
+{
+#ifdef _WIN32
+    const char* host = getenv("COMPUTERNAME");
+#else
+    // Shells don't usually export HOSTNAME, so ask the system
+    char hostBuffer[256] = {};
+    const char* host = gethostname(hostBuffer, sizeof(hostBuffer) - 1) == 0 ? hostBuffer : nullptr;
+#endif
+    std::string name = host && host[0] ? host : "unknown";
+    for (char& c : name)
+    {
+        if (c == ' ' || c == '\t')
+            c = '_';
+    }
+    return name + "/" + std::to_string(std::thread::hardware_concurrency()) + "t";
+}
+
+void GetTunedGroupSizeMacros(const TuningResult& result, std::vector<std::string>& outValues, std::vector<slang::PreprocessorMacroDesc>& outMacros)
+{
+    outValues.clear();
+    outMacros.clear();
+    for (int i = 0; i < 3; i++)
+        outValues.push_back(std::to_string(result.groupSize[i]));
+    for (int i = 0; i < 3; i++)
+        outMacros.push_back({ c_groupSizeMacroNames[i], outValues[i].c_str() });
+}
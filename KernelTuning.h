@@ -0,0 +1,55 @@
+#pragma once
+
+// Stores tuned kernel configurations, so later runs and builds use the group size the autotuner picked rather than
+// the one hardcoded in the shader.
+//
+// Results are keyed by kernel ("module:entryPoint"), target ("cpu") and machine (host name and hardware thread
+// count), since the best group size depends on all three. The file is plain text, one result per line:
+//   kernel target machine groupSizeX groupSizeY groupSizeZ meanMs ci95Ms
+//
+// A kernel opts in by taking its group size from defines, e.g. [numthreads(GROUP_SIZE_X, 1, 1)] with a default for
+// when the define isn't given. GetTunedGroupSizeMacros() turns a stored result into those defines.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "slang/slang.h"
+
+static const char* const c_tuningFileName = "out_tuning.txt";
+
+struct TuningKey
+{
+    std::string     kernel;
+    std::string     target;
+    std::string     machine;
+
+    std::string toString() const { return kernel + " " + target + " " + machine; }
+};
+
+struct TuningResult
+{
+    int             groupSize[3] = { 1, 1, 1 };
+    double          meanMs = 0.0;
+    double          ci95Ms = 0.0;
+};
+
+class TuningDatabase
+{
+public:
+    /// Adds the results in a file, replacing ones with the same key. False if it couldn't be opened.
+    bool load(const char* fileName);
+    bool save(const char* fileName) const;
+
+    bool find(const TuningKey& key, TuningResult& outResult) const;
+    void set(const TuningKey& key, const TuningResult& result);
+
+protected:
+    std::map<std::string, TuningResult>     m_results;      ///< by TuningKey::toString()
+};
+
+/// Identifies this machine for tuning results: host name and hardware thread count, with no spaces.
+std::string GetTuningMachineName();
+
+/// The GROUP_SIZE_X/Y/Z defines for a result. The strings are kept in outValues, which must outlive the macros.
+void GetTunedGroupSizeMacros(const TuningResult& result, std::vector<std::string>& outValues, std::vector<slang::PreprocessorMacroDesc>& outMacros);
@@ -0,0 +1,227 @@
+// Compares ways of setting a kernel's parameters on a root shader object, on the CPU device with params.slang:
+//  - by name: every parameter's offset looked up from its path (FindShaderOffset) and set on its own, every time
+//  - cached slots: offsets resolved once by ShaderObjectLayout, each parameter set on its own
+//  - uniform block: the parameters written into a ShaderUniformBlock, applied with one setData
+//  - matching struct: a C++ struct checked against the layout once, set with one setData
+// Each is timed on its own, then dispatched and checked against the expected output.
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Bench.h"
+#include "RunModes.h"
+#include "ShaderLayoutCache.h"
+
+using namespace gfx;
+using Slang::ComPtr;
+
+static const char*  c_moduleName            = "params";
+static const char*  c_entryPointName        = "csmain";
+static const int    c_defaultIterations     = 100000;
+static const int    c_elementCount          = 4096;
+static const int    c_repeatCount           = 5;
+
+// Mirrors Params in params.slang
+struct ParamsBlock
+{
+    float       tint[4];
+    float       scale;
+    float       bias;
+    uint32_t    count;
+    uint32_t    offset;
+};
+
+static const ShaderStructField c_paramsBlockFields[] =
+{
+    { "params.tint",                offsetof(ParamsBlock, tint),    sizeof(ParamsBlock::tint) },
+    { "params.transform.scale",     offsetof(ParamsBlock, scale),   sizeof(ParamsBlock::scale) },
+    { "params.transform.bias",      offsetof(ParamsBlock, bias),    sizeof(ParamsBlock::bias) },
+    { "params.transform.count",     offsetof(ParamsBlock, count),   sizeof(ParamsBlock::count) },
+    { "params.transform.offset",    offsetof(ParamsBlock, offset),  sizeof(ParamsBlock::offset) },
+};
+
+enum BindMethod
+{
+    BindMethod_ByName,
+    BindMethod_Slots,
+    BindMethod_UniformBlock,
+    BindMethod_Struct,
+    BindMethod_Count
+};
+
+static const char* c_bindMethodNames[BindMethod_Count] = { "by name", "cached slots", "uniform block", "matching struct" };
+
+struct ParamSlots
+{
+    const ShaderParameterSlot*  tint;
+    const ShaderParameterSlot*  scale;
+    const ShaderParameterSlot*  bias;
+    const ShaderParameterSlot*  count;
+    const ShaderParameterSlot*  offset;
+    const ShaderParameterSlot*  data;
+};
+
+template <typename T>
+static void SetByName(IShaderObject* rootObject, const char* path, const T& value)
+{
+    ShaderOffset offset;
+    if (FindShaderOffset(rootObject, path, offset))
+        rootObject->setData(offset, &value, sizeof(T));
+}
+
+static void Bind(BindMethod method, IShaderObject* rootObject, const ShaderObjectLayout& layout, const ParamSlots& slots,
+    const ParamsBlock& params, IResourceView* view)
+{
+    switch (method)
+    {
+        case BindMethod_ByName:
+        {
+            SetByName(rootObject, "params.tint", params.tint);
+            SetByName(rootObject, "params.transform.scale", params.scale);
+            SetByName(rootObject, "params.transform.bias", params.bias);
+            SetByName(rootObject, "params.transform.count", params.count);
+            SetByName(rootObject, "params.transform.offset", params.offset);
+            ShaderOffset dataOffset;
+            if (FindShaderOffset(rootObject, "Data", dataOffset))
+                rootObject->setResource(dataOffset, view);
+            break;
+        }
+        case BindMethod_Slots:
+        {
+            SetUniform(rootObject, *slots.tint, params.tint);
+            SetUniform(rootObject, *slots.scale, params.scale);
+            SetUniform(rootObject, *slots.bias, params.bias);
+            SetUniform(rootObject, *slots.count, params.count);
+            SetUniform(rootObject, *slots.offset, params.offset);
+            rootObject->setResource(slots.data->offset, view);
+            break;
+        }
+        case BindMethod_UniformBlock:
+        {
+            ShaderUniformBlock block(layout);
+            block.write(*slots.tint, params.tint);
+            block.write(*slots.scale, params.scale);
+            block.write(*slots.bias, params.bias);
+            block.write(*slots.count, params.count);
+            block.write(*slots.offset, params.offset);
+            block.apply(rootObject);
+            rootObject->setResource(slots.data->offset, view);
+            break;
+        }
+        case BindMethod_Struct:
+        {
+            SetUniformBlock(rootObject, layout, params);
+            rootObject->setResource(slots.data->offset, view);
+            break;
+        }
+        default: break;
+    }
+}
+
+int RunLayoutBenchmark(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? atoi(argv[1]) : c_defaultIterations;
+    if (iterations < 1)
+    {
+        printf("Iterations must be at least 1.\n");
+        return 1;
+    }
+
+    GfxComputeContext context;
+    GfxComputeKernel kernel;
+    if (SLANG_FAILED(CreateGfxComputeContext(DeviceType::CPU, context)) ||
+        SLANG_FAILED(LoadComputeKernel(context.device, c_moduleName, c_entryPointName, kernel)))
+    {
+        printf("Could not create the CPU device and load %s:%s.\n", c_moduleName, c_entryPointName);
+        return 1;
+    }
+
+    ComPtr<IBufferResource> buffer;
+    ComPtr<IResourceView> view;
+    ComPtr<IShaderObject> rootObject;
+    if (SLANG_FAILED(CreateFloatBuffer(context.device, c_elementCount, nullptr, buffer.writeRef(), view.writeRef())) ||
+        SLANG_FAILED(context.device->createMutableRootShaderObject(kernel.program, rootObject.writeRef())))
+    {
+        printf("Could not create the buffer and root shader object.\n");
+        return 1;
+    }
+
+    ShaderLayoutCache layoutCache;
+    const ShaderObjectLayout& layout = layoutCache.getLayout(kernel.program, rootObject);
+    const ParamSlots slots =
+    {
+        layout.find("params.tint"),
+        layout.find("params.transform.scale"),
+        layout.find("params.transform.bias"),
+        layout.find("params.transform.count"),
+        layout.find("params.transform.offset"),
+        layout.find("Data"),
+    };
+    if (!slots.tint || !slots.scale || !slots.bias || !slots.count || !slots.offset || !slots.data)
+    {
+        printf("%s is missing parameters.\n", c_moduleName);
+        return 1;
+    }
+
+    printf("Shader object parameter binding: %s:%s, %i slots, %zu byte uniform block, %i binds, best of %i runs\n\n",
+        c_moduleName, c_entryPointName, int(layout.getSlots().size()), layout.getUniformSize(), iterations, c_repeatCount);
+
+    const bool structMatches = layout.matches(c_paramsBlockFields, sizeof(c_paramsBlockFields) / sizeof(c_paramsBlockFields[0]), sizeof(ParamsBlock));
+
+    int failures = 0;
+    for (int method = 0; method < BindMethod_Count; method++)
+    {
+        if (method == BindMethod_Struct && !structMatches)
+        {
+            printf("    %-40s skipped, ParamsBlock doesn't match the shader's layout\n", c_bindMethodNames[method]);
+            continue;
+        }
+
+        // Small integers and quarters keep the expected values exact
+        ParamsBlock params = { { 0.25f, 0.0f, 0.0f, 0.0f }, 2.0f, 0.5f, uint32_t(c_elementCount / 2 + method), uint32_t(method) };
+
+        double ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            for (int i = 0; i < iterations; i++)
+                Bind(BindMethod(method), rootObject, layout, slots, params, view);
+        });
+        PrintBenchResult(c_bindMethodNames[method], ms, double(iterations), "binds");
+
+        // Bind this way once more, to a cleared buffer, then dispatch and check
+        const std::vector<float> zeros(c_elementCount, 0.0f);
+        ComPtr<IBufferResource> checkBuffer;
+        ComPtr<IResourceView> checkView;
+        ComPtr<ISlangBlob> readback;
+        const int groupCount = (c_elementCount + int(kernel.numThreads[0]) - 1) / int(kernel.numThreads[0]);
+        if (SLANG_FAILED(CreateFloatBuffer(context.device, c_elementCount, zeros.data(), checkBuffer.writeRef(), checkView.writeRef())))
+        {
+            printf("    ERROR: could not create the check buffer\n");
+            failures++;
+            continue;
+        }
+        Bind(BindMethod(method), rootObject, layout, slots, params, checkView);
+        if (SLANG_FAILED(DispatchWithRootObjectAndWait(context, kernel, rootObject, groupCount)) ||
+            SLANG_FAILED(context.device->readBufferResource(checkBuffer, 0, c_elementCount * sizeof(float), readback.writeRef())))
+        {
+            printf("    ERROR: dispatch failed\n");
+            failures++;
+            continue;
+        }
+
+        const float* values = (const float*)readback->getBufferPointer();
+        for (int i = 0; i < c_elementCount; i++)
+        {
+            const float expected = uint32_t(i) < params.count ? float(i + int(params.offset)) * params.scale + params.bias + params.tint[0] : 0.0f;
+            if (values[i] != expected)
+            {
+                printf("    ERROR: Data[%i] is %f, expected %f\n", i, values[i], expected);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    return failures ? 1 : 0;
+}
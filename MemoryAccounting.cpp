@@ -0,0 +1,45 @@
+#include "MemoryAccounting.h"
+
+#include <stdio.h>
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#   include <psapi.h>
+#else
+#   include <unistd.h>
+#endif
+
+const char* GetMemoryCategoryName(MemoryCategory category)
+{
+    switch (category)
+    {
+    case MemoryCategory::GlobalSession: return "global session";
+    case MemoryCategory::Session:       return "sessions";
+    case MemoryCategory::Module:        return "modules";
+    case MemoryCategory::Reflection:    return "reflection";
+    case MemoryCategory::Blob:          return "output blobs";
+    default:                            return "unknown";
+    }
+}
+
+uint64_t GetProcessMemoryBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS_EX counters = {};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters)))
+        return 0;
+    return uint64_t(counters.PrivateUsage);
+#else
+    // statm's second field is the resident set, in pages
+    FILE* file = nullptr;
+    fopen_s(&file, "/proc/self/statm", "rb");
+    if (!file)
+        return 0;
+    unsigned long long sizePages = 0, residentPages = 0;
+    const int read = fscanf(file, "%llu %llu", &sizePages, &residentPages);
+    fclose(file);
+    return read == 2 ? uint64_t(residentPages) * uint64_t(sysconf(_SC_PAGESIZE)) : 0;
+#endif
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+// Attributes memory to the slang objects a long running compile service keeps alive.
+//
+// Slang allocates with its own allocator inside its library and has no allocator hook, so what it allocates can't be
+// counted as it happens. Instead each operation that creates an object is bracketed by a MemoryScope, which measures
+// the process's memory before and after (GetProcessMemoryBytes) and attributes the growth to the object's category.
+// Output blobs are the exception: their size is known exactly. The attribution is approximate: the scopes must not
+// overlap other threads' allocations (callers hold a lock across them), and heap memory freed and reused inside a
+// scope makes it read low. Once anything has been released the heap reuses its memory, so an object created again reads
+// close to 0: callers should measure an object the first time it's created and keep that as its estimate.
+//
+// The accounted total is a sum of those estimates. A budget held against it holds the estimates, not the process's
+// real memory, and the two drift apart as the heap fragments or keeps freed memory.
+//
+// When an object is released its attributed bytes are taken off its category again, so the accounted total follows
+// what's being kept alive even though the process's heap may not give the memory back to the OS.
+
+#include <stdint.h>
+
+enum class MemoryCategory
+{
+    GlobalSession,
+    Session,
+    Module,
+    Reflection,
+    Blob,
+    Count,
+};
+
+const char* GetMemoryCategoryName(MemoryCategory category);
+
+/// The process's committed private memory on Windows, its resident set elsewhere. 0 if it can't be read.
+uint64_t GetProcessMemoryBytes();
+
+struct MemoryFootprint
+{
+    uint64_t    bytes[int(MemoryCategory::Count)] = {};
+    int         objects[int(MemoryCategory::Count)] = {};
+    uint64_t    processBytes = 0;   ///< GetProcessMemoryBytes() when the footprint was taken
+
+    uint64_t getTotalBytes() const
+    {
+        uint64_t total = 0;
+        for (uint64_t categoryBytes : bytes)
+            total += categoryBytes;
+        return total;
+    }
+
+    void add(MemoryCategory category, uint64_t categoryBytes)
+    {
+        bytes[int(category)] += categoryBytes;
+        objects[int(category)]++;
+    }
+
+    void remove(MemoryCategory category, uint64_t categoryBytes)
+    {
+        bytes[int(category)] -= categoryBytes < bytes[int(category)] ? categoryBytes : bytes[int(category)];
+        objects[int(category)]--;
+    }
+};
+
+/// Measures how much the process's memory grew between construction and getGrowthBytes(). Never negative.
+class MemoryScope
+{
+public:
+    MemoryScope() : m_startBytes(GetProcessMemoryBytes()) {}
+
+    uint64_t getGrowthBytes() const
+    {
+        const uint64_t bytes = GetProcessMemoryBytes();
+        return bytes > m_startBytes ? bytes - m_startBytes : 0;
+    }
+
+protected:
+    uint64_t    m_startBytes;
+};
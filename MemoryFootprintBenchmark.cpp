@@ -0,0 +1,169 @@
+// Measures what a compile service keeps in memory with WarmSessionCache (WarmSessionCache.h): a workload of generated
+// modules, compiled with reflection in several sessions (one per set of defines, as for several projects), is kept
+// warm without a budget, and the footprint printed per category (global session, sessions, modules, reflection, output
+// blobs). Evicting every session shows how much of that the process gives back.
+//
+// The workload is then run twice under a budget, by default the global session and half the rest of the unbounded
+// footprint, evicting least recently used sessions to stay inside it. The accounted total must stay within the budget
+// after every compile. The budget holds the accounting's estimates, not real memory, so how far the process grew past
+// or short of the accounted total is printed next to it.
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "RunModes.h"
+#include "WarmSessionCache.h"
+
+static const int    c_defaultSessionCount   = 8;
+static const int    c_modulesPerSession     = 4;
+
+static std::string MakeModuleSource(int module)
+{
+    // VARIANT comes from the session's defines
+    return "RWStructuredBuffer<float> Data;\n"
+        "cbuffer Params\n{\n    float4 scale;\n    float4 bias;\n    uint count;\n};\n"
+        "float shade" + std::to_string(module) + "(float x)\n{\n"
+        "    for (int i = 0; i < 8 + VARIANT; i++)\n        x = x * scale.x + sin(x + bias.y * float(i));\n    return x;\n}\n"
+        "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\n"
+        "void csmain(uint3 DTid : SV_DispatchThreadID)\n{\n"
+        "    if (DTid.x >= count) return;\n"
+        "    Data[DTid.x] = shade" + std::to_string(module) + "(Data[DTid.x]);\n}\n";
+}
+
+static std::vector<WarmCompileDesc> MakeWorkload(int sessionCount)
+{
+    std::vector<WarmCompileDesc> workload;
+    for (int session = 0; session < sessionCount; session++)
+    {
+        for (int module = 0; module < c_modulesPerSession; module++)
+        {
+            WarmCompileDesc desc;
+            desc.moduleName = "module" + std::to_string(module);
+            desc.source = MakeModuleSource(module);
+            desc.defines.push_back({ "VARIANT", std::to_string(session) });
+            desc.reflect = true;
+            workload.push_back(desc);
+        }
+    }
+    return workload;
+}
+
+static void PrintFootprint(const char* label, const MemoryFootprint& footprint)
+{
+    printf("  %s\n", label);
+    printf("    %-24s %9s %14s\n", "category", "objects", "KB");
+    for (int category = 0; category < int(MemoryCategory::Count); category++)
+    {
+        printf("    %-24s %9i %14.1f\n", GetMemoryCategoryName(MemoryCategory(category)), footprint.objects[category],
+            double(footprint.bytes[category]) / 1024.0);
+    }
+    printf("    %-24s %9s %14.1f\n", "accounted total", "", double(footprint.getTotalBytes()) / 1024.0);
+    printf("    %-24s %9s %14.1f\n\n", "process", "", double(footprint.processBytes) / 1024.0);
+}
+
+struct WorkloadCounts
+{
+    int     compiles = 0;
+    int     codeHits = 0;
+    int     sessionMisses = 0;
+    int     overBudget = 0;     ///< Compiles after which the footprint was over budget with more than one session
+    double  ms = 0.0;
+};
+
+static bool RunWorkload(WarmSessionCache& cache, const std::vector<WarmCompileDesc>& workload, WorkloadCounts& counts)
+{
+    Timer timer;
+    for (const WarmCompileDesc& desc : workload)
+    {
+        WarmCompileResult result;
+        if (SLANG_FAILED(cache.compile(desc, result)) || !result.code || !result.layout)
+        {
+            printf("    ERROR: %s did not compile:\n%s", desc.moduleName.c_str(), result.diagnostics.c_str());
+            return false;
+        }
+        counts.compiles++;
+        counts.codeHits += result.codeHit ? 1 : 0;
+        counts.sessionMisses += result.sessionHit ? 0 : 1;
+        if (cache.getBudgetBytes() && cache.getFootprint().getTotalBytes() > cache.getBudgetBytes() && cache.getSessionCount() > 1)
+            counts.overBudget++;
+    }
+    counts.ms += timer.elapsedMs();
+    return true;
+}
+
+int RunMemoryFootprintBenchmark(int argc, char** argv)
+{
+    const int sessionCount = argc > 1 ? atoi(argv[1]) : c_defaultSessionCount;
+    uint64_t budgetBytes = argc > 2 ? uint64_t(atoll(argv[2])) * 1024 : 0;
+    if (sessionCount < 2)
+    {
+        printf("Session count must be at least 2.\n");
+        return 1;
+    }
+
+    const std::vector<WarmCompileDesc> workload = MakeWorkload(sessionCount);
+    printf("Memory footprint: %i sessions of %i modules each, compiled to hlsl with reflection\n\n", sessionCount, c_modulesPerSession);
+
+    int failures = 0;
+    {
+        const uint64_t processBytesBefore = GetProcessMemoryBytes();
+        WarmSessionCache cache(0);
+        WorkloadCounts cold, warm;
+        if (!RunWorkload(cache, workload, cold) || !RunWorkload(cache, workload, warm))
+            return 1;
+        const MemoryFootprint footprint = cache.getFootprint();
+        PrintFootprint("unbounded, every session warm", footprint);
+        if (warm.codeHits != warm.compiles)
+        {
+            printf("    ERROR: compiling the workload again should only have hit the cache\n");
+            failures++;
+        }
+
+        while (cache.evictLeastRecentlyUsed())
+        {
+        }
+        const MemoryFootprint evicted = cache.getFootprint();
+        printf("    %-40s %.1f\n", "process growth KB, everything warm", double(footprint.processBytes - std::min(footprint.processBytes, processBytesBefore)) / 1024.0);
+        printf("    %-40s %.1f\n", "process KB given back by evicting all", double(footprint.processBytes - std::min(footprint.processBytes, evicted.processBytes)) / 1024.0);
+        printf("    %-40s %.3f cold, %.3f warm\n\n", "workload ms", cold.ms, warm.ms);
+
+        // The global session can't be evicted, so the default budget is it and half of everything else
+        const uint64_t globalSessionBytes = footprint.bytes[int(MemoryCategory::GlobalSession)];
+        if (!budgetBytes)
+            budgetBytes = globalSessionBytes + (footprint.getTotalBytes() - globalSessionBytes) / 2;
+    }
+
+    const uint64_t processBytesBefore = GetProcessMemoryBytes();
+    WarmSessionCache cache(budgetBytes);
+    WorkloadCounts counts;
+    if (!RunWorkload(cache, workload, counts) || !RunWorkload(cache, workload, counts))
+        return 1;
+    char label[128];
+    snprintf(label, sizeof(label), "budget %.1f KB, workload run twice", double(budgetBytes) / 1024.0);
+    const MemoryFootprint footprint = cache.getFootprint();
+    PrintFootprint(label, footprint);
+
+    // Sessions created again after an eviction reuse the heap the evicted ones freed, so the process's growth is
+    // around the largest set of sessions kept at once, not the sum of everything created
+    const double processGrowthKB = double(footprint.processBytes - std::min(footprint.processBytes, processBytesBefore)) / 1024.0;
+    const double accountedKB = double(footprint.getTotalBytes()) / 1024.0;
+    printf("    %-40s %.1f\n", "process growth KB", processGrowthKB);
+    printf("    %-40s %+.1f\n", "process growth less accounted KB", processGrowthKB - accountedKB);
+
+    printf("    %-40s %i of %i\n", "sessions kept", cache.getSessionCount(), sessionCount);
+    printf("    %-40s %i\n", "sessions created", counts.sessionMisses);
+    printf("    %-40s %i\n", "sessions evicted", cache.getEvictedSessionCount());
+    printf("    %-40s %i of %i\n", "cached code hits", counts.codeHits, counts.compiles);
+    printf("    %-40s %.3f\n", "workload ms, both runs", counts.ms);
+    if (counts.overBudget)
+    {
+        printf("    ERROR: over budget after %i compiles\n", counts.overBudget);
+        failures++;
+    }
+
+    return failures ? 1 : 0;
+}
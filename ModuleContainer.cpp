@@ -0,0 +1,193 @@
+#include "ModuleContainer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "slang/slang-com-helper.h"
+#include "slang/slang-com-ptr.h"
+
+#include "SlangHelpers.h"
+
+static std::string GetDependencyFileName(const char* containerFileName)
+{
+    return std::string(containerFileName) + ".deps";
+}
+
+static bool ReadBinaryFile(const char* fileName, std::vector<char>& outData)
+{
+    FILE* file = nullptr;
+    fopen_s(&file, fileName, "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    outData.resize(size_t(ftell(file)));
+    fseek(file, 0, SEEK_SET);
+    const size_t readSize = outData.empty() ? 0 : fread(outData.data(), 1, outData.size(), file);
+    fclose(file);
+    return readSize == outData.size();
+}
+
+bool HashFileContents(const char* fileName, uint64_t& outHash)
+{
+    std::vector<char> data;
+    if (!ReadBinaryFile(fileName, data))
+        return false;
+
+    outHash = HashBytes(c_fnvOffsetBasis, data.data(), data.size());
+    return true;
+}
+
+SlangResult BuildModuleContainer(SlangSession* session, const char* sourceFileName, const char* containerFileName, std::string& outDiagnostics)
+{
+    SlangCompileRequest* request = spCreateCompileRequest(session);
+    spSetOutputContainerFormat(request, SLANG_CONTAINER_FORMAT_SLANG_MODULE);
+    const int translationUnitIndex = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_SLANG, "");
+    spAddTranslationUnitSourceFile(request, translationUnitIndex, sourceFileName);
+
+    SlangResult result = spCompile(request);
+    const char* diagnostics = spGetDiagnosticOutput(request);
+    outDiagnostics = diagnostics ? diagnostics : "";
+
+    Slang::ComPtr<ISlangBlob> container;
+    if (SLANG_SUCCEEDED(result))
+        result = spGetContainerCode(request, container.writeRef());
+
+    // Hash what this compile actually read, so an edit to an #included file also makes the container stale
+    std::string dependencies = std::string("# slang ") + spGetBuildTagString() + "\n";
+    if (SLANG_SUCCEEDED(result))
+    {
+        const int dependencyCount = spGetDependencyFileCount(request);
+        for (int i = 0; i < dependencyCount && SLANG_SUCCEEDED(result); i++)
+        {
+            const char* path = spGetDependencyFilePath(request, i);
+            uint64_t hash = 0;
+            if (!HashFileContents(path, hash))
+            {
+                outDiagnostics += std::string("Could not read dependency ") + path + "\n";
+                result = SLANG_E_NOT_FOUND;
+                break;
+            }
+            dependencies += HashToHex(hash) + " ";
+            dependencies += path;
+            dependencies += "\n";
+        }
+    }
+    spDestroyCompileRequest(request);
+    if (SLANG_FAILED(result))
+        return result;
+
+    // The dependency file goes first and comes back last, so it never vouches for a partly written container
+    const std::string dependencyFileName = GetDependencyFileName(containerFileName);
+    remove(dependencyFileName.c_str());
+
+    FILE* file = nullptr;
+    fopen_s(&file, containerFileName, "wb");
+    if (!file)
+    {
+        outDiagnostics += std::string("Could not open ") + containerFileName + " for writing.\n";
+        return SLANG_E_CANNOT_OPEN;
+    }
+    const size_t containerSize = container->getBufferSize();
+    const bool containerWritten = fwrite(container->getBufferPointer(), 1, containerSize, file) == containerSize;
+    fclose(file);
+
+    fopen_s(&file, dependencyFileName.c_str(), "wb");
+    if (!containerWritten || !file)
+    {
+        if (file)
+            fclose(file);
+        outDiagnostics += std::string("Could not write ") + (containerWritten ? dependencyFileName.c_str() : containerFileName) + ".\n";
+        return SLANG_E_CANNOT_OPEN;
+    }
+    fwrite(dependencies.data(), 1, dependencies.size(), file);
+    fclose(file);
+    return SLANG_OK;
+}
+
+bool IsModuleContainerCurrent(const char* containerFileName, std::string& outReason)
+{
+    FILE* container = nullptr;
+    fopen_s(&container, containerFileName, "rb");
+    if (!container)
+    {
+        outReason = std::string(containerFileName) + " doesn't exist";
+        return false;
+    }
+    fclose(container);
+
+    const std::string dependencyFileName = GetDependencyFileName(containerFileName);
+    FILE* file = nullptr;
+    fopen_s(&file, dependencyFileName.c_str(), "rb");
+    if (!file)
+    {
+        outReason = dependencyFileName + " doesn't exist";
+        return false;
+    }
+
+    // Containers hold slang's internal IR, which isn't stable across slang versions
+    const std::string buildTagLine = std::string("# slang ") + spGetBuildTagString();
+    bool buildTagMatched = false;
+    int dependencyCount = 0;
+    outReason.clear();
+
+    char line[2048];
+    while (outReason.empty() && fgets(line, sizeof(line), file))
+    {
+        size_t length = strlen(line);
+        while (length && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+            line[--length] = 0;
+        if (!length)
+            continue;
+
+        if (line[0] == '#')
+        {
+            buildTagMatched |= buildTagLine == line;
+            continue;
+        }
+
+        unsigned long long expectedHash = 0;
+        int pathStart = 0;
+        if (sscanf(line, "%llx %n", &expectedHash, &pathStart) != 1 || !line[pathStart])
+        {
+            outReason = dependencyFileName + " is malformed";
+            break;
+        }
+        const char* path = line + pathStart;
+        uint64_t hash = 0;
+        if (!HashFileContents(path, hash))
+            outReason = std::string(path) + " is missing";
+        else if (hash != uint64_t(expectedHash))
+            outReason = std::string(path) + " changed";
+        dependencyCount++;
+    }
+    fclose(file);
+
+    if (outReason.empty() && !buildTagMatched)
+        outReason = std::string("it was built by another slang version than ") + spGetBuildTagString();
+    else if (outReason.empty() && !dependencyCount)
+        outReason = dependencyFileName + " lists no sources";
+    return outReason.empty();
+}
+
+SlangResult AddModuleContainerReference(SlangSession* session, SlangCompileRequest* request, const char* sourceFileName,
+    const char* containerFileName, bool& outRebuilt, std::string& outDiagnostics)
+{
+    outRebuilt = false;
+    outDiagnostics.clear();
+
+    std::string reason;
+    if (!IsModuleContainerCurrent(containerFileName, reason))
+    {
+        SLANG_RETURN_ON_FAIL(BuildModuleContainer(session, sourceFileName, containerFileName, outDiagnostics));
+        outRebuilt = true;
+    }
+
+    std::vector<char> container;
+    if (!ReadBinaryFile(containerFileName, container))
+    {
+        outDiagnostics += std::string("Could not read ") + containerFileName + ".\n";
+        return SLANG_E_CANNOT_OPEN;
+    }
+    return spAddLibraryReference(request, container.data(), container.size());
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// Precompiles a shared slang module into a .slang-module container (SLANG_CONTAINER_FORMAT_SLANG_MODULE), which holds
+// the module's already parsed and checked IR, so downstream builds link against it instead of compiling its source.
+//
+// Next to each container is a dependency file, <container>.deps, listing every file the module's compile read (the
+// module itself and anything it #includes or imports) with a hash of its contents, plus the slang build tag:
+//   # slang <build tag>
+//   <hash> <path>
+// The container is stale if any of those files changed, went missing, or slang was updated, and is then rebuilt.
+//
+// A downstream translation unit can't import a container; it declares what it uses from the module with `extern`, and
+// the definitions come from the container when the program is linked.
+
+#include <stdint.h>
+#include <string>
+
+#include "slang/slang.h"
+
+/// 64 bit FNV-1a hash of a file's contents. False if it couldn't be read.
+bool HashFileContents(const char* fileName, uint64_t& outHash);
+
+/// Compiles sourceFileName as a library (no entry points) and writes it to containerFileName, with its dependency file.
+SlangResult BuildModuleContainer(SlangSession* session, const char* sourceFileName, const char* containerFileName, std::string& outDiagnostics);
+
+/// True if the container and its dependency file exist and every dependency still hashes the same. Otherwise false,
+/// with why in outReason.
+bool IsModuleContainerCurrent(const char* containerFileName, std::string& outReason);
+
+/// Adds the container to the request as a library reference, rebuilding it from sourceFileName first if it is stale.
+/// outRebuilt says whether it was.
+SlangResult AddModuleContainerReference(SlangSession* session, SlangCompileRequest* request, const char* sourceFileName,
+    const char* containerFileName, bool& outRebuilt, std::string& outDiagnostics);
@@ -0,0 +1,200 @@
+// Compares compiling a kernel together with the source of a large shared library against linking it with the library
+// precompiled into a .slang-module container (ModuleContainer.h).
+//
+// The library is generated: a number of functions, written to out_library.slang. The kernel declares the one it
+// calls with `extern` and is compiled to hlsl both ways, from the same session. The container path includes the
+// staleness check (hashing the library source) on every compile, as a build would. Then the library is edited, to
+// check that the container is found stale, rebuilt, and current again.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "Bench.h"
+#include "ModuleContainer.h"
+#include "RunModes.h"
+
+static const char*              c_libraryFileName       = "out_library.slang";
+static const char*              c_containerFileName     = "out_library.slang-module";
+static const char*              c_kernelFileName        = "library_user.slang";
+static const char*              c_entryPointName        = "csmain";
+static const SlangCompileTarget c_compileTarget         = SLANG_HLSL;
+static const char*              c_compileProfile        = "cs_5_1";
+static const int                c_defaultFunctionCount  = 2000;
+static const int                c_defaultRepeatCount    = 10;
+
+static const char* c_kernelSource =
+    "extern float libraryEntry(float x);\n"
+    "\n"
+    "RWBuffer<float> Data;\n"
+    "\n"
+    "[shader(\"compute\")]\n"
+    "[numthreads(64, 1, 1)]\n"
+    "void csmain(uint3 DTid : SV_DispatchThreadID)\n"
+    "{\n"
+    "    Data[DTid.x] = libraryEntry(Data[DTid.x]);\n"
+    "}\n";
+
+/// Writes a library of functionCount functions. The seed goes into every one, so changing it edits the whole file.
+static bool WriteLibrary(int functionCount, int seed)
+{
+    FILE* file = nullptr;
+    fopen_s(&file, c_libraryFileName, "wb");
+    if (!file)
+        return false;
+
+    fprintf(file, "// Generated by the modulecontainer run mode\n\n");
+    for (int i = 0; i < functionCount; i++)
+    {
+        fprintf(file, "float libraryFunc%i(float x)\n{\n", i);
+        fprintf(file, "    float y = x * %i.0 + %i.0;\n", i + 1, seed);
+        fprintf(file, "    for (int i = 0; i < 4; i++)\n        y = y * 0.5 + sin(y);\n");
+        fprintf(file, "    return y;\n}\n\n");
+    }
+    fprintf(file, "float libraryEntry(float x)\n{\n    return libraryFunc0(x) + libraryFunc%i(x);\n}\n", functionCount - 1);
+    fclose(file);
+    return true;
+}
+
+static SlangCompileRequest* CreateKernelRequest(SlangSession* session)
+{
+    SlangCompileRequest* request = spCreateCompileRequest(session);
+    spSetCodeGenTarget(request, c_compileTarget);
+    spSetTargetProfile(request, 0, spFindProfile(session, c_compileProfile));
+    return request;
+}
+
+static void AddKernel(SlangCompileRequest* request)
+{
+    const int translationUnitIndex = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_SLANG, "");
+    spAddTranslationUnitSourceString(request, translationUnitIndex, c_kernelFileName, c_kernelSource);
+    spAddEntryPoint(request, translationUnitIndex, c_entryPointName, SLANG_STAGE_COMPUTE);
+}
+
+/// Compiles the request and checks it produced code for the kernel. Prints the diagnostics if not.
+static bool CompileKernel(SlangCompileRequest* request, const char* label)
+{
+    size_t codeSize = 0;
+    if (SLANG_SUCCEEDED(spCompile(request)))
+        spGetEntryPointCode(request, 0, &codeSize);
+    if (codeSize)
+        return true;
+
+    const char* diagnostics = spGetDiagnosticOutput(request);
+    printf("    ERROR: %s compile failed\n%s", label, diagnostics ? diagnostics : "");
+    return false;
+}
+
+/// The whole library is parsed and checked along with the kernel, as its own translation unit.
+static bool CompileFromSource(SlangSession* session)
+{
+    SlangCompileRequest* request = CreateKernelRequest(session);
+    const int libraryUnitIndex = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_SLANG, "");
+    spAddTranslationUnitSourceFile(request, libraryUnitIndex, c_libraryFileName);
+    AddKernel(request);
+    const bool ok = CompileKernel(request, "from source");
+    spDestroyCompileRequest(request);
+    return ok;
+}
+
+/// Only the kernel is parsed; the library's IR comes from the container.
+static bool CompileWithContainer(SlangSession* session, bool& outRebuilt)
+{
+    SlangCompileRequest* request = CreateKernelRequest(session);
+    std::string diagnostics;
+    bool ok = SLANG_SUCCEEDED(AddModuleContainerReference(session, request, c_libraryFileName, c_containerFileName, outRebuilt, diagnostics));
+    if (!ok)
+        printf("    ERROR: could not use %s\n%s", c_containerFileName, diagnostics.c_str());
+    else
+    {
+        AddKernel(request);
+        ok = CompileKernel(request, "container");
+    }
+    spDestroyCompileRequest(request);
+    return ok;
+}
+
+int RunModuleContainerBenchmark(int argc, char** argv)
+{
+    const int functionCount = argc > 1 ? atoi(argv[1]) : c_defaultFunctionCount;
+    const int repeatCount = argc > 2 ? atoi(argv[2]) : c_defaultRepeatCount;
+    if (functionCount < 1 || repeatCount < 1)
+    {
+        printf("Function and repeat counts must be at least 1.\n");
+        return 1;
+    }
+    if (!WriteLibrary(functionCount, 0))
+    {
+        printf("Could not open %s for writing.\n", c_libraryFileName);
+        return 1;
+    }
+
+    printf("Module containers: %s:%s against a %i function library, best of %i compiles\n\n",
+        c_kernelFileName, c_entryPointName, functionCount, repeatCount);
+
+    SlangSession* session = spCreateSession(NULL);
+    int failures = 0;
+
+    std::string reason;
+    if (!IsModuleContainerCurrent(c_containerFileName, reason))
+        printf("    %-40s %s\n", "container stale", reason.c_str());
+
+    Timer timer;
+    std::string diagnostics;
+    if (SLANG_FAILED(BuildModuleContainer(session, c_libraryFileName, c_containerFileName, diagnostics)))
+    {
+        printf("    ERROR: could not build %s\n%s", c_containerFileName, diagnostics.c_str());
+        spDestroySession(session);
+        return 1;
+    }
+    printf("    %-40s %10.3f ms\n", "container build", timer.elapsedMs());
+
+    bool ok = true;
+    double ms = TimeBestMs(repeatCount, [&]()
+    {
+        ok &= CompileFromSource(session);
+    });
+    PrintBenchResult("compile with library source", ms, 1.0, "compiles");
+    failures += ok ? 0 : 1;
+    const double sourceMs = ms;
+
+    ok = true;
+    bool rebuilt = false, anyRebuilt = false;
+    ms = TimeBestMs(repeatCount, [&]()
+    {
+        ok &= CompileWithContainer(session, rebuilt);
+        anyRebuilt |= rebuilt;
+    });
+    PrintBenchResult("compile with library container", ms, 1.0, "compiles");
+    failures += ok ? 0 : 1;
+    if (anyRebuilt)
+    {
+        printf("    ERROR: the container was rebuilt though the library didn't change\n");
+        failures++;
+    }
+    printf("    %-40s %10.2fx\n", "speedup", ms > 0.0 ? sourceMs / ms : 0.0);
+
+    // Edit the library: the container must be stale, rebuilt on the next compile, and current after that
+    printf("\n");
+    WriteLibrary(functionCount, 1);
+    const bool staleAfterEdit = !IsModuleContainerCurrent(c_containerFileName, reason);
+    printf("    %-40s %s\n", "after editing the library", staleAfterEdit ? ("stale, " + reason).c_str() : "current");
+    if (!staleAfterEdit)
+    {
+        printf("    ERROR: the container is current though the library changed\n");
+        failures++;
+    }
+
+    timer.reset();
+    rebuilt = false;
+    failures += CompileWithContainer(session, rebuilt) ? 0 : 1;
+    printf("    %-40s %10.3f ms, %s\n", "compile after the edit", timer.elapsedMs(), rebuilt ? "rebuilt" : "not rebuilt");
+    if (!rebuilt || !IsModuleContainerCurrent(c_containerFileName, reason))
+    {
+        printf("    ERROR: the stale container wasn't rebuilt\n");
+        failures++;
+    }
+
+    spDestroySession(session);
+    return failures ? 1 : 0;
+}
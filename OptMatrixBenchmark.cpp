@@ -0,0 +1,340 @@
+// Measures what slang's optimization and debug info levels cost and buy: a small corpus of kernels is compiled for
+// every (optimization level, debug info level, target) combination, timing the compile and measuring the output.
+//
+// Host callable (cpu) builds are also run: the entry point is looked up in the shared library slang produced and
+// dispatched on CPUDispatcher workers over a buffer, and its output is checked against the unoptimized, no debug info
+// build of the same kernel. Targets whose downstream compiler isn't installed (dxc for dxil, glslang for spirv, a C++
+// compiler for cpu) show up as unavailable rather than failing the run; any other compile failure fails it.
+//
+// The table is also written to out_optmatrix.csv, so build settings can be picked from the data.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "CPUDispatcher.h"
+#include "RunModes.h"
+
+#include "slang/slang-com-ptr.h"
+
+using Slang::ComPtr;
+
+static const char*      c_fileNameTable         = "out_optmatrix.csv";
+static const char*      c_entryPointName        = "csmain";
+static const uint32_t   c_threadsPerGroup       = 64;
+static const int        c_defaultElementCount   = 1 << 20;
+static const int        c_defaultRepeatCount    = 5;
+static const float      c_tolerance             = 1e-4f;
+
+// What slang says when a target's downstream compiler can't be found or loaded
+static const char*      c_missingCompilerDiagnostics[] =
+{
+    "failed to load downstream compiler",
+    "compiler not defined for transition",
+};
+
+struct CorpusKernel
+{
+    const char* name;
+    const char* source;
+};
+
+// Each kernel reads and writes Data in place, one thread per element
+static const CorpusKernel c_corpus[] =
+{
+    { "scale",
+        "RWStructuredBuffer<float> Data;\n"
+        "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\n"
+        "void csmain(uint3 DTid : SV_DispatchThreadID)\n{\n"
+        "    uint count, stride;\n    Data.GetDimensions(count, stride);\n    if (DTid.x >= count) return;\n"
+        "    Data[DTid.x] = Data[DTid.x] * 1.5 + 0.25;\n}\n" },
+    { "polynomial",
+        "RWStructuredBuffer<float> Data;\n"
+        "float evaluate(float x)\n{\n"
+        "    float y = 0.0;\n    for (int i = 0; i < 64; i++)\n        y = y * x + float(i % 7) * 0.125;\n    return y;\n}\n"
+        "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\n"
+        "void csmain(uint3 DTid : SV_DispatchThreadID)\n{\n"
+        "    uint count, stride;\n    Data.GetDimensions(count, stride);\n    if (DTid.x >= count) return;\n"
+        "    Data[DTid.x] = evaluate(Data[DTid.x] * 0.5);\n}\n" },
+    { "complex",
+        "RWStructuredBuffer<float> Data;\n"
+        "struct Complex\n{\n    float re;\n    float im;\n"
+        "    Complex square() { Complex c; c.re = re * re - im * im; c.im = 2.0 * re * im; return c; }\n"
+        "    Complex add(Complex o) { Complex c; c.re = re + o.re; c.im = im + o.im; return c; }\n"
+        "    float lengthSquared() { return re * re + im * im; }\n};\n"
+        "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\n"
+        "void csmain(uint3 DTid : SV_DispatchThreadID)\n{\n"
+        "    uint count, stride;\n    Data.GetDimensions(count, stride);\n    if (DTid.x >= count) return;\n"
+        "    Complex c;\n    c.re = Data[DTid.x] * 0.4 - 0.3;\n    c.im = float(DTid.x % 97) / 485.0 - 0.1;\n"
+        "    Complex z = c;\n"
+        "    for (int i = 0; i < 32; i++)\n        z = z.square().add(c);\n"
+        "    Data[DTid.x] = z.lengthSquared();\n}\n" },
+};
+
+struct MatrixTarget
+{
+    const char*         name;
+    SlangCompileTarget  target;
+    const char*         profile;        ///< null for none
+};
+
+static const MatrixTarget c_targets[] =
+{
+    { "hlsl", SLANG_HLSL, "cs_5_1" },
+    { "glsl", SLANG_GLSL, "glsl_450" },
+    { "spirv", SLANG_SPIRV, "glsl_450" },
+    { "dxil", SLANG_DXIL, "cs_6_0" },
+    { "cpu", SLANG_SHADER_HOST_CALLABLE, nullptr },
+};
+
+struct NamedLevel
+{
+    const char*         name;
+    int                 level;
+};
+
+static const NamedLevel c_optimizationLevels[] =
+{
+    { "none", SLANG_OPTIMIZATION_LEVEL_NONE },
+    { "default", SLANG_OPTIMIZATION_LEVEL_DEFAULT },
+    { "high", SLANG_OPTIMIZATION_LEVEL_HIGH },
+    { "maximal", SLANG_OPTIMIZATION_LEVEL_MAXIMAL },
+};
+
+static const NamedLevel c_debugInfoLevels[] =
+{
+    { "none", SLANG_DEBUG_INFO_LEVEL_NONE },
+    { "minimal", SLANG_DEBUG_INFO_LEVEL_MINIMAL },
+    { "standard", SLANG_DEBUG_INFO_LEVEL_STANDARD },
+    { "maximal", SLANG_DEBUG_INFO_LEVEL_MAXIMAL },
+};
+
+struct MatrixResult
+{
+    bool                            compiled = false;
+    bool                            unavailable = false;    ///< Didn't compile for want of a downstream compiler
+    double                          compileMs = 0.0;
+    size_t                          codeSize = 0;       ///< 0 for cpu, whose output is a loaded shared library
+    double                          runMs = -1.0;       ///< -1 if not run
+    std::string                     firstDiagnostic;
+};
+
+/// The globals of every corpus kernel as the C++ target lays them out
+struct CorpusGlobals
+{
+    RWStructuredBuffer<float>       Data;
+};
+
+static std::string FirstLine(const char* text)
+{
+    std::string line = text ? text : "";
+    const size_t end = line.find_first_of("\r\n");
+    return end == std::string::npos ? line : line.substr(0, end);
+}
+
+static bool IsMissingCompilerDiagnostic(const char* diagnostics)
+{
+    for (const char* missing : c_missingCompilerDiagnostics)
+    {
+        if (diagnostics && strstr(diagnostics, missing))
+            return true;
+    }
+    return false;
+}
+
+static void InitialData(std::vector<float>& data)
+{
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = float(i % 1024) / 1024.0f;
+}
+
+/// Runs a host callable build over a fresh buffer, keeping the output of the last run.
+static double RunCPUKernel(CPUDispatcher& dispatcher, ComputeFunc func, int repeatCount, std::vector<float>& data)
+{
+    CorpusGlobals globals = {};
+    globals.Data.data = data.data();
+    globals.Data.count = data.size();
+    const uint3 groupCount(uint32_t((data.size() + c_threadsPerGroup - 1) / c_threadsPerGroup), 1, 1);
+
+    // Kernels update Data in place, so every run starts from the same input
+    double bestMs = 0.0;
+    for (int i = 0; i < repeatCount; i++)
+    {
+        InitialData(data);
+        Timer timer;
+        dispatcher.dispatch(func, groupCount, nullptr, &globals);
+        const double ms = timer.elapsedMs();
+        bestMs = (i == 0 || ms < bestMs) ? ms : bestMs;
+    }
+    return bestMs;
+}
+
+static bool MatchesReference(const std::vector<float>& data, const std::vector<float>& reference, size_t& outIndex)
+{
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        const float scale = fabsf(reference[i]) > 1.0f ? fabsf(reference[i]) : 1.0f;
+        if (!(fabsf(data[i] - reference[i]) <= c_tolerance * scale))
+        {
+            outIndex = i;
+            return false;
+        }
+    }
+    return true;
+}
+
+static MatrixResult CompileAndRun(SlangSession* session, const CorpusKernel& kernel, const MatrixTarget& target,
+    const NamedLevel& optimization, const NamedLevel& debugInfo, CPUDispatcher& dispatcher, int repeatCount, std::vector<float>& data)
+{
+    MatrixResult result;
+
+    SlangCompileRequest* request = spCreateCompileRequest(session);
+    spSetCodeGenTarget(request, target.target);
+    if (target.profile)
+        spSetTargetProfile(request, 0, spFindProfile(session, target.profile));
+    spSetOptimizationLevel(request, SlangOptimizationLevel(optimization.level));
+    spSetDebugInfoLevel(request, SlangDebugInfoLevel(debugInfo.level));
+
+    const int translationUnitIndex = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_SLANG, "");
+    const std::string path = std::string(kernel.name) + ".slang";
+    spAddTranslationUnitSourceString(request, translationUnitIndex, path.c_str(), kernel.source);
+    spAddEntryPoint(request, translationUnitIndex, c_entryPointName, SLANG_STAGE_COMPUTE);
+
+    // Code generation may be deferred until the output is asked for, so that is timed too
+    Timer timer;
+    ComPtr<ISlangBlob> code;
+    ComPtr<ISlangSharedLibrary> library;
+    SlangResult compileResult = spCompile(request);
+    if (SLANG_SUCCEEDED(compileResult))
+    {
+        if (target.target == SLANG_SHADER_HOST_CALLABLE)
+            compileResult = spGetEntryPointHostCallable(request, 0, 0, library.writeRef());
+        else
+            compileResult = spGetEntryPointCodeBlob(request, 0, 0, code.writeRef());
+    }
+    result.compileMs = timer.elapsedMs();
+    result.compiled = SLANG_SUCCEEDED(compileResult);
+    if (result.compiled && code)
+        result.codeSize = code->getBufferSize();
+    if (!result.compiled)
+    {
+        const char* diagnostics = spGetDiagnosticOutput(request);
+        result.unavailable = IsMissingCompilerDiagnostic(diagnostics);
+        result.firstDiagnostic = FirstLine(diagnostics);
+    }
+
+    if (library)
+    {
+        ComputeFunc func = (ComputeFunc)library->findFuncByName(c_entryPointName);
+        if (func)
+            result.runMs = RunCPUKernel(dispatcher, func, repeatCount, data);
+        else
+        {
+            result.compiled = false;
+            result.firstDiagnostic = std::string("no ") + c_entryPointName + " in the shared library";
+        }
+    }
+
+    spDestroyCompileRequest(request);
+    return result;
+}
+
+int RunOptMatrixBenchmark(int argc, char** argv)
+{
+    const int elementCount = argc > 1 ? atoi(argv[1]) : c_defaultElementCount;
+    const int repeatCount = argc > 2 ? atoi(argv[2]) : c_defaultRepeatCount;
+    if (elementCount < 1 || repeatCount < 1)
+    {
+        printf("Element and repeat counts must be at least 1.\n");
+        return 1;
+    }
+
+    FILE* table = nullptr;
+    fopen_s(&table, c_fileNameTable, "wb");
+    if (!table)
+    {
+        printf("Could not open %s for writing.\n", c_fileNameTable);
+        return 1;
+    }
+    fprintf(table, "kernel,target,optimization,debug_info,compiled,compile_ms,code_bytes,run_ms\n");
+
+    printf("Optimization and debug info matrix: %i kernels, cpu builds run over %i elements, best of %i runs\n\n",
+        int(sizeof(c_corpus) / sizeof(c_corpus[0])), elementCount, repeatCount);
+    printf("    %-12s %-6s %-9s %-9s %12s %12s %12s\n", "kernel", "target", "optimize", "debug", "compile ms", "code KB", "run ms");
+
+    SlangSession* session = spCreateSession(NULL);
+    CPUDispatcher dispatcher;
+    const size_t count = size_t(elementCount);
+    std::vector<float> data(count), reference;
+    int failures = 0;
+
+    for (const CorpusKernel& kernel : c_corpus)
+    {
+        reference.clear();
+        for (const MatrixTarget& target : c_targets)
+        {
+            const bool targetAvailable = SLANG_SUCCEEDED(spSessionCheckCompileTargetSupport(session, target.target));
+            for (const NamedLevel& optimization : c_optimizationLevels)
+            {
+                for (const NamedLevel& debugInfo : c_debugInfoLevels)
+                {
+                    MatrixResult result;
+                    if (targetAvailable)
+                        result = CompileAndRun(session, kernel, target, optimization, debugInfo, dispatcher, repeatCount, data);
+                    else
+                    {
+                        result.unavailable = true;
+                        result.firstDiagnostic = "target not supported by this slang build or its compilers";
+                    }
+
+                    printf("    %-12s %-6s %-9s %-9s ", kernel.name, target.name, optimization.name, debugInfo.name);
+                    if (result.unavailable)
+                        printf("%12s   %s\n", "unavailable", result.firstDiagnostic.c_str());
+                    else if (!result.compiled)
+                    {
+                        printf("%12s   %s\n", "FAILED", result.firstDiagnostic.c_str());
+                        failures++;
+                    }
+                    else
+                    {
+                        printf("%12.3f ", result.compileMs);
+                        if (result.codeSize)
+                            printf("%12.2f ", double(result.codeSize) / 1024.0);
+                        else
+                            printf("%12s ", "-");
+                        if (result.runMs >= 0.0)
+                            printf("%12.3f\n", result.runMs);
+                        else
+                            printf("%12s\n", result.firstDiagnostic.empty() ? "-" : result.firstDiagnostic.c_str());
+                    }
+                    fprintf(table, "%s,%s,%s,%s,%i,%.3f,%llu,%.3f\n", kernel.name, target.name, optimization.name, debugInfo.name,
+                        result.compiled ? 1 : 0, result.compileMs, (unsigned long long)result.codeSize, result.runMs);
+
+                    // The unoptimized, no debug info cpu build is the reference the others must agree with. It runs
+                    // first for each kernel; if it didn't compile that's already a failure, and there's nothing to compare.
+                    if (result.runMs < 0.0)
+                        continue;
+                    size_t index = 0;
+                    if (optimization.level == SLANG_OPTIMIZATION_LEVEL_NONE && debugInfo.level == SLANG_DEBUG_INFO_LEVEL_NONE)
+                        reference = data;
+                    else if (!reference.empty() && !MatchesReference(data, reference, index))
+                    {
+                        printf("    ERROR: %s %s/%s Data[%zu] is %f, expected %f\n", kernel.name, optimization.name, debugInfo.name,
+                            index, data[index], reference[index]);
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+
+    spDestroySession(session);
+    fclose(table);
+    printf("\n    %-40s %s\n", "table written to", c_fileNameTable);
+
+    return failures ? 1 : 0;
+}
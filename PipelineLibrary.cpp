@@ -0,0 +1,167 @@
+#include "PipelineLibrary.h"
+
+#include <stdio.h>
+#include <string.h>
+
+std::string PipelineKey::toString() const
+{
+    std::string line = moduleName + " " + entryPointName;
+    for (const std::string& arg : specializationArgs)
+        line += " " + arg;
+    return line;
+}
+
+bool PipelineKey::parse(const char* line)
+{
+    std::vector<std::string> words;
+    const char* separators = " \t\r\n";
+    while (*line)
+    {
+        line += strspn(line, separators);
+        const size_t length = strcspn(line, separators);
+        if (length)
+            words.push_back(std::string(line, length));
+        line += length;
+    }
+    if (words.size() < 2)
+        return false;
+
+    moduleName = words[0];
+    entryPointName = words[1];
+    specializationArgs.assign(words.begin() + 2, words.end());
+    return true;
+}
+
+void PipelineManifest::add(const PipelineKey& key)
+{
+    const std::string line = key.toString();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const PipelineKey& entry : m_entries)
+    {
+        if (entry.toString() == line)
+            return;
+    }
+    m_entries.push_back(key);
+}
+
+bool PipelineManifest::load(const char* fileName)
+{
+    FILE* file = nullptr;
+    fopen_s(&file, fileName, "rb");
+    if (!file)
+        return false;
+
+    char line[1024];
+    while (fgets(line, sizeof(line), file))
+    {
+        PipelineKey key;
+        if (line[0] != '#' && key.parse(line))
+            add(key);
+    }
+    fclose(file);
+    return true;
+}
+
+bool PipelineManifest::save(const char* fileName) const
+{
+    FILE* file = nullptr;
+    fopen_s(&file, fileName, "wb");
+    if (!file)
+        return false;
+
+    fprintf(file, "# module entryPoint [specializationType...]\n");
+    for (const PipelineKey& key : getEntries())
+        fprintf(file, "%s\n", key.toString().c_str());
+    fclose(file);
+    return true;
+}
+
+std::vector<PipelineKey> PipelineManifest::getEntries() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries;
+}
+
+PipelineLibrary::PipelineLibrary(gfx::IDevice* device)
+    : m_device(device)
+    , m_nextPrewarmKey(0)
+    , m_prewarmedCount(0)
+    , m_onDemandCount(0)
+{
+}
+
+PipelineLibrary::~PipelineLibrary()
+{
+    waitForPrewarm();
+}
+
+const GfxComputeKernel* PipelineLibrary::getKernel(const PipelineKey& key)
+{
+    return _getKernel(key, false);
+}
+
+const GfxComputeKernel* PipelineLibrary::_getKernel(const PipelineKey& key, bool isPrewarm)
+{
+    const std::string name = key.toString();
+    Entry* entry = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::unique_ptr<Entry>& slot = m_entries[name];
+        if (slot)
+        {
+            // Created, or being created by another thread
+            entry = slot.get();
+            m_readyCondition.wait(lock, [entry]() { return entry->ready; });
+            return entry->failed ? nullptr : &entry->kernel;
+        }
+        slot.reset(new Entry);
+        entry = slot.get();
+    }
+
+    std::vector<const char*> args;
+    for (const std::string& arg : key.specializationArgs)
+        args.push_back(arg.c_str());
+
+    SlangResult result;
+    {
+        std::lock_guard<std::mutex> createLock(m_createMutex);
+        result = LoadComputeKernel(m_device, key.moduleName.c_str(), key.entryPointName.c_str(), entry->kernel,
+            args.data(), int(args.size()));
+    }
+    if (SLANG_FAILED(result))
+        printf("Could not create pipeline \"%s\".\n", name.c_str());
+    else if (m_recording)
+        m_recording->add(key);
+    (isPrewarm ? m_prewarmedCount : m_onDemandCount)++;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        entry->failed = SLANG_FAILED(result);
+        entry->ready = true;
+    }
+    m_readyCondition.notify_all();
+    return entry->failed ? nullptr : &entry->kernel;
+}
+
+void PipelineLibrary::startPrewarm(const PipelineManifest& manifest, int threadCount)
+{
+    waitForPrewarm();
+
+    m_prewarmKeys = manifest.getEntries();
+    m_nextPrewarmKey = 0;
+    for (int i = 0; i < threadCount; i++)
+    {
+        m_prewarmThreads.emplace_back([this]()
+        {
+            for (size_t index = m_nextPrewarmKey++; index < m_prewarmKeys.size(); index = m_nextPrewarmKey++)
+                _getKernel(m_prewarmKeys[index], true);
+        });
+    }
+}
+
+void PipelineLibrary::waitForPrewarm()
+{
+    for (std::thread& thread : m_prewarmThreads)
+        thread.join();
+    m_prewarmThreads.clear();
+}
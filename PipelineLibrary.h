@@ -0,0 +1,96 @@
+#pragma once
+
+// Compute pipelines created on demand and shared by key, with a manifest to record what a run used and replay it at
+// startup, so program and pipeline creation happens before the first request instead of on it.
+//
+// Record: give the library a PipelineManifest with setRecording() and every pipeline created is added to it, then
+// save it. Prewarm: startPrewarm() creates every pipeline in a loaded manifest on background threads. A request for a
+// pipeline that's still being prewarmed waits for it rather than creating it a second time.
+//
+// The device's slang session is not thread safe, so pipeline creation itself is serialized; the pool takes the work
+// off the request path but doesn't run compiles in parallel.
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GfxCompute.h"
+
+/// One compute pipeline: module, entry point and the type names it's specialized with.
+struct PipelineKey
+{
+    std::string                 moduleName;
+    std::string                 entryPointName;
+    std::vector<std::string>    specializationArgs;
+
+    /// One line of a manifest: the module, entry point and specialization args separated by spaces.
+    std::string toString() const;
+    bool parse(const char* line);
+};
+
+class PipelineManifest
+{
+public:
+    /// Adds the key if it's not already there. Thread safe.
+    void add(const PipelineKey& key);
+
+    bool load(const char* fileName);
+    bool save(const char* fileName) const;
+
+    std::vector<PipelineKey> getEntries() const;
+
+protected:
+    mutable std::mutex          m_mutex;
+    std::vector<PipelineKey>    m_entries;
+};
+
+class PipelineLibrary
+{
+public:
+    explicit PipelineLibrary(gfx::IDevice* device);
+    ~PipelineLibrary();
+
+    /// Every pipeline created from now on is added to `manifest`. Pass nullptr to stop.
+    void setRecording(PipelineManifest* manifest) { m_recording = manifest; }
+
+    /// The kernel for `key`, created on the calling thread if nobody has created or started creating it yet.
+    /// Returns nullptr if it failed to create.
+    const GfxComputeKernel* getKernel(const PipelineKey& key);
+
+    /// Creates every pipeline in the manifest on `threadCount` background threads.
+    void startPrewarm(const PipelineManifest& manifest, int threadCount);
+    void waitForPrewarm();
+
+    /// Pipelines created, by prewarming and on demand.
+    int getPrewarmedCount() const { return m_prewarmedCount; }
+    int getOnDemandCount() const { return m_onDemandCount; }
+
+protected:
+    struct Entry
+    {
+        GfxComputeKernel    kernel;
+        bool                ready = false;
+        bool                failed = false;
+    };
+
+    const GfxComputeKernel* _getKernel(const PipelineKey& key, bool isPrewarm);
+
+    gfx::IDevice*                                   m_device;
+    PipelineManifest*                               m_recording = nullptr;
+
+    std::mutex                                      m_mutex;
+    std::condition_variable                         m_readyCondition;
+    std::map<std::string, std::unique_ptr<Entry>>   m_entries;
+    std::mutex                                      m_createMutex;      ///< Serializes use of the device's slang session
+
+    std::vector<std::thread>                        m_prewarmThreads;
+    std::vector<PipelineKey>                        m_prewarmKeys;
+    std::atomic<size_t>                             m_nextPrewarmKey;
+    std::atomic<int>                                m_prewarmedCount;
+    std::atomic<int>                                m_onDemandCount;
+};
@@ -0,0 +1,129 @@
+// Record and prewarm run modes for PipelineLibrary (PipelineLibrary.h), on the CPU device.
+//
+// piperecord serves the workload's requests once with recording on and saves the manifest. pipeprewarm compares the
+// latency of the first and a later request for each pipeline, creating pipelines lazily on the request path against
+// prewarming them from the manifest at startup.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Bench.h"
+#include "PipelineLibrary.h"
+#include "RunModes.h"
+
+using namespace gfx;
+using Slang::ComPtr;
+
+static const char*  c_defaultManifestFileName   = "out_pipelines.manifest";
+static const char*  c_dataParameterName         = "Data";
+static const int    c_elementCount              = 1024;
+static const int    c_defaultPrewarmThreads     = 2;
+
+// The pipelines the tool's requests use
+static const PipelineKey c_workload[] =
+{
+    { "test", "csmain", {} },
+};
+
+struct RequestTarget
+{
+    GfxComputeContext           context;
+    ComPtr<IBufferResource>     buffer;
+    ComPtr<IResourceView>       view;
+};
+
+static bool CreateRequestTarget(RequestTarget& outTarget)
+{
+    return SLANG_SUCCEEDED(CreateGfxComputeContext(DeviceType::CPU, outTarget.context)) &&
+        SLANG_SUCCEEDED(CreateFloatBuffer(outTarget.context.device, c_elementCount, nullptr, outTarget.buffer.writeRef(), outTarget.view.writeRef()));
+}
+
+// One request: get the pipeline and dispatch it
+static bool ServeRequest(PipelineLibrary& library, RequestTarget& target, const PipelineKey& key)
+{
+    const GfxComputeKernel* kernel = library.getKernel(key);
+    return kernel && SLANG_SUCCEEDED(DispatchAndWait(target.context, *kernel, c_dataParameterName, target.view, c_elementCount));
+}
+
+int RunPipelineRecord(int argc, char** argv)
+{
+    const char* manifestFileName = argc > 1 ? argv[1] : c_defaultManifestFileName;
+
+    RequestTarget target;
+    if (!CreateRequestTarget(target))
+    {
+        printf("Could not create the CPU device.\n");
+        return 1;
+    }
+
+    PipelineManifest manifest;
+    PipelineLibrary library(target.context.device);
+    library.setRecording(&manifest);
+    for (const PipelineKey& key : c_workload)
+    {
+        if (!ServeRequest(library, target, key))
+            return 1;
+    }
+
+    if (!manifest.save(manifestFileName))
+    {
+        printf("Could not open %s for writing.\n", manifestFileName);
+        return 1;
+    }
+    printf("Recorded %i pipelines to %s\n", int(manifest.getEntries().size()), manifestFileName);
+    return 0;
+}
+
+int RunPipelinePrewarm(int argc, char** argv)
+{
+    const char* manifestFileName = argc > 1 ? argv[1] : c_defaultManifestFileName;
+    const int threadCount = argc > 2 ? atoi(argv[2]) : c_defaultPrewarmThreads;
+
+    PipelineManifest manifest;
+    if (!manifest.load(manifestFileName))
+    {
+        printf("Could not read %s. Run piperecord first.\n", manifestFileName);
+        return 1;
+    }
+    printf("Pipeline prewarming: %i pipelines from %s on %i threads\n\n", int(manifest.getEntries().size()), manifestFileName, threadCount);
+    printf("    %-32s %14s %14s %14s\n", "request", "startup ms", "first ms", "steady ms");
+
+    // Each scenario gets its own device, so nothing carries over from the one before
+    for (int prewarm = 0; prewarm < 2; prewarm++)
+    {
+        RequestTarget target;
+        if (!CreateRequestTarget(target))
+        {
+            printf("Could not create the CPU device.\n");
+            return 1;
+        }
+
+        PipelineLibrary library(target.context.device);
+        Timer timer;
+        if (prewarm)
+        {
+            library.startPrewarm(manifest, threadCount);
+            library.waitForPrewarm();
+        }
+        const double startupMs = timer.elapsedMs();
+
+        for (const PipelineKey& key : c_workload)
+        {
+            timer.reset();
+            if (!ServeRequest(library, target, key))
+                return 1;
+            const double firstMs = timer.elapsedMs();
+
+            timer.reset();
+            ServeRequest(library, target, key);
+            const double steadyMs = timer.elapsedMs();
+
+            const std::string label = std::string(prewarm ? "prewarmed " : "lazy ") + key.toString();
+            printf("    %-32s %14.3f %14.3f %14.3f\n", label.c_str(), startupMs, firstMs, steadyMs);
+        }
+        printf("    %-32s prewarmed %i, created on request %i\n", "", library.getPrewarmedCount(), library.getOnDemandCount());
+    }
+
+    return 0;
+}
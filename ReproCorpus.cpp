@@ -0,0 +1,122 @@
+#include "ReproCorpus.h"
+
+#include <filesystem>
+#include <map>
+#include <stdio.h>
+
+#include "Bench.h"
+
+#include "slang/slang-com-ptr.h"
+
+namespace fs = std::filesystem;
+
+/// Labels become file names, so anything but letters, digits, '-' and '_' is replaced
+static std::string LabelToFileName(const std::string& label)
+{
+    std::string name = label;
+    for (char& c : name)
+    {
+        const bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+        if (!keep)
+            c = '_';
+    }
+    return name + ".slang-repro";
+}
+
+void SlowCompileRecorder::prepare(SlangCompileRequest* request)
+{
+    spEnableReproCapture(request);
+}
+
+bool SlowCompileRecorder::recordIfSlow(SlangCompileRequest* request, const std::string& label, double compileMs)
+{
+    if (compileMs <= m_thresholdMs)
+        return false;
+
+    Slang::ComPtr<ISlangBlob> repro;
+    if (SLANG_FAILED(spSaveRepro(request, repro.writeRef())) || !repro)
+        return false;
+
+    const std::string fileName = LabelToFileName(label);
+    const std::string path = (fs::path(m_directory) / fileName).string();
+    const std::string indexPath = (fs::path(m_directory) / c_reproIndexFileName).string();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::error_code error;
+    fs::create_directories(m_directory, error);
+
+    FILE* file = nullptr;
+    fopen_s(&file, path.c_str(), "wb");
+    if (!file)
+        return false;
+    const bool written = fwrite(repro->getBufferPointer(), 1, repro->getBufferSize(), file) == repro->getBufferSize();
+    fclose(file);
+    if (!written)
+        return false;
+
+    // The index is only ever appended to, so a header goes in when it's created
+    const bool newIndex = !fs::exists(indexPath, error);
+    fopen_s(&file, indexPath.c_str(), "ab");
+    if (!file)
+        return false;
+    if (newIndex)
+        fprintf(file, "# fileName compileMs label\n");
+    fprintf(file, "%s %.3f %s\n", fileName.c_str(), compileMs, label.c_str());
+    fclose(file);
+
+    m_recordedCount++;
+    return true;
+}
+
+bool LoadReproCorpus(const char* directory, std::vector<ReproEntry>& outEntries)
+{
+    outEntries.clear();
+    const std::string indexPath = (fs::path(directory) / c_reproIndexFileName).string();
+    FILE* file = nullptr;
+    fopen_s(&file, indexPath.c_str(), "rb");
+    if (!file)
+        return false;
+
+    // Later captures of a file replace earlier ones, keeping the order files first appeared in
+    std::map<std::string, size_t> indexByFile;
+    char line[1024];
+    while (fgets(line, sizeof(line), file))
+    {
+        if (line[0] == '#')
+            continue;
+
+        char fileName[512], label[512];
+        ReproEntry entry;
+        if (sscanf(line, "%511s %lf %511[^\r\n]", fileName, &entry.compileMs, label) != 3)
+            continue;
+        entry.fileName = fileName;
+        entry.label = label;
+
+        auto it = indexByFile.find(entry.fileName);
+        if (it == indexByFile.end())
+        {
+            indexByFile[entry.fileName] = outEntries.size();
+            outEntries.push_back(entry);
+        }
+        else
+            outEntries[it->second] = entry;
+    }
+    fclose(file);
+    return true;
+}
+
+SlangResult ReplayRepro(SlangSession* session, const std::vector<char>& reproData, double& outMs, std::string& outDiagnostics)
+{
+    SlangCompileRequest* request = spCreateCompileRequest(session);
+
+    Timer timer;
+    SlangResult result = spLoadRepro(request, nullptr, reproData.data(), reproData.size());
+    if (SLANG_SUCCEEDED(result))
+        result = spCompile(request);
+    outMs = timer.elapsedMs();
+
+    const char* diagnostics = spGetDiagnosticOutput(request);
+    outDiagnostics = diagnostics ? diagnostics : "";
+    spDestroyCompileRequest(request);
+    return result;
+}
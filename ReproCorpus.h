@@ -0,0 +1,60 @@
+#pragma once
+
+// A corpus of slow compiles, kept as slang repro files so each can be compiled again in isolation.
+//
+// SlowCompileRecorder enables repro capture on requests before they compile (spEnableReproCapture), and after the
+// compile saves a repro (spSaveRepro) of any that took longer than a threshold into the corpus directory. A repro
+// holds the request's options and every source file it read, so it compiles the same without the original tree.
+// Capture has a cost of its own, since source is kept with each request, so it is opt in.
+//
+// The directory has one <label>.slang-repro per compile and index.txt, one line per capture:
+//   fileName compileMs label
+// with the label taking the rest of the line. A label captured again replaces its repro, and the later line wins.
+//
+// ReplayRepro loads a repro into a fresh request with spLoadRepro and compiles it.
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "slang/slang.h"
+
+static const char* const c_defaultReproDirectory = "out_repros";
+static const char* const c_reproIndexFileName = "index.txt";
+
+struct ReproEntry
+{
+    std::string     fileName;       ///< In the corpus directory
+    std::string     label;
+    double          compileMs = 0.0;    ///< When it was captured
+};
+
+class SlowCompileRecorder
+{
+public:
+    SlowCompileRecorder(const char* directory, double thresholdMs)
+        : m_directory(directory)
+        , m_thresholdMs(thresholdMs)
+    {}
+
+    /// Enables repro capture. Call before spCompile.
+    void prepare(SlangCompileRequest* request);
+
+    /// Saves a repro of the request if the compile took longer than the threshold. Thread safe. True if one was saved.
+    bool recordIfSlow(SlangCompileRequest* request, const std::string& label, double compileMs);
+
+    int getRecordedCount() const { return m_recordedCount; }
+    double getThresholdMs() const { return m_thresholdMs; }
+
+protected:
+    std::string     m_directory;
+    double          m_thresholdMs;
+    std::mutex      m_mutex;
+    int             m_recordedCount = 0;
+};
+
+/// The repros listed in a corpus directory's index, last capture per file. False if there's no index.
+bool LoadReproCorpus(const char* directory, std::vector<ReproEntry>& outEntries);
+
+/// Compiles a repro in a new request from session. outMs is the spLoadRepro and spCompile time.
+SlangResult ReplayRepro(SlangSession* session, const std::vector<char>& reproData, double& outMs, std::string& outDiagnostics);
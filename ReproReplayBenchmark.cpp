@@ -0,0 +1,92 @@
+// Replays the slow compile corpus (ReproCorpus.h) that checksweep, or the default compile of test.slang, saves with a
+// repro threshold: every repro in the index is loaded with spLoadRepro and compiled again and again, and reported as a
+// mean with a 95% confidence interval next to the time it took when captured. A compile that has become much slower
+// than when captured is a regression; one that no longer compiles fails the run.
+
+#include <filesystem>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "ReproCorpus.h"
+#include "RunModes.h"
+
+static const int    c_defaultRepeatCount    = 10;
+static const int    c_warmupCount           = 1;
+
+static bool ReadBinaryFile(const std::string& fileName, std::vector<char>& outData)
+{
+    FILE* file = nullptr;
+    fopen_s(&file, fileName.c_str(), "rb");
+    if (!file)
+        return false;
+    fseek(file, 0, SEEK_END);
+    outData.resize(size_t(ftell(file)));
+    fseek(file, 0, SEEK_SET);
+    const size_t readSize = outData.empty() ? 0 : fread(outData.data(), 1, outData.size(), file);
+    fclose(file);
+    return readSize == outData.size();
+}
+
+int RunReproReplayBenchmark(int argc, char** argv)
+{
+    const char* directory = argc > 1 ? argv[1] : c_defaultReproDirectory;
+    const int repeatCount = argc > 2 ? atoi(argv[2]) : c_defaultRepeatCount;
+    if (repeatCount < 2)
+    {
+        printf("Repeat count must be at least 2.\n");
+        return 1;
+    }
+
+    std::vector<ReproEntry> entries;
+    if (!LoadReproCorpus(directory, entries))
+    {
+        printf("No repro corpus in %s. Run checksweep with a repro threshold to capture one.\n", directory);
+        return 1;
+    }
+
+    printf("Repro replay: %i repros from %s, %i warmup and %i timed compiles each\n\n", int(entries.size()), directory, c_warmupCount, repeatCount);
+    printf("    %-32s %12s %12s %12s %12s %10s\n", "label", "captured ms", "mean ms", "+- 95% ms", "min ms", "vs capture");
+
+    SlangSession* session = spCreateSession(NULL);
+    int failures = 0;
+    int failingRepros = 0;
+    for (const ReproEntry& entry : entries)
+    {
+        std::vector<char> data;
+        if (!ReadBinaryFile((std::filesystem::path(directory) / entry.fileName).string(), data))
+        {
+            printf("    ERROR: could not read %s\n", entry.fileName.c_str());
+            failures++;
+            continue;
+        }
+
+        bool compiled = true;
+        std::string diagnostics;
+        std::vector<double> samples;
+        for (int i = 0; i < c_warmupCount + repeatCount; i++)
+        {
+            double ms = 0.0;
+            compiled &= SLANG_SUCCEEDED(ReplayRepro(session, data, ms, diagnostics));
+            if (i >= c_warmupCount)
+                samples.push_back(ms);
+        }
+
+        const SampleStats stats = ComputeSampleStats(samples);
+        printf("    %-32s %12.3f %12.3f %12.3f %12.3f %9.2fx%s\n", entry.label.c_str(), entry.compileMs, stats.mean, stats.ci95,
+            stats.min, entry.compileMs > 0.0 ? stats.mean / entry.compileMs : 0.0, compiled ? "" : "  fails");
+        if (!compiled)
+        {
+            printf("    ERROR: %s no longer compiles:\n%s", entry.label.c_str(), diagnostics.c_str());
+            failingRepros++;
+            failures++;
+        }
+    }
+    spDestroySession(session);
+
+    if (failingRepros)
+        printf("\n    %-40s %i\n", "repros that don't compile", failingRepros);
+    return failures ? 1 : 0;
+}
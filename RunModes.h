@@ -0,0 +1,30 @@
+#pragma once
+
+// Entry points for the optional run modes, selected by the first command line argument (see c_runModes in main.cpp).
+// Each gets the remaining arguments, with argv[0] being the mode name, and returns the process exit code.
+
+int RunTextureBenchmark(int argc, char** argv);
+int RunArenaBenchmark(int argc, char** argv);
+int RunWaveBenchmark(int argc, char** argv);
+int RunGroupSharedBenchmark(int argc, char** argv);
+int RunCPUDeviceHarness(int argc, char** argv);
+int RunShaderCacheBenchmark(int argc, char** argv);
+int RunDispatchOverheadBenchmark(int argc, char** argv);
+int RunPipelineRecord(int argc, char** argv);
+int RunPipelinePrewarm(int argc, char** argv);
+int RunLayoutBenchmark(int argc, char** argv);
+int RunAsyncCompileBenchmark(int argc, char** argv);
+int RunKernelCounterBenchmark(int argc, char** argv);
+int RunTensorBenchmark(int argc, char** argv);
+int RunTensorRankBenchmark(int argc, char** argv);
+int RunAutotune(int argc, char** argv);
+int RunModuleContainerBenchmark(int argc, char** argv);
+int RunWholeProgramBenchmark(int argc, char** argv);
+int RunOptMatrixBenchmark(int argc, char** argv);
+int RunDiagnosticBatchBenchmark(int argc, char** argv);
+int RunCheckSweepBenchmark(int argc, char** argv);
+int RunReproReplayBenchmark(int argc, char** argv);
+int RunKernelCacheBenchmark(int argc, char** argv);
+int RunHotReloadBenchmark(int argc, char** argv);
+int RunMemoryFootprintBenchmark(int argc, char** argv);
+int RunSessionPoolBenchmark(int argc, char** argv);
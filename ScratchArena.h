@@ -0,0 +1,194 @@
+#pragma once
+
+// Per worker thread scratch memory for CPU target kernels.
+//
+// Kernels that need dynamically sized locals, or fill a prelude Array<T>, would otherwise hit the global heap
+// once per invocation, and with many worker threads the allocator becomes the bottleneck. Instead each
+// CPUDispatcher worker owns a ScratchArena. Allocation is a pointer bump, nothing is freed individually, and the
+// dispatcher resets the arena after every group, so memory is reused group after group without touching the heap.
+//
+// Kernel code allocates with ScratchAlloc/ScratchArray and hands memory back with ScratchRelease, which only
+// does work when no arena is bound to the thread (the plain heap path the arena is measured against).
+// Slang's C++ target doesn't emit these calls, so a kernel only uses the arena if it's written (or patched) to
+// call them, as ArenaBenchmark's hand written kernel is.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+
+#ifdef _WIN32
+#   include <malloc.h>
+#endif
+
+#include "CPUPrelude.h"
+
+/// Heap memory aligned to `alignment` (a power of two), released with ScratchHeapFree.
+SLANG_FORCE_INLINE void* ScratchHeapAlloc(size_t size, size_t alignment)
+{
+    if (alignment < sizeof(void*))
+        alignment = sizeof(void*);
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants a size that's a multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+}
+
+SLANG_FORCE_INLINE void ScratchHeapFree(void* data)
+{
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    free(data);
+#endif
+}
+
+class ScratchArena
+{
+public:
+    static const size_t kDefaultBlockSize = 64 * 1024;
+    static const size_t kBlockAlignment = 64;
+
+    explicit ScratchArena(size_t blockSize = kDefaultBlockSize)
+        : m_blockSize(blockSize)
+    {}
+
+    ~ScratchArena()
+    {
+        for (Block& block : m_blocks)
+            ScratchHeapFree(block.data);
+    }
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment)
+    {
+        // Fast path: bump within the current block
+        if (m_current < m_blocks.size())
+        {
+            Block& block = m_blocks[m_current];
+            const size_t offset = _alignedOffset(block, m_offset, alignment);
+            if (offset + size <= block.size)
+            {
+                m_offset = offset + size;
+                return block.data + offset;
+            }
+        }
+        return _allocateSlow(size, alignment);
+    }
+
+    /// Makes all memory available again. Blocks are kept for the next group.
+    void reset()
+    {
+        size_t used = getUsedBytes();
+        if (used > m_highWaterBytes)
+            m_highWaterBytes = used;
+        m_current = 0;
+        m_offset = 0;
+    }
+
+    size_t getUsedBytes() const
+    {
+        size_t used = m_offset;
+        for (size_t i = 0; i < m_current && i < m_blocks.size(); i++)
+            used += m_blocks[i].size;
+        return used;
+    }
+    size_t getHighWaterBytes() const { return m_highWaterBytes; }
+    size_t getReservedBytes() const
+    {
+        size_t reserved = 0;
+        for (const Block& block : m_blocks)
+            reserved += block.size;
+        return reserved;
+    }
+
+    /// The arena bound to the calling thread, or nullptr.
+    static ScratchArena*& current()
+    {
+        static thread_local ScratchArena* s_current = nullptr;
+        return s_current;
+    }
+
+protected:
+    struct Block
+    {
+        char*   data;
+        size_t  size;
+    };
+
+    /// The first offset at or after `offset` whose address in the block is aligned to `alignment`
+    static size_t _alignedOffset(const Block& block, size_t offset, size_t alignment)
+    {
+        const uintptr_t address = uintptr_t(block.data) + offset;
+        return offset + (((address + alignment - 1) & ~uintptr_t(alignment - 1)) - address);
+    }
+
+    void* _allocateSlow(size_t size, size_t alignment)
+    {
+        // Move on to the next block that fits, allocating one if needed. New blocks are aligned to the allocation
+        // that made them, so it starts at offset 0.
+        size_t offset = 0;
+        for (m_current = (m_current < m_blocks.size() ? m_current + 1 : 0); m_current < m_blocks.size(); m_current++)
+        {
+            offset = _alignedOffset(m_blocks[m_current], 0, alignment);
+            if (offset + size <= m_blocks[m_current].size)
+                break;
+        }
+        if (m_current == m_blocks.size())
+        {
+            Block block;
+            block.size = size > m_blockSize ? size : m_blockSize;
+            size_t blockAlignment = kBlockAlignment;
+            if (alignment > blockAlignment)
+                blockAlignment = alignment;
+            block.data = (char*)ScratchHeapAlloc(block.size, blockAlignment);
+            m_blocks.push_back(block);
+            offset = 0;
+        }
+        m_offset = offset + size;
+        return m_blocks[m_current].data + offset;
+    }
+
+
+    size_t              m_blockSize;
+    std::vector<Block>  m_blocks;
+    size_t              m_current = 0;      ///< Index of the block being bumped
+    size_t              m_offset = 0;       ///< Bytes used in the current block
+    size_t              m_highWaterBytes = 0;
+};
+
+/// Allocates per invocation scratch memory from the thread's arena, or the heap when there isn't one.
+SLANG_FORCE_INLINE void* ScratchAlloc(size_t size, size_t alignment = 16)
+{
+    if (ScratchArena* arena = ScratchArena::current())
+        return arena->allocate(size, alignment);
+    return ScratchHeapAlloc(size, alignment);
+}
+
+/// Hands back memory from ScratchAlloc. Arena memory is reclaimed when the group ends, so this is a no-op then.
+SLANG_FORCE_INLINE void ScratchRelease(void* data)
+{
+    if (!ScratchArena::current())
+        ScratchHeapFree(data);
+}
+
+/// A prelude Array<T> backed by scratch memory. The elements are not constructed, as in emitted C++.
+template <typename T>
+SLANG_FORCE_INLINE Array<T> ScratchArray(size_t count)
+{
+    Array<T> array;
+    array.data = (T*)ScratchAlloc(sizeof(T) * count, alignof(T) > 16 ? alignof(T) : 16);
+    array.count = count;
+    return array;
+}
+
+template <typename T>
+SLANG_FORCE_INLINE void ScratchRelease(Array<T>& array)
+{
+    ScratchRelease(array.data);
+    array.data = nullptr;
+    array.count = 0;
+}
@@ -0,0 +1,243 @@
+#include "SessionPool.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "SlangHelpers.h"
+#include "StringBlob.h"
+
+using Slang::ComPtr;
+
+struct PooledSession
+{
+    SessionPoolSlot*                        slot = nullptr;
+    std::string                             key;
+    ComPtr<slang::ISession>                 session;
+    int                                     useCount = 0;
+    std::map<std::string, slang::IModule*>  modules;        ///< By name and source hash
+    int                                     nextModuleId = 0;
+};
+
+struct SessionPoolSlot
+{
+    ComPtr<slang::IGlobalSession>                               globalSession;
+    std::map<std::string, std::unique_ptr<PooledSession>>       sessions;       ///< By key
+    bool                                                        leased = false;
+    std::thread::id                                             lastThread;
+};
+
+static std::string MakeSessionKey(const SessionPoolDesc& desc)
+{
+    std::string key = "targets";
+    for (const SessionPoolTarget& target : desc.targets)
+        key += " " + std::to_string(int(target.format)) + ":" + target.profile;
+    key += "\nsearch paths";
+    for (const std::string& searchPath : desc.searchPaths)
+        key += " " + searchPath;
+    key += "\nmacros";
+    for (const auto& macro : desc.macros)
+        key += " " + macro.first + "=" + macro.second;
+    return key;
+}
+
+SessionLease& SessionLease::operator=(SessionLease&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        m_pool = other.m_pool;
+        m_session = other.m_session;
+        other.m_pool = nullptr;
+        other.m_session = nullptr;
+    }
+    return *this;
+}
+
+slang::ISession* SessionLease::getSession() const
+{
+    return m_session ? m_session->session.get() : nullptr;
+}
+
+slang::IGlobalSession* SessionLease::getGlobalSession() const
+{
+    return m_session ? m_session->slot->globalSession.get() : nullptr;
+}
+
+slang::IModule* SessionLease::loadModule(const char* moduleName, const std::string& source, std::string& outDiagnostics)
+{
+    if (!m_session)
+        return nullptr;
+
+    const std::string moduleKey = std::string(moduleName) + " " + HashSource(source);
+    auto found = m_session->modules.find(moduleKey);
+    if (found != m_session->modules.end())
+    {
+        m_pool->_addModuleStats(true);
+        return found->second;
+    }
+
+    // The session already has a module of this name if the source changed, so it's loaded under a new one
+    const std::string namePrefix = std::string(moduleName) + " ";
+    bool nameTaken = false;
+    for (const auto& module : m_session->modules)
+        nameTaken |= module.first.compare(0, namePrefix.size(), namePrefix) == 0;
+    const std::string loadName = nameTaken ? std::string(moduleName) + "_" + std::to_string(++m_session->nextModuleId) : moduleName;
+
+    const std::string path = std::string(moduleName) + ".slang";
+    // The module stays in the pooled session past this lease, and slang keeps its source blob as long, so it owns a copy
+    ComPtr<ISlangBlob> sourceBlob = StringBlob::createCopy(source.c_str());
+    ComPtr<ISlangBlob> diagnostics;
+    slang::IModule* module = m_session->session->loadModuleFromSource(loadName.c_str(), path.c_str(), sourceBlob, diagnostics.writeRef());
+    AppendDiagnostics(outDiagnostics, diagnostics);
+    if (module)
+    {
+        m_session->modules[moduleKey] = module;
+        m_pool->_addModuleStats(false);
+    }
+    return module;
+}
+
+void SessionLease::release()
+{
+    if (m_pool)
+        m_pool->_release(m_session);
+    m_pool = nullptr;
+    m_session = nullptr;
+}
+
+SessionPool::SessionPool(int maxUses)
+    : m_maxUses(maxUses)
+{
+}
+
+SessionPool::~SessionPool()
+{
+    // Sessions go before the global session they came from
+    for (std::unique_ptr<SessionPoolSlot>& slot : m_slots)
+        slot->sessions.clear();
+}
+
+SessionPoolStats SessionPool::getStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void SessionPool::_addModuleStats(bool reused)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (reused)
+        m_stats.moduleReuses++;
+    else
+        m_stats.moduleLoads++;
+}
+
+SessionLease SessionPool::acquire(const SessionPoolDesc& desc)
+{
+    const std::string key = MakeSessionKey(desc);
+    const std::thread::id thread = std::this_thread::get_id();
+
+    SessionLease lease;
+    lease.m_pool = this;
+    SessionPoolSlot* slot = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.acquires++;
+
+        // The thread's own slot, then any idle slot with the session, then any idle slot at all
+        SessionPoolSlot* idleSlot = nullptr;
+        for (std::unique_ptr<SessionPoolSlot>& candidate : m_slots)
+        {
+            if (candidate->leased)
+                continue;
+            const bool hasSession = candidate->sessions.count(key) != 0;
+            const bool ownSlot = candidate->lastThread == thread;
+            if (hasSession && ownSlot)
+            {
+                slot = candidate.get();
+                break;
+            }
+            if (hasSession && !slot)
+                slot = candidate.get();
+            if (!idleSlot || (ownSlot && idleSlot->lastThread != thread))
+                idleSlot = candidate.get();
+        }
+
+        if (slot)
+        {
+            lease.m_session = slot->sessions[key].get();
+            m_stats.poolHits++;
+            m_stats.affinityHits += slot->lastThread == thread ? 1 : 0;
+        }
+        else if (idleSlot)
+            slot = idleSlot;
+        else
+        {
+            m_slots.emplace_back(new SessionPoolSlot);
+            slot = m_slots.back().get();
+            m_stats.slotsCreated++;
+        }
+        slot->leased = true;
+        slot->lastThread = thread;
+    }
+
+    // The slot is leased to this thread now, so its sessions can be created without the lock
+    if (!lease.m_session && SLANG_FAILED(_createSession(*slot, desc, key, lease.m_session)))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        slot->leased = false;
+        lease.m_pool = nullptr;
+    }
+    return lease;
+}
+
+SlangResult SessionPool::_createSession(SessionPoolSlot& slot, const SessionPoolDesc& desc, const std::string& key, PooledSession*& outSession)
+{
+    if (!slot.globalSession)
+        SLANG_RETURN_ON_FAIL(slang_createGlobalSession(SLANG_API_VERSION, slot.globalSession.writeRef()));
+
+    std::vector<slang::TargetDesc> targets(desc.targets.size());
+    for (size_t i = 0; i < desc.targets.size(); i++)
+    {
+        targets[i].format = desc.targets[i].format;
+        targets[i].profile = slot.globalSession->findProfile(desc.targets[i].profile.c_str());
+    }
+    std::vector<const char*> searchPaths;
+    for (const std::string& searchPath : desc.searchPaths)
+        searchPaths.push_back(searchPath.c_str());
+    std::vector<slang::PreprocessorMacroDesc> macros;
+    for (const auto& macro : desc.macros)
+        macros.push_back({ macro.first.c_str(), macro.second.c_str() });
+
+    slang::SessionDesc sessionDesc;
+    sessionDesc.targets = targets.data();
+    sessionDesc.targetCount = SlangInt(targets.size());
+    sessionDesc.searchPaths = searchPaths.data();
+    sessionDesc.searchPathCount = SlangInt(searchPaths.size());
+    sessionDesc.preprocessorMacros = macros.data();
+    sessionDesc.preprocessorMacroCount = SlangInt(macros.size());
+
+    std::unique_ptr<PooledSession> session(new PooledSession);
+    session->slot = &slot;
+    session->key = key;
+    SLANG_RETURN_ON_FAIL(slot.globalSession->createSession(sessionDesc, session->session.writeRef()));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.sessionsCreated++;
+    outSession = session.get();
+    slot.sessions[key] = std::move(session);
+    return SLANG_OK;
+}
+
+void SessionPool::_release(PooledSession* session)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SessionPoolSlot* slot = session->slot;
+    session->useCount++;
+    if (m_maxUses > 0 && session->useCount >= m_maxUses)
+    {
+        slot->sessions.erase(session->key);
+        m_stats.sessionsRecycled++;
+    }
+    slot->leased = false;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+// A pool of slang sessions for compile services, so requests reuse sessions, and the modules already loaded into them,
+// instead of creating a session per request.
+//
+// Sessions are pooled by what they were created with: targets (format and profile), search paths and preprocessor
+// macros, as in slang::SessionDesc. acquire() hands out a SessionLease, which has the session to itself until it's
+// released.
+//
+// Slang's global session isn't thread safe, and neither is anything created from it, so the pool keeps its sessions in
+// slots, each with its own global session, and leases out at most one session of a slot at a time. A slot remembers
+// the thread that used it last, and acquire() looks in that thread's slot first: a worker keeps getting the sessions
+// whose modules it loaded. Failing that it takes a matching session from any idle slot, then creates one in an idle
+// slot, and only creates a new slot (and global session) when every slot is leased. So there end up about as many
+// slots as threads compiling at once.
+//
+// A session's module cache only grows, so a session leased maxUses times is recycled: destroyed when it's released,
+// and created afresh the next time it's needed.
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "slang/slang.h"
+#include "slang/slang-com-ptr.h"
+
+struct SessionPoolTarget
+{
+    SlangCompileTarget                                  format = SLANG_HLSL;
+    std::string                                         profile = "cs_5_1";
+};
+
+struct SessionPoolDesc
+{
+    std::vector<SessionPoolTarget>                      targets;
+    std::vector<std::string>                            searchPaths;
+    std::vector<std::pair<std::string, std::string>>    macros;
+};
+
+struct SessionPoolStats
+{
+    uint64_t    acquires = 0;
+    uint64_t    poolHits = 0;           ///< Acquires that got an existing session
+    uint64_t    affinityHits = 0;       ///< Of those, ones from the acquiring thread's own slot
+    uint64_t    sessionsCreated = 0;
+    uint64_t    sessionsRecycled = 0;
+    uint64_t    slotsCreated = 0;       ///< Each is a global session
+    uint64_t    moduleLoads = 0;        ///< loadModule calls that compiled the module
+    uint64_t    moduleReuses = 0;       ///< loadModule calls served by a module the session already had
+
+    double getHitRate() const { return acquires ? double(poolHits) / double(acquires) : 0.0; }
+    double getModuleReuseRate() const { return moduleLoads + moduleReuses ? double(moduleReuses) / double(moduleLoads + moduleReuses) : 0.0; }
+};
+
+class SessionPool;
+struct PooledSession;
+struct SessionPoolSlot;
+
+class SessionLease
+{
+public:
+    SessionLease() = default;
+    SessionLease(SessionLease&& other) noexcept { *this = std::move(other); }
+    SessionLease& operator=(SessionLease&& other) noexcept;
+    ~SessionLease() { release(); }
+
+    SessionLease(const SessionLease&) = delete;
+    SessionLease& operator=(const SessionLease&) = delete;
+
+    /// Null if the lease is empty or the session couldn't be created
+    slang::ISession* getSession() const;
+    slang::IGlobalSession* getGlobalSession() const;
+
+    /// Loads a module from source, or returns the one this session already loaded from the same name and source.
+    /// Modules live as long as the session, so don't keep them past the lease.
+    slang::IModule* loadModule(const char* moduleName, const std::string& source, std::string& outDiagnostics);
+
+    /// Hands the session back to the pool. The lease is empty afterwards.
+    void release();
+
+protected:
+    friend class SessionPool;
+
+    SessionPool*            m_pool = nullptr;
+    PooledSession*          m_session = nullptr;
+};
+
+class SessionPool
+{
+public:
+    /// Sessions are recycled after maxUses leases; 0 never recycles them.
+    explicit SessionPool(int maxUses = 0);
+    ~SessionPool();
+
+    SessionPool(const SessionPool&) = delete;
+    SessionPool& operator=(const SessionPool&) = delete;
+
+    /// A session created with desc, for the calling thread's use until the lease is released. Never waits for another
+    /// lease; if every matching session is leased, one is created.
+    SessionLease acquire(const SessionPoolDesc& desc);
+
+    SessionPoolStats getStats();
+    int getMaxUses() const { return m_maxUses; }
+
+protected:
+    friend class SessionLease;
+
+    void _release(PooledSession* session);
+    SlangResult _createSession(SessionPoolSlot& slot, const SessionPoolDesc& desc, const std::string& key, PooledSession*& outSession);
+    void _addModuleStats(bool reused);
+
+    int                                             m_maxUses;
+    std::mutex                                      m_mutex;
+    std::vector<std::unique_ptr<SessionPoolSlot>>   m_slots;
+    SessionPoolStats                                m_stats;
+};
@@ -0,0 +1,221 @@
+// Serves a stream of compile requests on worker threads the way a compile service would, three ways: a new session
+// per request, sessions leased from a SessionPool (SessionPool.h), and a pool that recycles sessions after a number of
+// leases. Requests mix a few session configurations (target and defines) and a few modules, so pooled sessions, and
+// the modules already loaded into them, are reused.
+//
+// Prints throughput, the pool's hit rate, how many hits came from the worker's own slot, and how many module loads
+// were served by a module the session already had.
+
+#include <atomic>
+#include <functional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bench.h"
+#include "RunModes.h"
+#include "SessionPool.h"
+#include "StringBlob.h"
+
+using Slang::ComPtr;
+
+static const int    c_defaultRequestCount   = 512;
+static const int    c_defaultMaxUses        = 16;
+static const int    c_moduleCount           = 8;
+static const int    c_configurationCount    = 4;
+
+struct PoolRequest
+{
+    int     configuration;
+    int     module;
+};
+
+static SessionPoolDesc MakeConfiguration(int configuration)
+{
+    SessionPoolDesc desc;
+    SessionPoolTarget target;
+    if (configuration % 2)
+    {
+        target.format = SLANG_GLSL;
+        target.profile = "glsl_450";
+    }
+    desc.targets.push_back(target);
+    desc.searchPaths.push_back(".");
+    desc.macros.push_back({ "VARIANT", std::to_string(configuration / 2) });
+    return desc;
+}
+
+static std::string MakeModuleSource(int module)
+{
+    return "RWStructuredBuffer<float> Data;\n"
+        "float shade(float x)\n{\n"
+        "    for (int i = 0; i < " + std::to_string(4 + module) + " + VARIANT; i++)\n        x = x * 0.5 + sin(x);\n    return x;\n}\n"
+        "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\n"
+        "void csmain(uint3 DTid : SV_DispatchThreadID)\n{\n"
+        "    Data[DTid.x] = shade(Data[DTid.x]);\n}\n";
+}
+
+/// Requests in a fixed pseudo random order, so every strategy serves the same stream
+static std::vector<PoolRequest> MakeRequests(int requestCount)
+{
+    std::vector<PoolRequest> requests;
+    uint32_t state = 12345;
+    for (int i = 0; i < requestCount; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        requests.push_back({ int((state >> 8) % c_configurationCount), int((state >> 16) % c_moduleCount) });
+    }
+    return requests;
+}
+
+static bool CompileEntryPoint(slang::ISession* session, slang::IModule* module)
+{
+    ComPtr<slang::IEntryPoint> entryPoint;
+    if (!module || SLANG_FAILED(module->findEntryPointByName("csmain", entryPoint.writeRef())))
+        return false;
+
+    slang::IComponentType* components[] = { module, entryPoint };
+    ComPtr<slang::IComponentType> composite;
+    ComPtr<slang::IComponentType> linked;
+    ComPtr<ISlangBlob> code;
+    return SLANG_SUCCEEDED(session->createCompositeComponentType(components, 2, composite.writeRef()))
+        && SLANG_SUCCEEDED(composite->link(linked.writeRef()))
+        && SLANG_SUCCEEDED(linked->getEntryPointCode(0, 0, code.writeRef()))
+        && code && code->getBufferSize() > 0;
+}
+
+/// Runs the requests on threadCount workers, returning the time taken and counting failed requests
+static double ServeRequests(const std::vector<PoolRequest>& requests, int threadCount,
+    const std::function<bool(int worker, const PoolRequest& request)>& compile, int& outFailed)
+{
+    std::atomic<int> nextRequest{ 0 };
+    std::atomic<int> failed{ 0 };
+    Timer timer;
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < threadCount; worker++)
+    {
+        workers.emplace_back([&, worker]()
+        {
+            for (int request = nextRequest++; request < int(requests.size()); request = nextRequest++)
+                failed += compile(worker, requests[request]) ? 0 : 1;
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+    outFailed = failed;
+    return timer.elapsedMs();
+}
+
+static void PrintRow(const char* label, double ms, int requestCount, const SessionPoolStats* stats)
+{
+    printf("    %-26s %10.1f %10.1f", label, ms, ms > 0.0 ? double(requestCount) * 1000.0 / ms : 0.0);
+    if (stats)
+    {
+        printf(" %8.1f%% %8.1f%% %8.1f%% %8llu %8llu %8llu\n", stats->getHitRate() * 100.0,
+            stats->poolHits ? double(stats->affinityHits) * 100.0 / double(stats->poolHits) : 0.0, stats->getModuleReuseRate() * 100.0,
+            (unsigned long long)stats->sessionsCreated, (unsigned long long)stats->sessionsRecycled, (unsigned long long)stats->slotsCreated);
+    }
+    else
+        printf(" %9s %9s %9s %8i %8s %8s\n", "-", "-", "0.0%", requestCount, "-", "-");
+}
+
+int RunSessionPoolBenchmark(int argc, char** argv)
+{
+    int threadCount = argc > 1 ? atoi(argv[1]) : 0;
+    const int requestCount = argc > 2 ? atoi(argv[2]) : c_defaultRequestCount;
+    const int maxUses = argc > 3 ? atoi(argv[3]) : c_defaultMaxUses;
+    if (threadCount <= 0)
+        threadCount = int(std::thread::hardware_concurrency()) > 0 ? int(std::thread::hardware_concurrency()) : 1;
+    if (requestCount < 1 || maxUses < 1)
+    {
+        printf("Request count and max uses must be at least 1.\n");
+        return 1;
+    }
+
+    const std::vector<PoolRequest> requests = MakeRequests(requestCount);
+    std::vector<SessionPoolDesc> configurations;
+    std::vector<std::string> sources;
+    for (int i = 0; i < c_configurationCount; i++)
+        configurations.push_back(MakeConfiguration(i));
+    for (int i = 0; i < c_moduleCount; i++)
+        sources.push_back(MakeModuleSource(i));
+
+    printf("Session pool: %i requests over %i configurations and %i modules, %i threads\n\n", requestCount, c_configurationCount,
+        c_moduleCount, threadCount);
+    printf("    %-26s %10s %10s %9s %9s %9s %8s %8s %8s\n", "strategy", "ms", "req/s", "hits", "affinity", "mod reuse",
+        "sessions", "recycled", "globals");
+
+    int failures = 0;
+    int failed = 0;
+
+    // Each worker owns a global session, as they mustn't be shared between threads, and makes a session per request
+    std::vector<ComPtr<slang::IGlobalSession>> globalSessions(threadCount);
+    const double perRequestMs = ServeRequests(requests, threadCount, [&](int worker, const PoolRequest& request)
+    {
+        ComPtr<slang::IGlobalSession>& globalSession = globalSessions[worker];
+        if (!globalSession && SLANG_FAILED(slang_createGlobalSession(SLANG_API_VERSION, globalSession.writeRef())))
+            return false;
+
+        const SessionPoolDesc& configuration = configurations[request.configuration];
+        slang::TargetDesc targetDesc;
+        targetDesc.format = configuration.targets[0].format;
+        targetDesc.profile = globalSession->findProfile(configuration.targets[0].profile.c_str());
+        const char* searchPaths[] = { "." };
+        slang::PreprocessorMacroDesc macro = { configuration.macros[0].first.c_str(), configuration.macros[0].second.c_str() };
+
+        slang::SessionDesc sessionDesc;
+        sessionDesc.targets = &targetDesc;
+        sessionDesc.targetCount = 1;
+        sessionDesc.searchPaths = searchPaths;
+        sessionDesc.searchPathCount = 1;
+        sessionDesc.preprocessorMacros = &macro;
+        sessionDesc.preprocessorMacroCount = 1;
+
+        ComPtr<slang::ISession> session;
+        if (SLANG_FAILED(globalSession->createSession(sessionDesc, session.writeRef())))
+            return false;
+        const std::string moduleName = "module" + std::to_string(request.module);
+        const std::string path = moduleName + ".slang";
+        ComPtr<ISlangBlob> source = StringBlob::create(sources[request.module].c_str());
+        return CompileEntryPoint(session, session->loadModuleFromSource(moduleName.c_str(), path.c_str(), source));
+    }, failed);
+    globalSessions.clear();
+    PrintRow("session per request", perRequestMs, requestCount, nullptr);
+    failures += failed;
+
+    for (int recycle = 0; recycle < 2; recycle++)
+    {
+        SessionPool pool(recycle ? maxUses : 0);
+        const double ms = ServeRequests(requests, threadCount, [&](int, const PoolRequest& request)
+        {
+            SessionLease lease = pool.acquire(configurations[request.configuration]);
+            if (!lease.getSession())
+                return false;
+            std::string diagnostics;
+            const std::string moduleName = "module" + std::to_string(request.module);
+            return CompileEntryPoint(lease.getSession(), lease.loadModule(moduleName.c_str(), sources[request.module], diagnostics));
+        }, failed);
+
+        const SessionPoolStats stats = pool.getStats();
+        const std::string label = recycle ? "pool, recycle after " + std::to_string(maxUses) : std::string("pool");
+        PrintRow(label.c_str(), ms, requestCount, &stats);
+        failures += failed;
+
+        if (stats.acquires != uint64_t(requestCount) || stats.poolHits + stats.sessionsCreated != stats.acquires)
+        {
+            printf("    ERROR: the pool's counts don't add up\n");
+            failures++;
+        }
+        if (stats.slotsCreated > uint64_t(threadCount))
+        {
+            printf("    ERROR: %llu global sessions for %i threads\n", (unsigned long long)stats.slotsCreated, threadCount);
+            failures++;
+        }
+    }
+
+    if (failures)
+        printf("    ERROR: %i failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+// Measures the slang-gfx shader cache on the CPU device: cold startup (empty cache) against warm startup (cache
+// filled by the cold run), with the cache held to a byte budget by ShaderCacheBudget between runs.
+//
+// Startup is device creation, program/pipeline creation and the first dispatch of test.slang. Each run's cache
+// stats are printed and appended to a CSV file, one row per run, so they can be trended and used to size the cache.
+
+#include <filesystem>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#include "Bench.h"
+#include "GfxCompute.h"
+#include "RunModes.h"
+#include "ShaderCacheBudget.h"
+
+using namespace gfx;
+using Slang::ComPtr;
+
+static const char*      c_defaultCachePath      = "out_shadercache";
+static const uint64_t   c_defaultBudgetKB       = 64 * 1024;
+static const char*      c_fileNameStats         = "out_shadercache_stats.csv";
+static const char*      c_moduleName            = "test";
+static const char*      c_entryPointName        = "csmain";
+static const char*      c_dataParameterName     = "Data";
+static const int        c_elementCount          = 1024;
+
+struct ShaderCacheRun
+{
+    const char*         phase = "";
+    double              startupMs = 0.0;
+    ShaderCacheStats    stats = {};
+    ShaderCacheUsage    usage;          ///< On disk after the budget was enforced
+    ShaderCacheUsage    evicted;
+};
+
+// Creates a device using the cache, loads the kernel and dispatches once, then shuts the device down and applies the budget
+static bool RunStartup(const char* phase, ShaderCacheBudget& budget, ShaderCacheRun& outRun)
+{
+    outRun.phase = phase;
+
+    IDevice::Desc deviceDesc = {};
+    deviceDesc.shaderCache.shaderCachePath = budget.getCachePath().c_str();
+
+    Timer timer;
+    {
+        GfxComputeContext context;
+        GfxComputeKernel kernel;
+        ComPtr<IBufferResource> buffer;
+        ComPtr<IResourceView> view;
+        if (SLANG_FAILED(CreateGfxComputeContext(DeviceType::CPU, context, &deviceDesc)) ||
+            SLANG_FAILED(LoadComputeKernel(context.device, c_moduleName, c_entryPointName, kernel)) ||
+            SLANG_FAILED(CreateFloatBuffer(context.device, c_elementCount, nullptr, buffer.writeRef(), view.writeRef())) ||
+            SLANG_FAILED(DispatchAndWait(context, kernel, c_dataParameterName, view, c_elementCount)))
+        {
+            printf("%s startup failed.\n", phase);
+            return false;
+        }
+        outRun.startupMs = timer.elapsedMs();
+
+        ComPtr<IShaderCache> shaderCache;
+        SlangUUID shaderCacheGuid = SLANG_UUID_IShaderCache;
+        if (SLANG_SUCCEEDED(context.device->queryInterface(shaderCacheGuid, (void**)shaderCache.writeRef())))
+            shaderCache->getShaderCacheStats(&outRun.stats);
+    }
+
+    outRun.evicted = budget.enforce();
+    outRun.usage = budget.getUsage();
+    return true;
+}
+
+static void AppendStatsCsv(const ShaderCacheBudget& budget, const ShaderCacheRun& run)
+{
+    const bool writeHeader = !std::filesystem::exists(c_fileNameStats);
+
+    FILE* file = nullptr;
+    fopen_s(&file, c_fileNameStats, "ab");
+    if (!file)
+    {
+        printf("Could not open %s for writing.\n", c_fileNameStats);
+        return;
+    }
+
+    if (writeHeader)
+        fprintf(file, "time,phase,startup_ms,hits,misses,entries,disk_entries,disk_bytes,budget_bytes,evicted_entries,evicted_bytes\n");
+    fprintf(file, "%lld,%s,%.3f,%i,%i,%i,%llu,%llu,%llu,%llu,%llu\n",
+        (long long)time(nullptr), run.phase, run.startupMs,
+        int(run.stats.hitCount), int(run.stats.missCount), int(run.stats.entryCount),
+        (unsigned long long)run.usage.entryCount, (unsigned long long)run.usage.totalBytes,
+        (unsigned long long)budget.getMaxBytes(),
+        (unsigned long long)run.evicted.entryCount, (unsigned long long)run.evicted.totalBytes);
+    fclose(file);
+}
+
+int RunShaderCacheBenchmark(int argc, char** argv)
+{
+    const char* cachePath = argc > 1 ? argv[1] : c_defaultCachePath;
+    const uint64_t budgetBytes = (argc > 2 ? uint64_t(atoll(argv[2])) : c_defaultBudgetKB) * 1024;
+
+    ShaderCacheBudget budget(cachePath, budgetBytes);
+    printf("Shader cache: %s, budget %llu KB, stats appended to %s\n\n", cachePath, (unsigned long long)(budgetBytes / 1024), c_fileNameStats);
+
+    // Start cold
+    std::error_code error;
+    std::filesystem::remove_all(cachePath, error);
+
+    ShaderCacheRun runs[2];
+    if (!RunStartup("cold", budget, runs[0]) || !RunStartup("warm", budget, runs[1]))
+        return 1;
+
+    printf("    %-8s %12s %8s %8s %8s %14s %14s\n", "phase", "startup ms", "hits", "misses", "entries", "disk KB", "evicted KB");
+    for (const ShaderCacheRun& run : runs)
+    {
+        printf("    %-8s %12.3f %8i %8i %8i %14.1f %14.1f\n", run.phase, run.startupMs,
+            int(run.stats.hitCount), int(run.stats.missCount), int(run.stats.entryCount),
+            double(run.usage.totalBytes) / 1024.0, double(run.evicted.totalBytes) / 1024.0);
+        AppendStatsCsv(budget, run);
+    }
+
+    const ShaderCacheRun& cold = runs[0];
+    const ShaderCacheRun& warm = runs[1];
+    if (warm.stats.hitCount > 0)
+    {
+        printf("\n    compile cost saved per cache hit: %.3f ms\n", (cold.startupMs - warm.startupMs) / double(warm.stats.hitCount));
+    }
+    else
+    {
+        printf("\n    The warm run had no cache hits%s.\n", cold.evicted.entryCount ? ", the budget evicted what the cold run cached" : "");
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "ShaderCacheBudget.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+ShaderCacheBudget::ShaderCacheBudget(const char* cachePath, uint64_t maxBytes)
+    : m_cachePath(cachePath)
+    , m_maxBytes(maxBytes)
+{
+}
+
+ShaderCacheUsage ShaderCacheBudget::getUsage() const
+{
+    ShaderCacheUsage usage;
+    std::error_code error;
+    for (fs::recursive_directory_iterator it(m_cachePath, error), end; !error && it != end; it.increment(error))
+    {
+        if (!it->is_regular_file(error))
+            continue;
+        usage.entryCount++;
+        usage.totalBytes += it->file_size(error);
+    }
+    return usage;
+}
+
+ShaderCacheUsage ShaderCacheBudget::enforce()
+{
+    struct Entry
+    {
+        fs::path                path;
+        uint64_t                bytes;
+        fs::file_time_type      writeTime;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t totalBytes = 0;
+    std::error_code error;
+    for (fs::recursive_directory_iterator it(m_cachePath, error), end; !error && it != end; it.increment(error))
+    {
+        if (!it->is_regular_file(error))
+            continue;
+        Entry entry = { it->path(), it->file_size(error), it->last_write_time(error) };
+        totalBytes += entry.bytes;
+        entries.push_back(entry);
+    }
+
+    ShaderCacheUsage evicted;
+    if (totalBytes <= m_maxBytes)
+        return evicted;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.writeTime < b.writeTime; });
+    for (const Entry& entry : entries)
+    {
+        if (totalBytes <= m_maxBytes)
+            break;
+        if (fs::remove(entry.path, error))
+        {
+            totalBytes -= entry.bytes;
+            evicted.entryCount++;
+            evicted.totalBytes += entry.bytes;
+        }
+    }
+    return evicted;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// A byte budget for the slang-gfx shader cache.
+//
+// IDevice::ShaderCacheDesc can only cap the number of entries, but entries vary a lot in size, so an entry count
+// doesn't bound disk use. ShaderCacheBudget measures the cache directory and, when it's over budget, deletes the
+// oldest entries (by last write time) until it fits. The cache has no record of hits on disk, so this is oldest
+// written first rather than least recently used.
+//
+// Run it when no device is using the directory, e.g. at startup before creating the device, or after shutting it down.
+
+#include <stdint.h>
+#include <string>
+
+struct ShaderCacheUsage
+{
+    uint64_t    entryCount = 0;
+    uint64_t    totalBytes = 0;
+};
+
+class ShaderCacheBudget
+{
+public:
+    ShaderCacheBudget(const char* cachePath, uint64_t maxBytes);
+
+    /// The files in the cache directory and their total size. An empty usage if the directory doesn't exist.
+    ShaderCacheUsage getUsage() const;
+
+    /// Deletes the oldest entries until the cache fits the budget. Returns what was deleted.
+    ShaderCacheUsage enforce();
+
+    const std::string& getCachePath() const { return m_cachePath; }
+    uint64_t getMaxBytes() const { return m_maxBytes; }
+
+protected:
+    std::string     m_cachePath;
+    uint64_t        m_maxBytes;
+};
@@ -0,0 +1,79 @@
+#include "ShaderLayoutCache.h"
+
+#include <stdio.h>
+
+using namespace gfx;
+
+ShaderObjectLayout::ShaderObjectLayout(IShaderObject* rootObject)
+{
+    slang::TypeLayoutReflection* typeLayout = rootObject->getElementTypeLayout();
+    m_uniformSize = typeLayout->getSize();
+    _addFields(typeLayout, std::string(), ShaderOffset());
+}
+
+void ShaderObjectLayout::_addFields(slang::TypeLayoutReflection* typeLayout, const std::string& prefix, const ShaderOffset& base)
+{
+    const unsigned fieldCount = typeLayout->getFieldCount();
+    for (unsigned i = 0; i < fieldCount; i++)
+    {
+        slang::VariableLayoutReflection* field = typeLayout->getFieldByIndex(i);
+        slang::TypeLayoutReflection* fieldLayout = field->getTypeLayout();
+
+        ShaderParameterSlot slot;
+        slot.path = prefix.empty() ? std::string(field->getName()) : prefix + "." + field->getName();
+        slot.offset = base;
+        slot.offset.uniformOffset += SlangInt(field->getOffset());
+        slot.offset.bindingRangeIndex += GfxIndex(typeLayout->getFieldBindingRangeOffset(SlangInt(i)));
+        slot.uniformSize = fieldLayout->getSize();
+        slot.kind = fieldLayout->getKind();
+        m_slots.push_back(slot);
+
+        if (slot.kind == slang::TypeReflection::Kind::Struct)
+            _addFields(fieldLayout, slot.path, slot.offset);
+    }
+}
+
+const ShaderParameterSlot* ShaderObjectLayout::find(const char* path) const
+{
+    for (const ShaderParameterSlot& slot : m_slots)
+    {
+        if (slot.path == path)
+            return &slot;
+    }
+    return nullptr;
+}
+
+bool ShaderObjectLayout::matches(const ShaderStructField* fields, size_t fieldCount, size_t structSize) const
+{
+    bool ok = true;
+    if (structSize < m_uniformSize)
+    {
+        printf("Struct is %zu bytes but the uniform block is %zu.\n", structSize, m_uniformSize);
+        ok = false;
+    }
+
+    for (size_t i = 0; i < fieldCount; i++)
+    {
+        const ShaderParameterSlot* slot = find(fields[i].path);
+        if (!slot)
+        {
+            printf("No shader parameter \"%s\".\n", fields[i].path);
+            ok = false;
+        }
+        else if (size_t(slot->offset.uniformOffset) != fields[i].offset || slot->uniformSize != fields[i].size)
+        {
+            printf("\"%s\" is %zu bytes at %zu in the struct, but %zu bytes at %zu in the shader.\n",
+                fields[i].path, fields[i].size, fields[i].offset, slot->uniformSize, size_t(slot->offset.uniformOffset));
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+const ShaderObjectLayout& ShaderLayoutCache::getLayout(IShaderProgram* program, IShaderObject* rootObject)
+{
+    std::unique_ptr<ShaderObjectLayout>& layout = m_layouts[program];
+    if (!layout)
+        layout.reset(new ShaderObjectLayout(rootObject));
+    return *layout;
+}
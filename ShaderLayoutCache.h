@@ -0,0 +1,119 @@
+#pragma once
+
+// Resolves every parameter of a program's root shader object to its offset once, so per dispatch binding doesn't
+// look anything up by name.
+//
+// ShaderObjectLayout walks the root object's type layout and records a ShaderParameterSlot for every parameter path:
+// top level parameters ("Data"), struct members ("params.transform.scale") and the structs themselves. Setting a
+// slot is then a setData or setResource at a known offset.
+//
+// The root object's uniform (ordinary) data is one block, so it can also be written all at once. ShaderUniformBlock
+// is a byte copy of that block: write fields into it at their slot offsets and apply() it with a single setData. Or
+// keep the parameters in a C++ struct laid out to match, check it once with ShaderObjectLayout::matches(), and set
+// the whole struct with SetUniformBlock(). Resources are bound through their slots either way.
+//
+// ShaderLayoutCache keeps one layout per program.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <string.h>
+#include <vector>
+
+#include "GfxCompute.h"
+
+struct ShaderParameterSlot
+{
+    std::string                     path;
+    gfx::ShaderOffset               offset;
+    size_t                          uniformSize = 0;    ///< Bytes of uniform data, 0 for resources and samplers
+    slang::TypeReflection::Kind     kind = slang::TypeReflection::Kind::None;
+
+    bool isResource() const
+    {
+        return kind == slang::TypeReflection::Kind::Resource || kind == slang::TypeReflection::Kind::SamplerState;
+    }
+};
+
+/// A field of a C++ struct mirroring the uniform block, for ShaderObjectLayout::matches().
+struct ShaderStructField
+{
+    const char*     path;
+    size_t          offset;
+    size_t          size;
+};
+
+class ShaderObjectLayout
+{
+public:
+    /// Builds the layout of a root shader object, e.g. one from IDevice::createMutableRootShaderObject.
+    explicit ShaderObjectLayout(gfx::IShaderObject* rootObject);
+
+    /// The slot for a parameter path, or nullptr. Look slots up once and keep them.
+    const ShaderParameterSlot* find(const char* path) const;
+
+    const std::vector<ShaderParameterSlot>& getSlots() const { return m_slots; }
+
+    /// Size of the root object's uniform data block.
+    size_t getUniformSize() const { return m_uniformSize; }
+
+    /// True if every field sits at the same offset and size as the matching slot, and the struct covers the block,
+    /// so a struct of `structSize` bytes can be set with SetUniformBlock(). Mismatches are printed.
+    bool matches(const ShaderStructField* fields, size_t fieldCount, size_t structSize) const;
+
+protected:
+    void _addFields(slang::TypeLayoutReflection* typeLayout, const std::string& prefix, const gfx::ShaderOffset& base);
+
+    std::vector<ShaderParameterSlot>    m_slots;
+    size_t                              m_uniformSize = 0;
+};
+
+/// Sets one uniform parameter. T must be the parameter's size.
+template <typename T>
+inline SlangResult SetUniform(gfx::IShaderObject* object, const ShaderParameterSlot& slot, const T& value)
+{
+    return sizeof(T) == slot.uniformSize ? object->setData(slot.offset, &value, sizeof(T)) : SLANG_E_INVALID_ARG;
+}
+
+/// Sets the whole uniform block of a root object from a struct checked with ShaderObjectLayout::matches().
+template <typename T>
+inline SlangResult SetUniformBlock(gfx::IShaderObject* rootObject, const ShaderObjectLayout& layout, const T& block)
+{
+    return sizeof(T) >= layout.getUniformSize() ? rootObject->setData(gfx::ShaderOffset(), &block, layout.getUniformSize()) : SLANG_E_INVALID_ARG;
+}
+
+/// A CPU copy of a root object's uniform data block.
+class ShaderUniformBlock
+{
+public:
+    explicit ShaderUniformBlock(const ShaderObjectLayout& layout) : m_data(layout.getUniformSize(), 0) {}
+
+    template <typename T>
+    void write(const ShaderParameterSlot& slot, const T& value)
+    {
+        if (sizeof(T) == slot.uniformSize && slot.offset.uniformOffset + sizeof(T) <= m_data.size())
+            memcpy(m_data.data() + slot.offset.uniformOffset, &value, sizeof(T));
+    }
+
+    /// Sets the whole block on the object with one setData.
+    SlangResult apply(gfx::IShaderObject* rootObject) const
+    {
+        return rootObject->setData(gfx::ShaderOffset(), m_data.data(), m_data.size());
+    }
+
+    const void* getData() const { return m_data.data(); }
+    size_t getSize() const { return m_data.size(); }
+
+protected:
+    std::vector<unsigned char>  m_data;
+};
+
+class ShaderLayoutCache
+{
+public:
+    /// The layout for a program, built from `rootObject` (a root object of that program) the first time.
+    const ShaderObjectLayout& getLayout(gfx::IShaderProgram* program, gfx::IShaderObject* rootObject);
+
+protected:
+    std::map<gfx::IShaderProgram*, std::unique_ptr<ShaderObjectLayout>>   m_layouts;
+};
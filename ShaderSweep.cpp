@@ -0,0 +1,96 @@
+#include "ShaderSweep.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "ReproCorpus.h"
+
+ShaderSweepResult RunShaderSweep(const ShaderSweepDesc& desc)
+{
+    ShaderSweepResult result;
+    const int permutationCount = int(desc.permutations.size());
+    int threadCount = desc.threadCount;
+    if (threadCount <= 0)
+        threadCount = int(std::thread::hardware_concurrency()) > 0 ? int(std::thread::hardware_concurrency()) : 1;
+    if (threadCount > permutationCount)
+        threadCount = permutationCount > 0 ? permutationCount : 1;
+
+    std::atomic<int> nextPermutation{ 0 };
+    std::atomic<bool> stopped{ false };
+    std::mutex resultMutex;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // The legacy API's sessions aren't thread safe, so each worker has its own
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back([&]()
+        {
+            SlangSession* session = spCreateSession(NULL);
+            while (!stopped.load(std::memory_order_relaxed))
+            {
+                const int permutation = nextPermutation++;
+                if (permutation >= permutationCount)
+                    break;
+
+                SlangCompileRequest* request = spCreateCompileRequest(session);
+                if (desc.checkOnly)
+                    spSetCompileFlags(request, SLANG_COMPILE_FLAG_NO_CODEGEN);
+                spSetCodeGenTarget(request, desc.target);
+                spSetTargetProfile(request, 0, spFindProfile(session, desc.profile.c_str()));
+                for (const auto& define : desc.permutations[permutation])
+                    spAddPreprocessorDefine(request, define.first.c_str(), define.second.c_str());
+
+                const int translationUnitIndex = spAddTranslationUnit(request, SLANG_SOURCE_LANGUAGE_SLANG, "");
+                spAddTranslationUnitSourceString(request, translationUnitIndex, desc.sourcePath.c_str(), desc.source.c_str());
+                spAddEntryPoint(request, translationUnitIndex, desc.entryPointName.c_str(), SLANG_STAGE_COMPUTE);
+
+                if (desc.reproRecorder)
+                    desc.reproRecorder->prepare(request);
+
+                const std::chrono::steady_clock::time_point compileStart = std::chrono::steady_clock::now();
+                bool ok = SLANG_SUCCEEDED(spCompile(request));
+                size_t codeSize = 0;
+                if (ok && !desc.checkOnly)
+                {
+                    spGetEntryPointCode(request, 0, &codeSize);
+                    ok = codeSize > 0;
+                }
+                if (desc.reproRecorder)
+                {
+                    const double compileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+                    desc.reproRecorder->recordIfSlow(request, desc.sourcePath + "_p" + std::to_string(permutation), compileMs);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    result.codeBytes += codeSize;
+                    if (ok)
+                        result.succeeded++;
+                    else
+                    {
+                        result.failed++;
+                        if (result.firstFailure < 0)
+                        {
+                            const char* diagnostics = spGetDiagnosticOutput(request);
+                            result.firstFailure = permutation;
+                            result.firstFailureDiagnostics = diagnostics ? diagnostics : "";
+                        }
+                        if (desc.stopOnFirstError)
+                            stopped = true;
+                    }
+                }
+                spDestroyCompileRequest(request);
+            }
+            spDestroySession(session);
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.skipped = permutationCount - result.succeeded - result.failed;
+    return result;
+}
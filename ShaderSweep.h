@@ -0,0 +1,50 @@
+#pragma once
+
+// Compiles every permutation of a shader (one set of preprocessor defines each) in parallel, as a CI sweep does.
+//
+// In check only mode each compile sets SLANG_COMPILE_FLAG_NO_CODEGEN, so slang parses, checks and links the
+// permutation but generates no code: enough to know it compiles, at a fraction of the cost. Otherwise code is
+// generated and read back for every permutation.
+//
+// With stopOnFirstError, the first failure cancels the sweep: workers finish the permutation they're on and take no
+// more, and the permutations never started are counted as skipped.
+//
+// Given a SlowCompileRecorder (ReproCorpus.h), permutations that compile slower than its threshold are saved as repros
+// labelled with the source path and permutation index.
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "slang/slang.h"
+
+class SlowCompileRecorder;
+
+typedef std::vector<std::pair<std::string, std::string>> ShaderDefines;
+
+struct ShaderSweepDesc
+{
+    std::string                     sourcePath;         ///< Reported in diagnostics
+    std::string                     source;
+    std::string                     entryPointName = "csmain";
+    SlangCompileTarget              target = SLANG_HLSL;
+    std::string                     profile = "cs_5_1";
+    std::vector<ShaderDefines>      permutations;
+    bool                            checkOnly = false;
+    bool                            stopOnFirstError = false;
+    int                             threadCount = 0;    ///< One per hardware thread if 0
+    SlowCompileRecorder*            reproRecorder = nullptr;
+};
+
+struct ShaderSweepResult
+{
+    int                             succeeded = 0;
+    int                             failed = 0;
+    int                             skipped = 0;        ///< Not started because the sweep stopped
+    size_t                          codeBytes = 0;      ///< Generated code over all permutations, 0 when checking only
+    double                          ms = 0.0;
+    int                             firstFailure = -1;  ///< Index of the first permutation that failed, in completion order
+    std::string                     firstFailureDiagnostics;
+};
+
+ShaderSweepResult RunShaderSweep(const ShaderSweepDesc& desc);
@@ -0,0 +1,46 @@
+#pragma once
+
+// Small helpers shared by the code that drives slang: FNV-1a hashes of source and files, used to key caches and spot
+// stale outputs, and gathering diagnostics blobs into a string.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#include "slang/slang.h"
+
+static const uint64_t c_fnvOffsetBasis  = 14695981039346656037ull;
+static const uint64_t c_fnvPrime        = 1099511628211ull;
+
+/// Continues an FNV-1a hash over `size` bytes. Start from c_fnvOffsetBasis.
+inline uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= uint64_t(bytes[i]);
+        hash *= c_fnvPrime;
+    }
+    return hash;
+}
+
+/// 16 hex digits
+inline std::string HashToHex(uint64_t hash)
+{
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+    return hex;
+}
+
+/// The hash of some source, in hex
+inline std::string HashSource(const std::string& source)
+{
+    return HashToHex(HashBytes(c_fnvOffsetBasis, source.data(), source.size()));
+}
+
+inline void AppendDiagnostics(std::string& diagnostics, ISlangBlob* blob)
+{
+    if (blob && blob->getBufferSize())
+        diagnostics.append((const char*)blob->getBufferPointer(), blob->getBufferSize());
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+// Devirtualized texture types for CPU kernels.
+//
+// The prelude's Texture2D<T> holds an ITexture* and every Load/Sample is a virtual call that returns its
+// result through `void* outData, size_t dataSize`, which stops the compiler inlining sampling into hot loops.
+// StaticTexture2D<T, LAYOUT, FILTER, ADDRESS> has the same member functions, but the texel format (T),
+// storage layout, filter and address mode are template parameters, so the whole sample inlines.
+//
+// It reads the storage of a CPUTexture2D, and like Texture2D it is a single pointer. The pointer is binary
+// compatible with the ITexture* the host would bind, so kernel uniform data is laid out the same way in both modes.
+//
+// Compile mode: kernel source written against KernelTexture2D<T> gets StaticTexture2D with the default policies
+// when SLANG_TEST_STATIC_TEXTURES is defined, and the prelude's Texture2D otherwise. For C++ emitted by Slang,
+// include this header after the prelude and define SLANG_TEST_STATIC_TEXTURES_REPLACE_PRELUDE, which maps the
+// prelude's Texture2D name onto the static type. The texture the host binds must match the policies chosen here.
+
+#include "CPUTexture.h"
+
+// ----------------------------- Layout policies -----------------------------------------
+
+struct LinearLayoutPolicy
+{
+    static const TextureLayout kLayout = TextureLayout::Linear;
+
+    static SLANG_FORCE_INLINE size_t texelIndex(const CPUTexture2D::Level& level, uint32_t x, uint32_t y)
+    {
+        return level.texelOffset + size_t(y) * level.width + x;
+    }
+};
+
+struct MortonTiledLayoutPolicy
+{
+    static const TextureLayout kLayout = TextureLayout::MortonTiled;
+
+    static SLANG_FORCE_INLINE uint32_t spreadBits(uint32_t v)
+    {
+        // Same 3 bit spread as CPUTexture2D, done with shifts so no table lookup is needed
+        v &= CPUTexture2D::kTileSize - 1;
+        return (v & 1) | ((v & 2) << 1) | ((v & 4) << 2);
+    }
+
+    static SLANG_FORCE_INLINE size_t texelIndex(const CPUTexture2D::Level& level, uint32_t x, uint32_t y)
+    {
+        size_t tileIndex = size_t(y >> CPUTexture2D::kTileShift) * level.tileCountX + (x >> CPUTexture2D::kTileShift);
+        return level.texelOffset + tileIndex * CPUTexture2D::kTileTexelCount + (spreadBits(x) | (spreadBits(y) << 1));
+    }
+};
+
+// ----------------------------- Address policies -----------------------------------------
+
+struct WrapAddressPolicy
+{
+    static const TextureAddressMode kAddressMode = TextureAddressMode::Wrap;
+
+    static SLANG_FORCE_INLINE uint32_t address(int32_t v, uint32_t size)
+    {
+        // Most textures are a power of two in size, and a mask is much cheaper than a division
+        if ((size & (size - 1)) == 0)
+            return uint32_t(v) & (size - 1);
+        int32_t wrapped = v % int32_t(size);
+        return uint32_t(wrapped < 0 ? wrapped + int32_t(size) : wrapped);
+    }
+};
+
+struct ClampAddressPolicy
+{
+    static const TextureAddressMode kAddressMode = TextureAddressMode::Clamp;
+
+    static SLANG_FORCE_INLINE uint32_t address(int32_t v, uint32_t size)
+    {
+        return uint32_t(v < 0 ? 0 : (v >= int32_t(size) ? int32_t(size) - 1 : v));
+    }
+};
+
+// ----------------------------- Filter policies -----------------------------------------
+
+// A filter reads one mip with `sampleMip`, and says how a lod maps onto mips with `kBlendsLevels`.
+// TEXEL_ACCESS provides `fetch(levelIndex, x, y)` returning a pointer to CHANNEL_COUNT floats.
+
+struct PointFilterPolicy
+{
+    static const TextureFilter kFilter = TextureFilter::Point;
+    static const bool kBlendsLevels = false;
+
+    template <int CHANNEL_COUNT, typename ADDRESS, typename TEXEL_ACCESS>
+    static SLANG_FORCE_INLINE void sampleMip(const TEXEL_ACCESS& access, const CPUTexture2D::Level& level, int levelIndex, float u, float v, float* out)
+    {
+        const uint32_t x = ADDRESS::address(int32_t(floorf(u * level.width)), level.width);
+        const uint32_t y = ADDRESS::address(int32_t(floorf(v * level.height)), level.height);
+        const float* texel = access.fetch(levelIndex, x, y);
+        for (int c = 0; c < CHANNEL_COUNT; c++)
+            out[c] = texel[c];
+    }
+};
+
+struct BilinearFilterPolicy
+{
+    static const TextureFilter kFilter = TextureFilter::Bilinear;
+    static const bool kBlendsLevels = false;
+
+    template <int CHANNEL_COUNT, typename ADDRESS, typename TEXEL_ACCESS>
+    static SLANG_FORCE_INLINE void sampleMip(const TEXEL_ACCESS& access, const CPUTexture2D::Level& level, int levelIndex, float u, float v, float* out)
+    {
+        const float x = u * level.width - 0.5f;
+        const float y = v * level.height - 0.5f;
+        const float floorX = floorf(x);
+        const float floorY = floorf(y);
+        const float fracX = x - floorX;
+        const float fracY = y - floorY;
+        const uint32_t x0 = ADDRESS::address(int32_t(floorX), level.width);
+        const uint32_t x1 = ADDRESS::address(int32_t(floorX) + 1, level.width);
+        const uint32_t y0 = ADDRESS::address(int32_t(floorY), level.height);
+        const uint32_t y1 = ADDRESS::address(int32_t(floorY) + 1, level.height);
+
+        const float* t00 = access.fetch(levelIndex, x0, y0);
+        const float* t10 = access.fetch(levelIndex, x1, y0);
+        const float* t01 = access.fetch(levelIndex, x0, y1);
+        const float* t11 = access.fetch(levelIndex, x1, y1);
+        for (int c = 0; c < CHANNEL_COUNT; c++)
+        {
+            float top = t00[c] + (t10[c] - t00[c]) * fracX;
+            float bottom = t01[c] + (t11[c] - t01[c]) * fracX;
+            out[c] = top + (bottom - top) * fracY;
+        }
+    }
+};
+
+struct TrilinearFilterPolicy
+{
+    static const TextureFilter kFilter = TextureFilter::Trilinear;
+    static const bool kBlendsLevels = true;
+
+    template <int CHANNEL_COUNT, typename ADDRESS, typename TEXEL_ACCESS>
+    static SLANG_FORCE_INLINE void sampleMip(const TEXEL_ACCESS& access, const CPUTexture2D::Level& level, int levelIndex, float u, float v, float* out)
+    {
+        BilinearFilterPolicy::sampleMip<CHANNEL_COUNT, ADDRESS>(access, level, levelIndex, u, v, out);
+    }
+};
+
+// ----------------------------- StaticTexture2D -----------------------------------------
+
+template <typename T, typename LAYOUT = MortonTiledLayoutPolicy, typename FILTER = BilinearFilterPolicy, typename ADDRESS = WrapAddressPolicy>
+struct StaticTexture2D
+{
+    static const int kChannelCount = int(sizeof(T) / sizeof(float));
+
+    void GetDimensions(uint32_t* outWidth, uint32_t* outHeight)
+    {
+        const auto& level = texture->getLevel(0);
+        *outWidth = level.width;
+        *outHeight = level.height;
+    }
+    void GetDimensions(uint32_t mipLevel, uint32_t* outWidth, uint32_t* outHeight, uint32_t* outNumberOfLevels)
+    {
+        const auto& level = texture->getLevel(int(mipLevel));
+        *outWidth = level.width;
+        *outHeight = level.height;
+        *outNumberOfLevels = uint32_t(texture->getLevelCount());
+    }
+    void GetDimensions(float* outWidth, float* outHeight)
+    {
+        const auto& level = texture->getLevel(0);
+        *outWidth = float(level.width);
+        *outHeight = float(level.height);
+    }
+    void GetDimensions(uint32_t mipLevel, float* outWidth, float* outHeight, float* outNumberOfLevels)
+    {
+        const auto& level = texture->getLevel(int(mipLevel));
+        *outWidth = float(level.width);
+        *outHeight = float(level.height);
+        *outNumberOfLevels = float(texture->getLevelCount());
+    }
+
+    SLANG_FORCE_INLINE T Load(const int3& loc) const
+    {
+        T out;
+        float* outTexel = (float*)&out;
+        if (loc.z >= 0 && loc.z < texture->getLevelCount())
+        {
+            const auto& level = texture->getLevel(loc.z);
+            if (uint32_t(loc.x) < level.width && uint32_t(loc.y) < level.height)
+            {
+                const float* texel = fetch(loc.z, uint32_t(loc.x), uint32_t(loc.y));
+                for (int c = 0; c < kChannelCount; c++)
+                    outTexel[c] = texel[c];
+                return out;
+            }
+        }
+        for (int c = 0; c < kChannelCount; c++)
+            outTexel[c] = 0.0f;
+        return out;
+    }
+
+    SLANG_FORCE_INLINE T Sample(SamplerState samplerState, const float2& loc) const
+    {
+        // As with CPUTexture2D, there are no derivatives so an implicit lod sample reads the top level
+        (void)samplerState;
+        return _sampleLevel(loc.x, loc.y, 0.0f);
+    }
+
+    SLANG_FORCE_INLINE T SampleLevel(SamplerState samplerState, const float2& loc, float level) const
+    {
+        (void)samplerState;
+        return _sampleLevel(loc.x, loc.y, level);
+    }
+
+    /// Used by the filter policies
+    SLANG_FORCE_INLINE const float* fetch(int levelIndex, uint32_t x, uint32_t y) const
+    {
+        return texture->getTexelData() + LAYOUT::texelIndex(texture->getLevel(levelIndex), x, y) * kChannelCount;
+    }
+
+    /// Checks the policies match how the bound texture was created
+    bool isCompatible() const
+    {
+        return texture->getChannelCount() == kChannelCount &&
+            texture->getLayout() == LAYOUT::kLayout &&
+            texture->getFilter() == FILTER::kFilter &&
+            texture->getAddressMode() == ADDRESS::kAddressMode;
+    }
+
+    CPUTexture2D* texture;
+
+protected:
+    SLANG_FORCE_INLINE T _sampleLevel(float u, float v, float level) const
+    {
+        const int levelCount = texture->getLevelCount();
+        const float maxLevel = float(levelCount - 1);
+        level = level < 0.0f ? 0.0f : (level > maxLevel ? maxLevel : level);
+
+        T out;
+        float* outTexel = (float*)&out;
+        if (!FILTER::kBlendsLevels)
+        {
+            const int levelIndex = int(level + 0.5f);
+            FILTER::template sampleMip<kChannelCount, ADDRESS>(*this, texture->getLevel(levelIndex), levelIndex, u, v, outTexel);
+            return out;
+        }
+
+        const int level0 = int(level);
+        const float fracLevel = level - float(level0);
+        FILTER::template sampleMip<kChannelCount, ADDRESS>(*this, texture->getLevel(level0), level0, u, v, outTexel);
+        if (fracLevel > 0.0f)
+        {
+            float texel1[kChannelCount];
+            FILTER::template sampleMip<kChannelCount, ADDRESS>(*this, texture->getLevel(level0 + 1), level0 + 1, u, v, texel1);
+            for (int c = 0; c < kChannelCount; c++)
+                outTexel[c] += (texel1[c] - outTexel[c]) * fracLevel;
+        }
+        return out;
+    }
+};
+
+template <typename T>
+using DefaultStaticTexture2D = StaticTexture2D<T, MortonTiledLayoutPolicy, BilinearFilterPolicy, WrapAddressPolicy>;
+
+#ifdef SLANG_TEST_STATIC_TEXTURES
+template <typename T>
+using KernelTexture2D = DefaultStaticTexture2D<T>;
+#else
+template <typename T>
+using KernelTexture2D = Texture2D<T>;
+#endif
+
+#ifdef SLANG_TEST_STATIC_TEXTURES_REPLACE_PRELUDE
+#   define Texture2D DefaultStaticTexture2D
+#endif
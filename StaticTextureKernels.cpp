@@ -0,0 +1,42 @@
+// Builds the rotate kernel in StaticTexture.h's compile mode: see StaticTextureKernels.h.
+
+#define SLANG_TEST_STATIC_TEXTURES
+#define SLANG_TEST_STATIC_TEXTURES_REPLACE_PRELUDE
+
+// RotateKernelParams is declared with the prelude's Texture2D, before StaticTexture.h renames it
+#include "StaticTextureKernels.h"
+#include "StaticTexture.h"
+
+struct StaticModeParams
+{
+    KernelTexture2D<float4>         source;
+    SamplerState                    samplerState;
+    RWStructuredBuffer<float4>      dest;
+    uint32_t                        size;
+    float                           level;
+};
+
+// Texture2D is DefaultStaticTexture2D from here on
+struct ReplacedPreludeParams
+{
+    Texture2D<float4>               source;
+    SamplerState                    samplerState;
+    RWStructuredBuffer<float4>      dest;
+    uint32_t                        size;
+    float                           level;
+};
+
+static_assert(sizeof(StaticModeParams) == sizeof(RotateKernelParams), "The static texture must be laid out like Texture2D");
+static_assert(sizeof(ReplacedPreludeParams) == sizeof(RotateKernelParams), "The static texture must be laid out like Texture2D");
+
+void RotateKernelStaticMode(const void* params, uint32_t x, uint32_t y)
+{
+    const StaticModeParams& p = *(const StaticModeParams*)params;
+    p.dest[size_t(y) * p.size + x] = p.source.SampleLevel(p.samplerState, RotateLocation(p.size, x, y), p.level);
+}
+
+void RotateKernelReplacedPrelude(const void* params, uint32_t x, uint32_t y)
+{
+    const ReplacedPreludeParams& p = *(const ReplacedPreludeParams*)params;
+    p.dest[size_t(y) * p.size + x] = p.source.SampleLevel(p.samplerState, RotateLocation(p.size, x, y), p.level);
+}
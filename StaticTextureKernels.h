@@ -0,0 +1,39 @@
+#pragma once
+
+// The texture benchmark's rotate kernel built in StaticTexture.h's compile mode, by StaticTextureKernels.cpp, which
+// defines SLANG_TEST_STATIC_TEXTURES and SLANG_TEST_STATIC_TEXTURES_REPLACE_PRELUDE. One copy is written against
+// KernelTexture2D, the other against the prelude's Texture2D as Slang emits it, so both get DefaultStaticTexture2D.
+//
+// The host binds the texture as it would for the prelude's Texture2D, an ITexture* in RotateKernelParams, and the
+// kernels read the same bytes as their static type, as a kernel's uniform data would be.
+
+#include "CPUTexture.h"
+
+static const float  c_rotation  = 0.5f;     // radians
+static const float  c_scale     = 1.7f;     // > 1 minifies, so the trilinear path reads two mips
+
+/// The rotated and scaled location thread (x, y) samples
+inline float2 RotateLocation(uint32_t size, uint32_t x, uint32_t y)
+{
+    const float cosR = cosf(c_rotation) * c_scale;
+    const float sinR = sinf(c_rotation) * c_scale;
+    const float u = (float(x) + 0.5f) / float(size) - 0.5f;
+    const float v = (float(y) + 0.5f) / float(size) - 0.5f;
+    return float2(u * cosR - v * sinR + 0.5f, u * sinR + v * cosR + 0.5f);
+}
+
+/// Uniform data as the host lays it out
+struct RotateKernelParams
+{
+    Texture2D<float4>               source;
+    SamplerState                    samplerState;
+    RWStructuredBuffer<float4>      dest;
+    uint32_t                        size;
+    float                           level;
+};
+
+/// Written against KernelTexture2D, built with SLANG_TEST_STATIC_TEXTURES
+void RotateKernelStaticMode(const void* params, uint32_t x, uint32_t y);
+
+/// Written against Texture2D as Slang emits it, built with SLANG_TEST_STATIC_TEXTURES_REPLACE_PRELUDE
+void RotateKernelReplacedPrelude(const void* params, uint32_t x, uint32_t y);
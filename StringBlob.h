@@ -5,6 +5,14 @@
 // It'd be nice if loadModuleFromSource() could take a const char* for the source code instead, so none of this was needed!
 // Or, alternately, if StringBlob was exposed in the public headers, that you get when downloading the prebuilt binaries.
 
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#include "slang/slang.h"
+#include "slang/slang-com-ptr.h"
+
 /// A base class for COM interfaces that require atomic ref counting 
 /// and are *NOT* derived from RefObject
 class ComBaseObject
@@ -71,11 +79,11 @@ public:
     virtual SLANG_NO_THROW void* SLANG_MCALL castAs(const SlangUUID& guid) SLANG_OVERRIDE;
 
 protected:
-    ISlangUnknown* getInterface(const Guid& guid);
-    void* getObject(const Guid& guid);
+    ISlangUnknown* getInterface(const SlangUUID& guid);
+    void* getObject(const SlangUUID& guid);
 };
 
-ISlangUnknown* BlobBase::getInterface(const Guid& guid)
+inline ISlangUnknown* BlobBase::getInterface(const SlangUUID& guid)
 {
     if (guid == ISlangUnknown::getTypeGuid() ||
         guid == ISlangBlob::getTypeGuid())
@@ -89,13 +97,13 @@ ISlangUnknown* BlobBase::getInterface(const Guid& guid)
     return nullptr;
 }
 
-void* BlobBase::getObject(const Guid& guid)
+inline void* BlobBase::getObject(const SlangUUID& guid)
 {
     SLANG_UNUSED(guid);
     return nullptr;
 }
 
-void* BlobBase::castAs(const SlangUUID& guid)
+inline void* BlobBase::castAs(const SlangUUID& guid)
 {
     if (auto intf = getInterface(guid))
     {
@@ -128,14 +136,25 @@ public:
     SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() SLANG_OVERRIDE { return string; }
     SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() SLANG_OVERRIDE { return strlen(string); }
 
-    static ComPtr<ISlangBlob> create(const char* in)
+    static Slang::ComPtr<ISlangBlob> create(const char* in)
     {
         auto blob = new StringBlob;
         blob->string = in;
-        return ComPtr<ISlangBlob>(blob);
+        return Slang::ComPtr<ISlangBlob>(blob);
+    }
+
+    /// A blob with its own copy of the string. Slang keeps the source blob of a module for as long as the module, to
+    /// report diagnostics against, so use this for a module that outlives the caller's string.
+    static Slang::ComPtr<ISlangBlob> createCopy(const char* in)
+    {
+        auto blob = new StringBlob;
+        blob->copy = in;
+        blob->string = blob->copy.c_str();
+        return Slang::ComPtr<ISlangBlob>(blob);
     }
 
 protected:
 
     const char* string = nullptr;
+    std::string copy;
 };
@@ -0,0 +1,227 @@
+// Runs a TensorView kernel on the CPU (CPUTensor.h): out = relu(x * scale + bias) * y over [rows, cols] float
+// tensors, fused into one kernel dispatched on CPUDispatcher, against the same chain run eagerly, one operator and
+// one newly allocated result tensor at a time. The fused kernel is run on contiguous tensors, bound zero copy, and
+// with x transposed, which binds through a staging copy.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "CPUDispatcher.h"
+#include "CPUTensor.h"
+#include "RunModes.h"
+
+static const uint32_t   c_threadsPerGroup       = 64;
+static const uint32_t   c_columnCount           = 1024;
+static const uint32_t   c_defaultElementCount   = 1 << 22;
+static const int        c_repeatCount           = 5;
+static const float      c_scale                 = 1.5f;
+static const float      c_bias                  = -256.0f;
+
+struct FusedKernelParams
+{
+    CPUTensorView   x;
+    CPUTensorView   y;
+    CPUTensorView   out;
+    float           scale;
+    float           bias;
+    uint32_t        rowCount;
+};
+
+// Written the way the C++ target emits a kernel: the thread body, then the group loop for [numthreads(64, 1, 1)]
+static void FusedKernelThread(const uint3& dispatchThreadID, FusedKernelParams* params)
+{
+    const uint32_t row = dispatchThreadID.x / c_columnCount;
+    const uint32_t col = dispatchThreadID.x % c_columnCount;
+    if (row >= params->rowCount)
+        return;
+    const float value = params->x.load<float>(row, col) * params->scale + params->bias;
+    params->out.store<float>(row, col, (value > 0.0f ? value : 0.0f) * params->y.load<float>(row, col));
+}
+
+static void FusedKernel(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    FusedKernelParams* params = (FusedKernelParams*)uniformEntryPointParams;
+    for (uint32_t groupX = varyingInput->startGroupID.x; groupX < varyingInput->endGroupID.x; groupX++)
+    {
+        for (uint32_t threadX = 0; threadX < c_threadsPerGroup; threadX++)
+            FusedKernelThread(uint3(groupX * c_threadsPerGroup + threadX, 0, 0), params);
+    }
+}
+
+enum EagerOp
+{
+    EagerOp_MulScalar,
+    EagerOp_AddScalar,
+    EagerOp_Relu,
+    EagerOp_Mul,
+};
+
+struct EagerKernelParams
+{
+    const float*    a;
+    const float*    b;
+    float*          out;
+    float           scalar;
+    uint32_t        count;
+    EagerOp         op;
+};
+
+// One elementwise operator over contiguous tensors, as an eager framework runs each op of the chain
+static void EagerKernel(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    const EagerKernelParams* params = (const EagerKernelParams*)uniformEntryPointParams;
+    for (uint32_t groupX = varyingInput->startGroupID.x; groupX < varyingInput->endGroupID.x; groupX++)
+    {
+        const uint32_t begin = groupX * c_threadsPerGroup;
+        const uint32_t end = begin + c_threadsPerGroup < params->count ? begin + c_threadsPerGroup : params->count;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            switch (params->op)
+            {
+                case EagerOp_MulScalar: params->out[i] = params->a[i] * params->scalar; break;
+                case EagerOp_AddScalar: params->out[i] = params->a[i] + params->scalar; break;
+                case EagerOp_Relu:      params->out[i] = params->a[i] > 0.0f ? params->a[i] : 0.0f; break;
+                case EagerOp_Mul:       params->out[i] = params->a[i] * params->b[i]; break;
+            }
+        }
+    }
+}
+
+static std::vector<float> RunEagerOp(CPUDispatcher& dispatcher, EagerOp op, const std::vector<float>& a, const float* b, float scalar)
+{
+    std::vector<float> out(a.size());
+    EagerKernelParams params = { a.data(), b, out.data(), scalar, uint32_t(a.size()), op };
+    dispatcher.dispatch(EagerKernel, uint3((params.count + c_threadsPerGroup - 1) / c_threadsPerGroup, 1, 1), &params, nullptr);
+    return out;
+}
+
+/// Binds the tensors and runs the fused kernel. Returns false if a tensor couldn't be bound.
+static bool RunFused(CPUDispatcher& dispatcher, const HostTensor& x, const HostTensor& y, const HostTensor& out, bool& outZeroCopy)
+{
+    CPUTensorBinding xBinding, yBinding, outBinding;
+    std::string error;
+    if (!xBinding.bind(x, TensorScalarType::Float32, "x", error) ||
+        !yBinding.bind(y, TensorScalarType::Float32, "y", error) ||
+        !outBinding.bind(out, TensorScalarType::Float32, "out", error))
+    {
+        printf("    ERROR: %s\n", error.c_str());
+        return false;
+    }
+
+    FusedKernelParams params = { xBinding.getView(), yBinding.getView(), outBinding.getView(), c_scale, c_bias, uint32_t(x.sizes[0]) };
+    const uint64_t elementCount = uint64_t(x.getElementCount());
+    dispatcher.dispatch(FusedKernel, uint3(uint32_t((elementCount + c_threadsPerGroup - 1) / c_threadsPerGroup), 1, 1), &params, nullptr);
+    outBinding.commit();
+
+    outZeroCopy = xBinding.isZeroCopy() && yBinding.isZeroCopy() && outBinding.isZeroCopy();
+    return true;
+}
+
+static int CheckOutput(const char* label, const std::vector<float>& output, const std::vector<float>& reference)
+{
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        if (output[i] != reference[i])
+        {
+            printf("    ERROR: %s out[%zu] is %f, expected %f\n", label, i, output[i], reference[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int RunTensorBenchmark(int argc, char** argv)
+{
+    const uint32_t requestedCount = argc > 1 ? uint32_t(atoi(argv[1])) : c_defaultElementCount;
+    const int threadCount = argc > 2 ? atoi(argv[2]) : 0;
+    const uint32_t rowCount = (requestedCount + c_columnCount - 1) / c_columnCount;
+    const uint32_t elementCount = rowCount * c_columnCount;
+    if (!rowCount)
+    {
+        printf("Element count must be at least 1.\n");
+        return 1;
+    }
+
+    // Small integers keep every result exact, so all paths must match the reference bit for bit
+    std::vector<float> xData(elementCount), yData(elementCount), xTransposed(elementCount);
+    std::vector<float> reference(elementCount);
+    for (uint32_t i = 0; i < elementCount; i++)
+    {
+        xData[i] = float(i % 509);
+        yData[i] = float(i % 7) - 3.0f;
+        const float value = xData[i] * c_scale + c_bias;
+        reference[i] = (value > 0.0f ? value : 0.0f) * yData[i];
+    }
+    for (uint32_t row = 0; row < rowCount; row++)
+    {
+        for (uint32_t col = 0; col < c_columnCount; col++)
+            xTransposed[size_t(col) * rowCount + row] = xData[size_t(row) * c_columnCount + col];
+    }
+
+    const int64_t sizes[2] = { int64_t(rowCount), int64_t(c_columnCount) };
+    std::vector<float> output(elementCount);
+    const HostTensor x = HostTensor::contiguous(xData.data(), TensorScalarType::Float32, 2, sizes);
+    const HostTensor y = HostTensor::contiguous(yData.data(), TensorScalarType::Float32, 2, sizes);
+    const HostTensor out = HostTensor::contiguous(output.data(), TensorScalarType::Float32, 2, sizes);
+    HostTensor xStrided = HostTensor::contiguous(xTransposed.data(), TensorScalarType::Float32, 2, sizes);
+    xStrided.strides[0] = 1;
+    xStrided.strides[1] = int64_t(rowCount);
+
+    CPUDispatcher dispatcher(threadCount);
+    printf("CPU TensorView kernels: out = relu(x * scale + bias) * y over [%u, %u] floats, %i worker threads, best of %i runs\n\n",
+        rowCount, c_columnCount, dispatcher.getThreadCount(), c_repeatCount);
+
+    int failures = 0;
+
+    std::vector<float> eagerOutput;
+    double ms = TimeBestMs(c_repeatCount, [&]()
+    {
+        std::vector<float> scaled = RunEagerOp(dispatcher, EagerOp_MulScalar, xData, nullptr, c_scale);
+        std::vector<float> biased = RunEagerOp(dispatcher, EagerOp_AddScalar, scaled, nullptr, c_bias);
+        std::vector<float> relu = RunEagerOp(dispatcher, EagerOp_Relu, biased, nullptr, 0.0f);
+        eagerOutput = RunEagerOp(dispatcher, EagerOp_Mul, relu, yData.data(), 0.0f);
+    });
+    PrintBenchResult("eager, 4 ops and 4 allocations", ms, double(elementCount), "elements");
+    failures += CheckOutput("eager", eagerOutput, reference);
+
+    struct FusedCase
+    {
+        const char*         label;
+        const HostTensor*   x;
+        bool                expectZeroCopy;
+    };
+    const FusedCase fusedCases[] =
+    {
+        { "fused TensorView, contiguous", &x, true },
+        { "fused TensorView, x transposed", &xStrided, false },
+    };
+    for (const FusedCase& fusedCase : fusedCases)
+    {
+        std::fill(output.begin(), output.end(), 0.0f);
+        bool ok = true;
+        bool zeroCopy = false;
+        ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            ok = ok && RunFused(dispatcher, *fusedCase.x, y, out, zeroCopy);
+        });
+        if (!ok)
+        {
+            failures++;
+            continue;
+        }
+        PrintBenchResult(fusedCase.label, ms, double(elementCount), "elements");
+        if (zeroCopy != fusedCase.expectZeroCopy)
+        {
+            printf("    ERROR: %s was bound %s, expected %s\n", fusedCase.label, zeroCopy ? "zero copy" : "with a staging copy", fusedCase.expectZeroCopy ? "zero copy" : "a staging copy");
+            failures++;
+        }
+        failures += CheckOutput(fusedCase.label, output, reference);
+    }
+
+    return failures ? 1 : 0;
+}
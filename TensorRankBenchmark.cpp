@@ -0,0 +1,256 @@
+// Benchmarks CPUTensorViewN (CPUTensor.h) on a 6 dimensional tensor, beyond what the prelude's TensorView holds:
+// out = x * scale + bias with every element addressed through the full 6D index math, against the same kernel on
+// views whose dimensions CollapseTensorDimensions() merged first, where a group steps through memory with one stride.
+// Also checks that tensors over 4 GB are refused by the 32 bit CPUTensorView and addressed correctly by the 64 bit one.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "CPUDispatcher.h"
+#include "CPUTensor.h"
+#include "RunModes.h"
+
+static const uint32_t   c_threadsPerGroup       = 64;
+static const int        c_rank                  = 6;
+static const int64_t    c_outerSizes[c_rank - 1] = { 2, 3, 4, 5, 6 };
+static const int64_t    c_outerCount            = 2 * 3 * 4 * 5 * 6;
+static const uint32_t   c_defaultElementCount   = 1 << 22;
+static const int64_t    c_rowPadding            = 8;        // extra elements per row of the padded x
+static const int        c_repeatCount           = 5;
+static const float      c_scale                 = 1.5f;
+static const float      c_bias                  = 0.25f;
+
+struct IndexedKernelParams
+{
+    CPUTensorViewN<c_rank>  x;
+    CPUTensorViewN<c_rank>  out;
+    uint64_t                elementCount;
+};
+
+struct CollapsedKernelParams
+{
+    CPUTensorViewN<2>       x;
+    CPUTensorViewN<2>       out;
+    uint64_t                elementCount;
+};
+
+// One thread per element, each turning its flat index into 6 indices and those into an offset per tensor
+static void IndexedKernel(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    const IndexedKernelParams* params = (const IndexedKernelParams*)uniformEntryPointParams;
+    for (uint32_t groupX = varyingInput->startGroupID.x; groupX < varyingInput->endGroupID.x; groupX++)
+    {
+        for (uint32_t threadX = 0; threadX < c_threadsPerGroup; threadX++)
+        {
+            uint64_t flat = uint64_t(groupX) * c_threadsPerGroup + threadX;
+            if (flat >= params->elementCount)
+                break;
+            uint64_t index[c_rank];
+            for (int i = c_rank - 1; i >= 0; i--)
+            {
+                index[i] = flat % params->x.sizes[i];
+                flat /= params->x.sizes[i];
+            }
+            const float value = params->x.load<float>(index[0], index[1], index[2], index[3], index[4], index[5]);
+            params->out.store<float>(value * c_scale + c_bias, index[0], index[1], index[2], index[3], index[4], index[5]);
+        }
+    }
+}
+
+// The group finds its first element once, then steps each tensor by its inner stride, moving to the next row
+// (the outer dimension) when one ends
+static void CollapsedKernel(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    const CollapsedKernelParams* params = (const CollapsedKernelParams*)uniformEntryPointParams;
+    const CPUTensorViewN<2>& x = params->x;
+    const CPUTensorViewN<2>& out = params->out;
+    const uint64_t rowLength = x.sizes[1];
+    for (uint32_t groupX = varyingInput->startGroupID.x; groupX < varyingInput->endGroupID.x; groupX++)
+    {
+        const uint64_t first = uint64_t(groupX) * c_threadsPerGroup;
+        if (first >= params->elementCount)
+            continue;
+        const uint64_t end = first + c_threadsPerGroup < params->elementCount ? first + c_threadsPerGroup : params->elementCount;
+
+        uint64_t row = first / rowLength;
+        uint64_t col = first % rowLength;
+        const uint8_t* src = x.data + x.getOffset(row, col);
+        uint8_t* dst = out.data + out.getOffset(row, col);
+        for (uint64_t element = first; element < end; element++)
+        {
+            *(float*)dst = *(const float*)src * c_scale + c_bias;
+            src += x.strides[1];
+            dst += out.strides[1];
+            if (++col == rowLength)
+            {
+                col = 0;
+                row++;
+                src = x.data + x.getOffset(row, col);
+                dst = out.data + out.getOffset(row, col);
+            }
+        }
+    }
+}
+
+static uint3 GroupCountFor(uint64_t elementCount)
+{
+    return uint3(uint32_t((elementCount + c_threadsPerGroup - 1) / c_threadsPerGroup), 1, 1);
+}
+
+static int CheckOutput(const char* label, const std::vector<float>& output, const std::vector<float>& reference)
+{
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        if (output[i] != reference[i])
+        {
+            printf("    ERROR: %s out[%zu] is %f, expected %f\n", label, i, output[i], reference[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/// Tensors over 4 GB must be refused by CPUTensorView and addressed exactly by CPUTensorViewN. Nothing is read.
+static int CheckLargeTensor()
+{
+    float placeholder = 0.0f;
+    const int64_t sizes[2] = { 4, int64_t(1) << 30 };     // 16 GB of floats
+    const HostTensor large = HostTensor::contiguous(&placeholder, TensorScalarType::Float32, 2, sizes);
+
+    int failures = 0;
+    std::string error;
+    CPUTensorBinding binding;
+    if (binding.bind(large, TensorScalarType::Float32, "large", error))
+    {
+        printf("    ERROR: a 16 GB tensor was bound with 32 bit strides\n");
+        failures++;
+    }
+
+    CPUTensorViewN<2> view;
+    if (!MakeTensorViewN(large, TensorScalarType::Float32, "large", view, error))
+    {
+        printf("    ERROR: %s\n", error.c_str());
+        return failures + 1;
+    }
+    const int64_t offset = view.getOffset(3, sizes[1] - 1);
+    const int64_t expected = (3 * sizes[1] + sizes[1] - 1) * int64_t(sizeof(float));
+    if (offset != expected)
+    {
+        printf("    ERROR: the last element of a 16 GB tensor is at byte %lld, expected %lld\n", (long long)offset, (long long)expected);
+        failures++;
+    }
+    printf("    %-40s %s\n", "16 GB tensor, 32 bit view", binding.getView().data ? "bound" : "refused");
+    printf("    %-40s last element at byte %lld\n", "16 GB tensor, 64 bit view", (long long)offset);
+    return failures;
+}
+
+int RunTensorRankBenchmark(int argc, char** argv)
+{
+    const uint32_t requestedCount = argc > 1 ? uint32_t(atoi(argv[1])) : c_defaultElementCount;
+    const int threadCount = argc > 2 ? atoi(argv[2]) : 0;
+    const int64_t rowLength = (int64_t(requestedCount) + c_outerCount - 1) / c_outerCount;
+    const int64_t elementCount = rowLength * c_outerCount;
+    if (!rowLength)
+    {
+        printf("Element count must be at least 1.\n");
+        return 1;
+    }
+
+    int64_t sizes[c_rank];
+    for (int i = 0; i < c_rank - 1; i++)
+        sizes[i] = c_outerSizes[i];
+    sizes[c_rank - 1] = rowLength;
+
+    // x contiguous, and the same values in rows padded to a larger pitch
+    const size_t count = size_t(elementCount);
+    const size_t paddedCount = size_t(c_outerCount * (rowLength + c_rowPadding));
+    std::vector<float> xData(count), xPadded(paddedCount, -1.0f), reference(count), output(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        xData[i] = float(i % 1021);
+        xPadded[(i / size_t(rowLength)) * size_t(rowLength + c_rowPadding) + i % size_t(rowLength)] = xData[i];
+        reference[i] = xData[i] * c_scale + c_bias;
+    }
+
+    const HostTensor x = HostTensor::contiguous(xData.data(), TensorScalarType::Float32, c_rank, sizes);
+    const HostTensor out = HostTensor::contiguous(output.data(), TensorScalarType::Float32, c_rank, sizes);
+    HostTensor xPitched = HostTensor::contiguous(xPadded.data(), TensorScalarType::Float32, c_rank, sizes);
+    for (int i = c_rank - 2; i >= 0; i--)
+        xPitched.strides[i] = (i == c_rank - 2 ? rowLength + c_rowPadding : xPitched.strides[i + 1] * sizes[i + 1]);
+
+    CPUDispatcher dispatcher(threadCount);
+    printf("Rank %i TensorView: out = x * scale + bias over [2, 3, 4, 5, 6, %lld] floats, %i worker threads, best of %i runs\n\n",
+        c_rank, (long long)rowLength, dispatcher.getThreadCount(), c_repeatCount);
+
+    int failures = 0;
+    std::string error;
+
+    // The prelude layout can't hold 6 dimensions at all
+    CPUTensorBinding binding;
+    if (binding.bind(x, TensorScalarType::Float32, "x", error))
+    {
+        printf("    ERROR: a rank %i tensor was bound to the 5 dimension CPUTensorView\n", c_rank);
+        failures++;
+    }
+
+    IndexedKernelParams indexed = {};
+    if (!MakeTensorViewN(x, TensorScalarType::Float32, "x", indexed.x, error) ||
+        !MakeTensorViewN(out, TensorScalarType::Float32, "out", indexed.out, error))
+    {
+        printf("    ERROR: %s\n", error.c_str());
+        return 1;
+    }
+    indexed.elementCount = uint64_t(elementCount);
+    std::fill(output.begin(), output.end(), 0.0f);
+    double ms = TimeBestMs(c_repeatCount, [&]()
+    {
+        dispatcher.dispatch(IndexedKernel, GroupCountFor(indexed.elementCount), &indexed, nullptr);
+    });
+    PrintBenchResult("6D index math per element", ms, double(elementCount), "elements");
+    failures += CheckOutput("6D index math", output, reference);
+
+    struct CollapsedCase
+    {
+        const char*         label;
+        const HostTensor*   x;
+    };
+    const CollapsedCase collapsedCases[] =
+    {
+        { "collapsed, contiguous", &x },
+        { "collapsed, padded rows", &xPitched },
+    };
+    for (const CollapsedCase& collapsedCase : collapsedCases)
+    {
+        HostTensor tensors[2] = { *collapsedCase.x, out };
+        const int rank = CollapseTensorDimensions(tensors, 2);
+
+        CollapsedKernelParams collapsed = {};
+        if (!MakeTensorViewN(tensors[0], TensorScalarType::Float32, "x", collapsed.x, error) ||
+            !MakeTensorViewN(tensors[1], TensorScalarType::Float32, "out", collapsed.out, error))
+        {
+            printf("    ERROR: %s\n", error.c_str());
+            failures++;
+            continue;
+        }
+        collapsed.elementCount = uint64_t(elementCount);
+
+        std::fill(output.begin(), output.end(), 0.0f);
+        ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            dispatcher.dispatch(CollapsedKernel, GroupCountFor(collapsed.elementCount), &collapsed, nullptr);
+        });
+        const std::string label = std::string(collapsedCase.label) + " to rank " + std::to_string(rank);
+        PrintBenchResult(label.c_str(), ms, double(elementCount), "elements");
+        failures += CheckOutput(collapsedCase.label, output, reference);
+    }
+
+    printf("\n");
+    failures += CheckLargeTensor();
+
+    return failures ? 1 : 0;
+}
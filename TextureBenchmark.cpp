@@ -0,0 +1,288 @@
+// Benchmark for CPUTexture2D: texture heavy kernels over a large image, comparing storage layouts,
+// filters, per texel virtual calls against the batched SampleN entry point, and the virtual Texture2D
+// path against the devirtualized StaticTexture2D policies.
+//
+// Over a large image the rotate kernel is bound by memory: the rotated, minified footprint misses the cache on most
+// samples, on both paths alike, so removing the virtual call barely shows and the two trade places from run to run. It's
+// also timed sampling a mip small enough to stay in the cache (c_cachedLevel), where the cost of the call is what's left.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Bench.h"
+#include "StaticTexture.h"
+#include "StaticTextureKernels.h"
+#include "RunModes.h"
+
+static const int    c_defaultImageSize  = 2048;
+static const int    c_repeatCount       = 5;
+static const int    c_batchSize         = 64;
+static const float  c_cachedLevel       = 4.0f;     // 128x128 of a 2048x2048 image, 256 KB
+
+// Written the way the C++ target emits a kernel: one thread per output texel, resources passed as prelude types.
+// TEXTURE is Texture2D<float4> or a StaticTexture2D.
+template <typename TEXTURE>
+static void RotateKernel(TEXTURE source, SamplerState samplerState, RWStructuredBuffer<float4> dest, uint32_t size, float level, uint32_t x, uint32_t y)
+{
+    dest[size_t(y) * size + x] = source.SampleLevel(samplerState, RotateLocation(size, x, y), level);
+}
+
+// The same kernel, but a row of threads computes its coordinates first and samples them all with one call.
+static void RotateKernelBatched(Texture2D<float4> source, RWStructuredBuffer<float4> dest, uint32_t size, float level, uint32_t x, uint32_t y, uint32_t count)
+{
+    float2 locs[c_batchSize];
+    for (uint32_t i = 0; i < count; i++)
+        locs[i] = RotateLocation(size, x + i, y);
+    SampleN(source, locs, count, level, &dest[size_t(y) * size + x]);
+}
+
+// A 3x3 box blur through Texture2D::Load, walking the image column by column to stress the layout.
+template <typename TEXTURE>
+static void BlurKernel(TEXTURE source, RWStructuredBuffer<float4> dest, uint32_t size, uint32_t x, uint32_t y)
+{
+    float4 sum = float4(0.0f);
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            int3 loc = int3(int(x) + dx, int(y) + dy, 0);
+            float4 texel = source.Load(loc);
+            sum.x += texel.x; sum.y += texel.y; sum.z += texel.z; sum.w += texel.w;
+        }
+    }
+    dest[size_t(y) * size + x] = float4(sum.x / 9.0f, sum.y / 9.0f, sum.z / 9.0f, sum.w / 9.0f);
+}
+
+static double Checksum(const std::vector<float4>& data)
+{
+    double sum = 0.0;
+    for (const float4& value : data)
+        sum += double(value.x) + double(value.y) + double(value.z) + double(value.w);
+    return sum;
+}
+
+struct KernelRun
+{
+    uint32_t                    size;
+    float                       level;
+    RWStructuredBuffer<float4>  dest;
+    std::vector<float4>*        output;
+};
+
+static bool ChecksumsMatch(double checksum, double reference)
+{
+    return fabs(checksum - reference) <= 1e-6 * fabs(reference);
+}
+
+// Times one TEXTURE type on the rotate kernel at a mip level, returning the time and the checksum of its output.
+template <typename TEXTURE>
+static double TimeRotate(TEXTURE source, const KernelRun& run, float level, double& outChecksum)
+{
+    SamplerState samplerState = { nullptr };
+    const double ms = TimeBestMs(c_repeatCount, [&]()
+    {
+        for (uint32_t y = 0; y < run.size; y++)
+            for (uint32_t x = 0; x < run.size; x++)
+                RotateKernel(source, samplerState, run.dest, run.size, level, x, y);
+    });
+    outChecksum = Checksum(*run.output);
+    return ms;
+}
+
+// Times one TEXTURE type on both kernels, returning the rotate and blur times and the checksum of each one's output.
+template <typename TEXTURE>
+static void TimeKernels(TEXTURE source, const KernelRun& run, double& outRotateMs, double& outBlurMs, double& outRotateChecksum,
+    double& outBlurChecksum)
+{
+    outRotateMs = TimeRotate(source, run, run.level, outRotateChecksum);
+    outBlurMs = TimeBestMs(c_repeatCount, [&]()
+    {
+        for (uint32_t x = 0; x < run.size; x++)
+            for (uint32_t y = 0; y < run.size; y++)
+                BlurKernel(source, run.dest, run.size, x, y);
+    });
+    outBlurChecksum = Checksum(*run.output);
+}
+
+// Runs the kernels through StaticTexture2D with the policies matching the texture, side by side with Texture2D.
+template <typename LAYOUT, typename FILTER>
+static int CompareStaticTexture(CPUTexture2D& texture, const KernelRun& run)
+{
+    const double texelCount = double(run.size) * double(run.size);
+
+    StaticTexture2D<float4, LAYOUT, FILTER> staticSource = { &texture };
+    if (!staticSource.isCompatible())
+    {
+        printf("    ERROR: static texture policies do not match the texture\n");
+        return 1;
+    }
+
+    Texture2D<float4> virtualSource = { &texture };
+    double virtualRotateMs, virtualBlurMs, virtualRotateChecksum, virtualBlurChecksum;
+    TimeKernels(virtualSource, run, virtualRotateMs, virtualBlurMs, virtualRotateChecksum, virtualBlurChecksum);
+
+    double staticRotateMs, staticBlurMs, staticRotateChecksum, staticBlurChecksum;
+    TimeKernels(staticSource, run, staticRotateMs, staticBlurMs, staticRotateChecksum, staticBlurChecksum);
+
+    // The same from a mip that stays in the cache
+    double virtualCachedChecksum, staticCachedChecksum;
+    const double virtualCachedMs = TimeRotate(virtualSource, run, c_cachedLevel, virtualCachedChecksum);
+    const double staticCachedMs = TimeRotate(staticSource, run, c_cachedLevel, staticCachedChecksum);
+
+    PrintBenchResult("rotate, static policy", staticRotateMs, texelCount, "samples");
+    PrintBenchResult("3x3 blur, static policy", staticBlurMs, texelCount * 9.0, "loads");
+    PrintBenchResult("rotate from a cached mip, virtual", virtualCachedMs, texelCount, "samples");
+    PrintBenchResult("rotate from a cached mip, static", staticCachedMs, texelCount, "samples");
+    printf("    static vs virtual speedup: rotate %.2fx, rotate from a cached mip %.2fx, blur %.2fx\n",
+        virtualRotateMs / staticRotateMs, virtualCachedMs / staticCachedMs, virtualBlurMs / staticBlurMs);
+
+    int ret = 0;
+    if (!ChecksumsMatch(staticRotateChecksum, virtualRotateChecksum) || !ChecksumsMatch(staticCachedChecksum, virtualCachedChecksum))
+    {
+        printf("    ERROR: static rotate results do not match virtual results\n");
+        ret = 1;
+    }
+    if (!ChecksumsMatch(staticBlurChecksum, virtualBlurChecksum))
+    {
+        printf("    ERROR: static blur results do not match virtual results\n");
+        ret = 1;
+    }
+    return ret;
+}
+
+// Runs the rotate kernels built in StaticTexture.h's compile mode (StaticTextureKernels.h) on a texture bound the way
+// the host binds the prelude's Texture2D, checking them against the virtual path. The texture must have the default
+// policies: Morton tiled, bilinear, wrap.
+static int CheckStaticCompileMode(CPUTexture2D& texture, const KernelRun& run)
+{
+    Texture2D<float4> virtualSource = { &texture };
+    double virtualChecksum;
+    TimeRotate(virtualSource, run, run.level, virtualChecksum);
+
+    const RotateKernelParams params = { virtualSource, { nullptr }, run.dest, run.size, run.level };
+    struct Mode
+    {
+        const char*     label;
+        void            (*kernel)(const void* params, uint32_t x, uint32_t y);
+    };
+    static const Mode modes[] =
+    {
+        { "rotate, KernelTexture2D build", RotateKernelStaticMode },
+        { "rotate, replaced prelude build", RotateKernelReplacedPrelude },
+    };
+
+    int ret = 0;
+    for (const Mode& mode : modes)
+    {
+        const double ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            for (uint32_t y = 0; y < run.size; y++)
+                for (uint32_t x = 0; x < run.size; x++)
+                    mode.kernel(&params, x, y);
+        });
+        PrintBenchResult(mode.label, ms, double(run.size) * double(run.size), "samples");
+        if (!ChecksumsMatch(Checksum(*run.output), virtualChecksum))
+        {
+            printf("    ERROR: %s results do not match virtual results\n", mode.label);
+            ret = 1;
+        }
+    }
+    return ret;
+}
+
+int RunTextureBenchmark(int argc, char** argv)
+{
+    const uint32_t size = uint32_t(argc > 1 ? atoi(argv[1]) : c_defaultImageSize);
+    if (size < 8)
+    {
+        printf("Image size must be at least 8.\n");
+        return 1;
+    }
+
+    // A procedural image with enough high frequency detail that filtering matters
+    std::vector<float> image(size_t(size) * size * 4);
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            float* texel = &image[(size_t(y) * size + x) * 4];
+            texel[0] = float(x) / float(size);
+            texel[1] = float(y) / float(size);
+            texel[2] = ((x ^ y) & 8) ? 1.0f : 0.0f;
+            texel[3] = 1.0f;
+        }
+    }
+
+    struct Config
+    {
+        const char*     label;
+        TextureLayout   layout;
+        TextureFilter   filter;
+        float           level;
+        int             (*compareStatic)(CPUTexture2D& texture, const KernelRun& run);
+    };
+    static const Config configs[] =
+    {
+        { "linear   bilinear",  TextureLayout::Linear,      TextureFilter::Bilinear,  0.0f,  CompareStaticTexture<LinearLayoutPolicy, BilinearFilterPolicy> },
+        { "morton   bilinear",  TextureLayout::MortonTiled, TextureFilter::Bilinear,  0.0f,  CompareStaticTexture<MortonTiledLayoutPolicy, BilinearFilterPolicy> },
+        { "linear   trilinear", TextureLayout::Linear,      TextureFilter::Trilinear, 0.75f, CompareStaticTexture<LinearLayoutPolicy, TrilinearFilterPolicy> },
+        { "morton   trilinear", TextureLayout::MortonTiled, TextureFilter::Trilinear, 0.75f, CompareStaticTexture<MortonTiledLayoutPolicy, TrilinearFilterPolicy> },
+    };
+
+    printf("Texture benchmark: %ux%u float4, best of %i runs\n", size, size, c_repeatCount);
+
+    const double texelCount = double(size) * double(size);
+    std::vector<float4> output(size_t(size) * size);
+    RWStructuredBuffer<float4> dest = { output.data(), output.size() };
+    SamplerState samplerState = { nullptr };
+
+    int ret = 0;
+    for (const Config& config : configs)
+    {
+        Timer buildTimer;
+        CPUTexture2D texture(size, size, 4, image.data(), config.layout, config.filter);
+        printf("\n  %s (%i mips, %.1f MB, built in %.1f ms)\n",
+            config.label, texture.getLevelCount(), texture.getSizeInBytes() / (1024.0 * 1024.0), buildTimer.elapsedMs());
+
+        Texture2D<float4> source = { &texture };
+
+        double ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            for (uint32_t y = 0; y < size; y++)
+                for (uint32_t x = 0; x < size; x++)
+                    RotateKernel(source, samplerState, dest, size, config.level, x, y);
+        });
+        PrintBenchResult("rotate, SampleLevel per texel", ms, texelCount, "samples");
+        const double perTexelChecksum = Checksum(output);
+
+        ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            for (uint32_t y = 0; y < size; y++)
+                for (uint32_t x = 0; x < size; x += c_batchSize)
+                    RotateKernelBatched(source, dest, size, config.level, x, y, (size - x) < uint32_t(c_batchSize) ? (size - x) : uint32_t(c_batchSize));
+        });
+        PrintBenchResult("rotate, SampleN batched", ms, texelCount, "samples");
+
+        if (!ChecksumsMatch(Checksum(output), perTexelChecksum))
+        {
+            printf("    ERROR: batched results do not match per texel results\n");
+            ret = 1;
+        }
+
+        ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            for (uint32_t x = 0; x < size; x++)
+                for (uint32_t y = 0; y < size; y++)
+                    BlurKernel(source, dest, size, x, y);
+        });
+        PrintBenchResult("3x3 blur, Load, column order", ms, texelCount * 9.0, "loads");
+
+        KernelRun run = { size, config.level, dest, &output };
+        ret |= config.compareStatic(texture, run);
+        if (config.layout == TextureLayout::MortonTiled && config.filter == TextureFilter::Bilinear)
+            ret |= CheckStaticCompileMode(texture, run);
+    }
+
+    return ret;
+}
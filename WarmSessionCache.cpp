@@ -0,0 +1,270 @@
+#include "WarmSessionCache.h"
+
+#include <iterator>
+#include <stdio.h>
+#include <string.h>
+
+#include "SlangHelpers.h"
+#include "StringBlob.h"
+
+using Slang::ComPtr;
+
+static const char* c_searchPaths[] = { "." };
+
+static std::string MakeSessionKey(const WarmCompileDesc& desc)
+{
+    std::string key = std::to_string(int(desc.target)) + " " + desc.profile;
+    for (const auto& define : desc.defines)
+        key += " " + define.first + "=" + define.second;
+    return key;
+}
+
+WarmSessionCache::WarmSessionCache(uint64_t budgetBytes)
+    : m_budgetBytes(budgetBytes)
+{
+}
+
+WarmSessionCache::~WarmSessionCache()
+{
+    // Modules, layouts and sessions all go before the global session
+    m_sessionsByKey.clear();
+    m_sessions.clear();
+}
+
+MemoryFootprint WarmSessionCache::getFootprint()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MemoryFootprint footprint = m_footprint;
+    footprint.processBytes = GetProcessMemoryBytes();
+    return footprint;
+}
+
+int WarmSessionCache::getSessionCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return int(m_sessions.size());
+}
+
+int WarmSessionCache::getEvictedSessionCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_evictedSessionCount;
+}
+
+bool WarmSessionCache::evictLeastRecentlyUsed()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_sessions.empty())
+        return false;
+    _evict(std::prev(m_sessions.end()));
+    return true;
+}
+
+void WarmSessionCache::_evict(SessionList::iterator session)
+{
+    for (auto& module : session->modules)
+    {
+        for (auto& code : module.second.code)
+        {
+            m_footprint.remove(MemoryCategory::Blob, code.second.code ? code.second.code->getBufferSize() : 0);
+            if (code.second.linked)
+                m_footprint.remove(MemoryCategory::Reflection, code.second.reflectionBytes);
+        }
+        m_footprint.remove(MemoryCategory::Module, module.second.bytes);
+    }
+    m_footprint.remove(MemoryCategory::Session, session->bytes);
+
+    m_sessionsByKey.erase(session->key);
+    m_sessions.erase(session);
+    m_evictedSessionCount++;
+}
+
+uint64_t WarmSessionCache::_estimateBytes(const std::string& key, const MemoryScope& scope)
+{
+    // Once the heap has freed memory to reuse, creating the same thing again barely grows the process, so the first
+    // measurement stands for every later one
+    auto found = m_estimatedBytes.find(key);
+    if (found != m_estimatedBytes.end())
+        return found->second;
+    const uint64_t bytes = scope.getGrowthBytes();
+    m_estimatedBytes[key] = bytes;
+    return bytes;
+}
+
+void WarmSessionCache::_enforceBudget(SessionList::iterator keep)
+{
+    if (!m_budgetBytes)
+        return;
+    while (m_footprint.getTotalBytes() > m_budgetBytes && m_sessions.size() > 1)
+    {
+        SessionList::iterator oldest = std::prev(m_sessions.end());
+        if (oldest == keep)
+            break;
+        _evict(oldest);
+    }
+}
+
+WarmSessionCache::SessionList::iterator WarmSessionCache::_getSession(const WarmCompileDesc& desc, WarmCompileResult& outResult)
+{
+    const std::string key = MakeSessionKey(desc);
+    auto found = m_sessionsByKey.find(key);
+    if (found != m_sessionsByKey.end())
+    {
+        outResult.sessionHit = true;
+        m_sessions.splice(m_sessions.begin(), m_sessions, found->second);
+        return found->second;
+    }
+
+    if (!m_globalSession)
+    {
+        MemoryScope scope;
+        if (SLANG_FAILED(slang_createGlobalSession(SLANG_API_VERSION, m_globalSession.writeRef())))
+        {
+            outResult.diagnostics += "Could not create a slang global session.\n";
+            return m_sessions.end();
+        }
+        m_footprint.add(MemoryCategory::GlobalSession, scope.getGrowthBytes());
+    }
+
+    std::vector<slang::PreprocessorMacroDesc> macros;
+    for (const auto& define : desc.defines)
+        macros.push_back({ define.first.c_str(), define.second.c_str() });
+
+    slang::TargetDesc targetDesc;
+    targetDesc.format = desc.target;
+    targetDesc.profile = m_globalSession->findProfile(desc.profile.c_str());
+
+    slang::SessionDesc sessionDesc;
+    sessionDesc.targets = &targetDesc;
+    sessionDesc.targetCount = 1;
+    sessionDesc.searchPaths = c_searchPaths;
+    sessionDesc.searchPathCount = SlangInt(sizeof(c_searchPaths) / sizeof(c_searchPaths[0]));
+    sessionDesc.preprocessorMacros = macros.data();
+    sessionDesc.preprocessorMacroCount = SlangInt(macros.size());
+
+    SessionEntry entry;
+    entry.key = key;
+    MemoryScope scope;
+    if (SLANG_FAILED(m_globalSession->createSession(sessionDesc, entry.session.writeRef())))
+    {
+        outResult.diagnostics += "Could not create a slang session.\n";
+        return m_sessions.end();
+    }
+    entry.bytes = _estimateBytes("session " + key, scope);
+    m_footprint.add(MemoryCategory::Session, entry.bytes);
+
+    m_sessions.push_front(std::move(entry));
+    m_sessionsByKey[key] = m_sessions.begin();
+    return m_sessions.begin();
+}
+
+SlangResult WarmSessionCache::compile(const WarmCompileDesc& desc, WarmCompileResult& outResult)
+{
+    outResult = WarmCompileResult();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    SessionList::iterator session = _getSession(desc, outResult);
+    if (session == m_sessions.end())
+        return SLANG_FAIL;
+
+    // Modules stay in the session, so one whose source changed is loaded again under a new name
+    const std::string moduleKey = desc.moduleName + " " + HashSource(desc.source);
+    ModuleEntry& module = session->modules[moduleKey];
+    outResult.moduleHit = module.module != nullptr;
+    if (!module.module)
+    {
+        const std::string uniqueName = desc.moduleName + "_" + std::to_string(m_nextModuleId++);
+        const std::string path = desc.moduleName + ".slang";
+        ComPtr<ISlangBlob> source = StringBlob::createCopy(desc.source.c_str());
+        ComPtr<ISlangBlob> diagnostics;
+
+        MemoryScope scope;
+        module.module = session->session->loadModuleFromSource(uniqueName.c_str(), path.c_str(), source, diagnostics.writeRef());
+        AppendDiagnostics(outResult.diagnostics, diagnostics);
+        if (!module.module)
+        {
+            session->modules.erase(moduleKey);
+            return SLANG_FAIL;
+        }
+        module.bytes = _estimateBytes("module " + session->key + " " + moduleKey, scope);
+        m_footprint.add(MemoryCategory::Module, module.bytes);
+    }
+
+    auto found = module.code.find(desc.entryPointName);
+    if (found != module.code.end() && (!desc.reflect || found->second.linked))
+    {
+        outResult.codeHit = true;
+        outResult.code = found->second.code;
+        outResult.layout = found->second.linked ? found->second.linked->getLayout() : nullptr;
+        return SLANG_OK;
+    }
+
+    ComPtr<slang::IEntryPoint> entryPoint;
+    if (SLANG_FAILED(module.module->findEntryPointByName(desc.entryPointName.c_str(), entryPoint.writeRef())))
+    {
+        outResult.diagnostics += "No entry point named " + desc.entryPointName + ".\n";
+        return SLANG_E_NOT_FOUND;
+    }
+
+    // What linking and code generation keep lives in the session
+    const std::string codeKey = session->key + " " + moduleKey + " " + desc.entryPointName;
+    MemoryScope scope;
+    slang::IComponentType* components[] = { module.module, entryPoint };
+    ComPtr<slang::IComponentType> composite;
+    ComPtr<slang::IComponentType> linked;
+    ComPtr<ISlangBlob> diagnostics;
+    SlangResult result = session->session->createCompositeComponentType(components, 2, composite.writeRef(), diagnostics.writeRef());
+    AppendDiagnostics(outResult.diagnostics, diagnostics);
+    if (SLANG_SUCCEEDED(result))
+    {
+        result = composite->link(linked.writeRef(), diagnostics.writeRef());
+        AppendDiagnostics(outResult.diagnostics, diagnostics);
+    }
+
+    // The layout is built on first use, and code generation would build it, so it's measured before generating code
+    uint64_t reflectionBytes = 0;
+    if (SLANG_SUCCEEDED(result) && desc.reflect)
+    {
+        MemoryScope reflectionScope;
+        outResult.layout = linked->getLayout();
+        reflectionBytes = _estimateBytes("reflection " + codeKey, reflectionScope);
+    }
+
+    ComPtr<ISlangBlob> code;
+    if (SLANG_SUCCEEDED(result))
+    {
+        result = linked->getEntryPointCode(0, 0, code.writeRef(), diagnostics.writeRef());
+        AppendDiagnostics(outResult.diagnostics, diagnostics);
+    }
+    if (SLANG_FAILED(result))
+    {
+        outResult.layout = nullptr;
+        return result;
+    }
+
+    // The growth less the layout and the code, which are counted on their own
+    const uint64_t codeBytes = code->getBufferSize();
+    const uint64_t growthBytes = _estimateBytes("code " + codeKey, scope);
+    const uint64_t keptBytes = growthBytes > codeBytes + reflectionBytes ? growthBytes - codeBytes - reflectionBytes : 0;
+    session->bytes += keptBytes;
+    m_footprint.bytes[int(MemoryCategory::Session)] += keptBytes;
+
+    CodeEntry& entry = module.code[desc.entryPointName];
+    if (entry.code)
+        m_footprint.remove(MemoryCategory::Blob, entry.code->getBufferSize());
+    entry.code = code;
+    m_footprint.add(MemoryCategory::Blob, codeBytes);
+
+    if (desc.reflect)
+    {
+        if (entry.linked)
+            m_footprint.remove(MemoryCategory::Reflection, entry.reflectionBytes);
+        entry.linked = linked;
+        entry.reflectionBytes = reflectionBytes;
+        m_footprint.add(MemoryCategory::Reflection, entry.reflectionBytes);
+    }
+
+    outResult.code = code;
+    _enforceBudget(session);
+    return SLANG_OK;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+// Keeps slang sessions, the modules loaded into them and their compiled output warm for a long running compile
+// service, inside a memory budget.
+//
+// Compiles are grouped into sessions by target, profile and preprocessor defines. A session keeps every module loaded
+// into it (keyed by name and a hash of the source), and each compiled entry point's code is kept too, so compiling the
+// same thing again is a lookup. All of it is attributed to the global session, sessions, modules, reflection and
+// output blobs with MemoryAccounting (MemoryAccounting.h), and getFootprint() reports it. Each object's bytes are
+// measured the first time that session configuration, module or entry point is created, and the same estimate is used
+// whenever it's created again after an eviction, as by then the process reuses freed heap and hardly grows.
+//
+// With a budget, after every compile the least recently used sessions are evicted, with everything loaded into them,
+// until the accounted total, which includes the global session, fits. The budget applies to those estimates, not to
+// the process's real memory, which compare with getFootprint()'s processBytes. The session just used is never evicted,
+// so one session larger than the budget stays.
+//
+// A slang global session must only be used by one thread at a time, and the memory measurements must not overlap, so
+// compile() holds a lock throughout.
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "slang/slang.h"
+#include "slang/slang-com-ptr.h"
+
+#include "MemoryAccounting.h"
+
+struct WarmCompileDesc
+{
+    std::string                                         moduleName;
+    std::string                                         source;
+    std::string                                         entryPointName = "csmain";
+    SlangCompileTarget                                  target = SLANG_HLSL;
+    std::string                                         profile = "cs_5_1";
+    std::vector<std::pair<std::string, std::string>>    defines;            ///< Part of the session's identity
+    bool                                                reflect = false;    ///< Also get the program's layout
+};
+
+struct WarmCompileResult
+{
+    Slang::ComPtr<ISlangBlob>       code;
+    slang::ProgramLayout*           layout = nullptr;   ///< If reflecting. Valid until the session is evicted.
+    std::string                     diagnostics;
+    bool                            sessionHit = false;
+    bool                            moduleHit = false;
+    bool                            codeHit = false;
+};
+
+class WarmSessionCache
+{
+public:
+    /// A budgetBytes of 0 means no budget
+    explicit WarmSessionCache(uint64_t budgetBytes);
+    ~WarmSessionCache();
+
+    WarmSessionCache(const WarmSessionCache&) = delete;
+    WarmSessionCache& operator=(const WarmSessionCache&) = delete;
+
+    SlangResult compile(const WarmCompileDesc& desc, WarmCompileResult& outResult);
+
+    MemoryFootprint getFootprint();
+    int getSessionCount();
+    int getEvictedSessionCount();
+
+    /// Evicts the least recently used session. False if there are none.
+    bool evictLeastRecentlyUsed();
+
+    uint64_t getBudgetBytes() const { return m_budgetBytes; }
+
+protected:
+    struct CodeEntry
+    {
+        Slang::ComPtr<slang::IComponentType>    linked;             ///< Kept if reflecting, as it owns the layout
+        Slang::ComPtr<ISlangBlob>               code;
+        uint64_t                                reflectionBytes = 0;
+    };
+
+    struct ModuleEntry
+    {
+        slang::IModule*                         module = nullptr;   ///< Owned by the session
+        uint64_t                                bytes = 0;
+        std::map<std::string, CodeEntry>        code;               ///< By entry point name
+    };
+
+    struct SessionEntry
+    {
+        std::string                             key;
+        Slang::ComPtr<slang::ISession>          session;
+        uint64_t                                bytes = 0;          ///< Creating it, and what linking and code generation kept
+        std::map<std::string, ModuleEntry>      modules;            ///< By name and source hash
+    };
+
+    typedef std::list<SessionEntry> SessionList;
+
+    SessionList::iterator _getSession(const WarmCompileDesc& desc, WarmCompileResult& outResult);
+    void _evict(SessionList::iterator session);
+    void _enforceBudget(SessionList::iterator keep);
+    uint64_t _estimateBytes(const std::string& key, const MemoryScope& scope);
+
+    uint64_t                                            m_budgetBytes;
+    std::mutex                                          m_mutex;
+    Slang::ComPtr<slang::IGlobalSession>                m_globalSession;
+    SessionList                                         m_sessions;         ///< Most recently used first
+    std::map<std::string, SessionList::iterator>        m_sessionsByKey;
+    MemoryFootprint                                     m_footprint;
+    std::map<std::string, uint64_t>                     m_estimatedBytes;   ///< First measurement of each object, by what created it
+    int                                                 m_evictedSessionCount = 0;
+    int                                                 m_nextModuleId = 0;
+};
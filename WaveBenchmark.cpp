@@ -0,0 +1,298 @@
+// Checks and benchmarks the lane batched wave intrinsics (WaveIntrinsics.h).
+//
+// First every wave op is compared against a plain per lane loop on random values and random active masks.
+// Then two reduction heavy kernels run on CPUDispatcher, written both the way a kernel without wave ops has to be
+// (one atomic per thread) and with wave ops (one atomic per wave).
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "Bench.h"
+#include "CPUDispatcher.h"
+#include "RunModes.h"
+#include "WaveIntrinsics.h"
+
+static const uint32_t   c_defaultElementCount   = 1 << 22;
+static const uint32_t   c_threadsPerGroup       = 256;
+static const uint32_t   c_compactThreshold      = 700;      // keep values >= this, out of [0, 1000)
+static const int        c_repeatCount           = 5;
+
+// ----------------------------- Correctness -----------------------------------------
+
+static int CheckWaveOps()
+{
+    int failures = 0;
+    srand(1234);
+    for (int iteration = 0; iteration < 1000; iteration++)
+    {
+        Wave wave;
+        wave.firstThreadIndex = 0;
+        // Every 50th iteration has no active lanes, which every op must handle
+        wave.activeMask = (iteration % 50) == 1 ? 0 : WaveMask(rand()) & _waveFullMask();
+
+        // Every fourth iteration has uniform values, so AllTrue and AllEqual see both answers
+        const bool uniform = (iteration % 4) == 0;
+        WaveValue<uint32_t> uintValue;
+        WaveValue<float> floatValue;
+        WaveValue<bool> boolValue;
+        WaveValue<uint32_t> smallValue;
+        WaveValue<int> sourceLane;
+        for (int i = 0; i < kWaveLaneCount; i++)
+        {
+            uintValue[i] = uint32_t(rand() % 1000);
+            floatValue[i] = float(rand() % 1000) * 0.25f;
+            boolValue[i] = uniform || (rand() & 1) != 0;
+            smallValue[i] = uniform ? 3u : uint32_t(rand() % 2 + 1);
+            sourceLane[i] = rand() % kWaveLaneCount;
+        }
+        const int readLane = rand() % kWaveLaneCount;
+
+        // Plain per lane references. Products wrap at 32 bits the same way in any order. With no active lanes, min, max
+        // and the first lane's value are 0.
+        uint32_t uintSum = 0, uintMin = ~0u, uintMax = 0, uintOr = 0, uintAnd = ~0u, uintXor = 0, uintProduct = 1, countBits = 0;
+        float floatSum = 0.0f;
+        bool allTrue = true, allEqual = true;
+        WaveMask ballot = 0;
+        const int firstLane = _waveFirstLane(wave.activeMask);
+        WaveValue<uint32_t> uintPrefix;
+        WaveValue<float> floatPrefix;
+        WaveValue<uint32_t> prefixCountBits;
+        WaveValue<uint32_t> prefixProduct;
+        for (int i = 0; i < kWaveLaneCount; i++)
+        {
+            uintPrefix[i] = uintSum;
+            floatPrefix[i] = floatSum;
+            prefixCountBits[i] = countBits;
+            prefixProduct[i] = uintProduct;
+            if (!wave.isLaneActive(i))
+                continue;
+            uintSum += uintValue[i];
+            floatSum += floatValue[i];
+            uintMin = uintValue[i] < uintMin ? uintValue[i] : uintMin;
+            uintMax = uintValue[i] > uintMax ? uintValue[i] : uintMax;
+            uintOr |= uintValue[i];
+            uintAnd &= uintValue[i];
+            uintXor ^= uintValue[i];
+            uintProduct *= smallValue[i];
+            countBits += boolValue[i] ? 1 : 0;
+            ballot |= boolValue[i] ? WaveMask(1) << i : 0;
+            allTrue = allTrue && boolValue[i];
+            allEqual = allEqual && smallValue[i] == smallValue[firstLane];
+        }
+
+        // Values are multiples of 0.25 well inside float precision, so float sums are exact in any order
+        bool ok = WaveActiveSum(wave, uintValue) == uintSum &&
+            WaveActiveSum(wave, floatValue) == floatSum &&
+            WaveActiveMin(wave, uintValue) == (wave.activeMask ? uintMin : 0u) &&
+            WaveActiveMax(wave, uintValue) == uintMax &&
+            WaveActiveBitOr(wave, uintValue) == uintOr &&
+            WaveActiveBitAnd(wave, uintValue) == uintAnd &&
+            WaveActiveBitXor(wave, uintValue) == uintXor &&
+            WaveActiveProduct(wave, smallValue) == uintProduct &&
+            WaveActiveBallot(wave, boolValue) == ballot &&
+            WaveActiveCountBits(wave, boolValue) == countBits &&
+            WaveActiveAnyTrue(wave, boolValue) == (countBits != 0) &&
+            WaveActiveAllTrue(wave, boolValue) == allTrue &&
+            WaveActiveAllEqual(wave, smallValue) == allEqual &&
+            WaveReadLaneFirst(wave, uintValue) == (wave.activeMask ? uintValue[firstLane] : 0u) &&
+            WaveReadLaneAt(wave, uintValue, readLane) == uintValue[readLane];
+
+        const WaveValue<uint32_t> uintPrefixResult = WavePrefixSum(wave, uintValue);
+        const WaveValue<float> floatPrefixResult = WavePrefixSum(wave, floatValue);
+        const WaveValue<uint32_t> prefixCountBitsResult = WavePrefixCountBits(wave, boolValue);
+        const WaveValue<uint32_t> prefixProductResult = WavePrefixProduct(wave, smallValue);
+        const WaveValue<uint32_t> shuffleResult = WaveShuffle(wave, uintValue, sourceLane);
+        const WaveValue<bool> isFirstLaneResult = WaveIsFirstLane(wave);
+        const WaveValue<uint32_t> laneIndexResult = WaveGetLaneIndex(wave);
+        ok = ok && WaveGetLaneCount(wave) == uint32_t(kWaveLaneCount);
+        for (int i = 0; i < kWaveLaneCount; i++)
+        {
+            if (!wave.isLaneActive(i))
+                continue;
+            ok = ok && uintPrefixResult[i] == uintPrefix[i] &&
+                floatPrefixResult[i] == floatPrefix[i] &&
+                prefixCountBitsResult[i] == prefixCountBits[i] &&
+                prefixProductResult[i] == prefixProduct[i] &&
+                shuffleResult[i] == uintValue[sourceLane[i]] &&
+                isFirstLaneResult[i] == (i == firstLane) &&
+                laneIndexResult[i] == uint32_t(i);
+        }
+
+        if (!ok)
+        {
+            if (failures == 0)
+                printf("ERROR: wave ops disagree with the per lane reference (mask 0x%x)\n", wave.activeMask);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+// ----------------------------- Kernels -----------------------------------------
+
+struct WaveKernelParams
+{
+    StructuredBuffer<uint32_t>  input;
+    RWStructuredBuffer<uint32_t> compacted;
+    std::atomic<uint32_t>*      total;
+    std::atomic<uint32_t>*      compactedCount;
+};
+
+// Sum reduction without wave ops: every thread adds its element to the total
+static void SumKernelScalar(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    WaveKernelParams* params = (WaveKernelParams*)uniformEntryPointParams;
+    const uint32_t firstIndex = varyingInput->startGroupID.x * c_threadsPerGroup;
+    for (uint32_t threadX = 0; threadX < c_threadsPerGroup; threadX++)
+    {
+        const uint32_t index = firstIndex + threadX;
+        if (index < params->input.count)
+            params->total->fetch_add(params->input[index], std::memory_order_relaxed);
+    }
+}
+
+// Sum reduction with WaveActiveSum: the first lane of each wave adds the wave's sum
+static void SumKernelWave(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    WaveKernelParams* params = (WaveKernelParams*)uniformEntryPointParams;
+    const uint32_t firstIndex = varyingInput->startGroupID.x * c_threadsPerGroup;
+    RunWaves(c_threadsPerGroup, [&](Wave wave)
+    {
+        WaveValue<uint32_t> value;
+        for (int lane = 0; lane < kWaveLaneCount; lane++)
+        {
+            const uint32_t index = firstIndex + wave.firstThreadIndex + lane;
+            if (index >= params->input.count)
+                wave.activeMask &= ~(WaveMask(1) << lane);
+            value[lane] = wave.isLaneActive(lane) ? params->input[index] : 0;
+        }
+
+        const uint32_t sum = WaveActiveSum(wave, value);
+        params->total->fetch_add(sum, std::memory_order_relaxed);
+    });
+}
+
+// Stream compaction without wave ops: every kept element reserves its own output slot
+static void CompactKernelScalar(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    WaveKernelParams* params = (WaveKernelParams*)uniformEntryPointParams;
+    const uint32_t firstIndex = varyingInput->startGroupID.x * c_threadsPerGroup;
+    for (uint32_t threadX = 0; threadX < c_threadsPerGroup; threadX++)
+    {
+        const uint32_t index = firstIndex + threadX;
+        if (index < params->input.count && params->input[index] >= c_compactThreshold)
+        {
+            const uint32_t slot = params->compactedCount->fetch_add(1, std::memory_order_relaxed);
+            params->compacted[slot] = params->input[index];
+        }
+    }
+}
+
+// Stream compaction with wave ops: one reservation per wave, slots handed out with WavePrefixCountBits
+static void CompactKernelWave(ComputeVaryingInput* varyingInput, void* uniformEntryPointParams, void* uniformState)
+{
+    (void)uniformState;
+    WaveKernelParams* params = (WaveKernelParams*)uniformEntryPointParams;
+    const uint32_t firstIndex = varyingInput->startGroupID.x * c_threadsPerGroup;
+    RunWaves(c_threadsPerGroup, [&](Wave wave)
+    {
+        WaveValue<uint32_t> value;
+        WaveValue<bool> keep;
+        for (int lane = 0; lane < kWaveLaneCount; lane++)
+        {
+            const uint32_t index = firstIndex + wave.firstThreadIndex + lane;
+            if (index >= params->input.count)
+                wave.activeMask &= ~(WaveMask(1) << lane);
+            value[lane] = wave.isLaneActive(lane) ? params->input[index] : 0;
+            keep[lane] = value[lane] >= c_compactThreshold;
+        }
+
+        const uint32_t keepCount = WaveActiveCountBits(wave, keep);
+        if (!keepCount)
+            return;
+
+        const uint32_t base = params->compactedCount->fetch_add(keepCount, std::memory_order_relaxed);
+        const WaveValue<uint32_t> offset = WavePrefixCountBits(wave, keep);
+        for (int lane = 0; lane < kWaveLaneCount; lane++)
+        {
+            if (wave.isLaneActive(lane) && keep[lane])
+                params->compacted[base + offset[lane]] = value[lane];
+        }
+    });
+}
+
+int RunWaveBenchmark(int argc, char** argv)
+{
+    const uint32_t elementCount = uint32_t(argc > 1 ? atoi(argv[1]) : c_defaultElementCount);
+    const int threadCount = argc > 2 ? atoi(argv[2]) : 0;
+
+    printf("Wave intrinsics: %i lanes, %s\n", kWaveLaneCount, SLANG_TEST_WAVE_SSE ? "SSE sums" : "scalar sums");
+    int failures = CheckWaveOps();
+    printf("    op checks against per lane reference: %s\n", failures ? "FAILED" : "OK");
+
+    std::vector<uint32_t> input(elementCount);
+    uint64_t expectedSum = 0;
+    uint32_t expectedKept = 0;
+    for (uint32_t i = 0; i < elementCount; i++)
+    {
+        input[i] = uint32_t(rand() % 1000);
+        expectedSum += input[i];
+        expectedKept += input[i] >= c_compactThreshold ? 1 : 0;
+    }
+
+    std::vector<uint32_t> compacted(elementCount);
+    std::atomic<uint32_t> total(0);
+    std::atomic<uint32_t> compactedCount(0);
+    WaveKernelParams params =
+    {
+        { input.data(), input.size() },
+        { compacted.data(), compacted.size() },
+        &total,
+        &compactedCount,
+    };
+
+    CPUDispatcher dispatcher(threadCount);
+    const uint3 groupCount = uint3((elementCount + c_threadsPerGroup - 1) / c_threadsPerGroup, 1, 1);
+    printf("\n%u elements, %u groups of %u threads on %i worker threads, best of %i runs\n",
+        elementCount, groupCount.x, c_threadsPerGroup, dispatcher.getThreadCount(), c_repeatCount);
+
+    struct Kernel
+    {
+        const char*     label;
+        ComputeFunc     func;
+        bool            isCompaction;
+    };
+    static const Kernel kernels[] =
+    {
+        { "sum, atomic per thread",             SumKernelScalar,        false },
+        { "sum, WaveActiveSum",                 SumKernelWave,          false },
+        { "compact, atomic per thread",         CompactKernelScalar,    true },
+        { "compact, WavePrefixCountBits",       CompactKernelWave,      true },
+    };
+
+    for (const Kernel& kernel : kernels)
+    {
+        double ms = TimeBestMs(c_repeatCount, [&]()
+        {
+            total = 0;
+            compactedCount = 0;
+            dispatcher.dispatch(kernel.func, groupCount, &params, nullptr);
+        });
+        PrintBenchResult(kernel.label, ms, double(elementCount), "elements");
+
+        // Sums wrap at 32 bits like the uint the kernel accumulates into
+        const bool ok = kernel.isCompaction ? (compactedCount == expectedKept) : (total == uint32_t(expectedSum));
+        if (!ok)
+        {
+            printf("    ERROR: wrong result\n");
+            failures++;
+        }
+    }
+
+    return failures ? 1 : 0;
+}
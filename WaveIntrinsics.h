@@ -0,0 +1,443 @@
+#pragma once
+
+// Wave intrinsics for lane batched CPU kernels.
+//
+// The CPU prelude runs one thread at a time, so it has no WaveActiveSum, WavePrefixSum, WaveReadLaneAt and friends.
+// In lane batched mode a group's threads are instead run a wave at a time: a kernel is written once per wave and
+// holds each per thread value as a WaveValue<T>, one element per lane. The wave ops below then work across the
+// lanes of a WaveValue, with float/int sums and prefix sums done with SSE shuffles and horizontal adds.
+//
+// Lanes that are not active (past the end of the group, or switched off by the kernel) are excluded from reductions
+// and prefixes the same way as on the GPU. Names and semantics follow HLSL, see slang/docs/wave-intrinsics.md,
+// with the wave passed explicitly as the first argument.
+//
+// A wave may have no active lanes, if a kernel switches them all off. No lane would see the result of an op then, but
+// every op is still safe to call: reductions give the op's identity, and WaveActiveMin/Max and WaveReadLaneFirst give
+// T(). Ballots are empty, AllTrue and AllEqual are true, and no lane is the first.
+
+#include "CPUPrelude.h"
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#   define SLANG_TEST_WAVE_SSE 1
+#   include <emmintrin.h>
+#else
+#   define SLANG_TEST_WAVE_SSE 0
+#endif
+
+#ifndef SLANG_TEST_WAVE_LANE_COUNT
+#   define SLANG_TEST_WAVE_LANE_COUNT 8
+#endif
+
+static const int kWaveLaneCount = SLANG_TEST_WAVE_LANE_COUNT;
+static_assert(kWaveLaneCount >= 1 && kWaveLaneCount <= 32, "A WaveMask holds at most 32 lanes");
+
+typedef uint32_t WaveMask;
+
+/// One value per lane.
+template <typename T>
+struct WaveValue
+{
+    SLANG_FORCE_INLINE T& operator[](int lane) { return lanes[lane]; }
+    SLANG_FORCE_INLINE const T& operator[](int lane) const { return lanes[lane]; }
+
+    static SLANG_FORCE_INLINE WaveValue broadcast(T value)
+    {
+        WaveValue result;
+        for (int i = 0; i < kWaveLaneCount; i++)
+            result.lanes[i] = value;
+        return result;
+    }
+
+    alignas(16) T lanes[kWaveLaneCount];
+};
+
+/// The wave being run: which lanes are active, and the group thread index of lane 0.
+struct Wave
+{
+    WaveMask    activeMask;
+    uint32_t    firstThreadIndex;
+
+    SLANG_FORCE_INLINE bool isLaneActive(int lane) const { return (activeMask >> lane) & 1; }
+};
+
+static SLANG_FORCE_INLINE WaveMask _waveFullMask()
+{
+    return kWaveLaneCount == 32 ? ~WaveMask(0) : ((WaveMask(1) << kWaveLaneCount) - 1);
+}
+
+static SLANG_FORCE_INLINE uint32_t _waveCountBits(WaveMask mask)
+{
+#if defined(_MSC_VER)
+    return __popcnt(mask);
+#else
+    return uint32_t(__builtin_popcount(mask));
+#endif
+}
+
+/// kWaveLaneCount for an empty mask, so check for one before using the result as an index
+static SLANG_FORCE_INLINE int _waveFirstLane(WaveMask mask)
+{
+    int lane = 0;
+    while (lane < kWaveLaneCount && !((mask >> lane) & 1))
+        lane++;
+    return lane;
+}
+
+/// Runs `threadCount` group threads as waves, calling `kernel(const Wave&)` once per wave.
+template <typename KERNEL>
+SLANG_FORCE_INLINE void RunWaves(uint32_t threadCount, KERNEL&& kernel)
+{
+    for (uint32_t first = 0; first < threadCount; first += kWaveLaneCount)
+    {
+        Wave wave;
+        wave.firstThreadIndex = first;
+        const uint32_t remaining = threadCount - first;
+        wave.activeMask = remaining >= uint32_t(kWaveLaneCount) ? _waveFullMask() : ((WaveMask(1) << remaining) - 1);
+        kernel(wave);
+    }
+}
+
+// ----------------------------- Ops -----------------------------------------
+
+template <typename T>
+struct WaveOpOr
+{
+    static SLANG_FORCE_INLINE T getInitial() { return T(0); }
+    static SLANG_FORCE_INLINE T doOp(T a, T b) { return a | b; }
+};
+
+template <typename T>
+struct WaveOpAnd
+{
+    static SLANG_FORCE_INLINE T getInitial() { return ~T(0); }
+    static SLANG_FORCE_INLINE T doOp(T a, T b) { return a & b; }
+};
+
+template <typename T>
+struct WaveOpXor
+{
+    static SLANG_FORCE_INLINE T getInitial() { return T(0); }
+    static SLANG_FORCE_INLINE T doOp(T a, T b) { return a ^ b; }
+};
+
+template <typename T>
+struct WaveOpAdd
+{
+    static SLANG_FORCE_INLINE T getInitial() { return T(0); }
+    static SLANG_FORCE_INLINE T doOp(T a, T b) { return a + b; }
+};
+
+template <typename T>
+struct WaveOpMul
+{
+    static SLANG_FORCE_INLINE T getInitial() { return T(1); }
+    static SLANG_FORCE_INLINE T doOp(T a, T b) { return a * b; }
+};
+
+// Min and max have no identity for every T, so they start from the first active lane instead
+template <typename T>
+struct WaveOpMax
+{
+    static SLANG_FORCE_INLINE T doOp(T a, T b) { return a > b ? a : b; }
+};
+
+template <typename T>
+struct WaveOpMin
+{
+    static SLANG_FORCE_INLINE T doOp(T a, T b) { return a < b ? a : b; }
+};
+
+// ----------------------------- Generic lane loops -----------------------------------------
+
+template <typename OP, typename T>
+SLANG_FORCE_INLINE T _waveReduceScalar(const Wave& wave, const WaveValue<T>& value)
+{
+    T result = OP::getInitial();
+    for (int i = 0; i < kWaveLaneCount; i++)
+    {
+        if (wave.isLaneActive(i))
+            result = OP::doOp(result, value.lanes[i]);
+    }
+    return result;
+}
+
+template <typename OP, typename T>
+SLANG_FORCE_INLINE T _waveReduceFromFirst(const Wave& wave, const WaveValue<T>& value)
+{
+    if (!wave.activeMask)
+        return T();
+    const int first = _waveFirstLane(wave.activeMask);
+    T result = value.lanes[first];
+    for (int i = first + 1; i < kWaveLaneCount; i++)
+    {
+        if (wave.isLaneActive(i))
+            result = OP::doOp(result, value.lanes[i]);
+    }
+    return result;
+}
+
+/// Exclusive prefix: each active lane gets the op over the active lanes below it.
+template <typename OP, typename T>
+SLANG_FORCE_INLINE WaveValue<T> _wavePrefixScalar(const Wave& wave, const WaveValue<T>& value)
+{
+    WaveValue<T> result;
+    T running = OP::getInitial();
+    for (int i = 0; i < kWaveLaneCount; i++)
+    {
+        result.lanes[i] = running;
+        if (wave.isLaneActive(i))
+            running = OP::doOp(running, value.lanes[i]);
+    }
+    return result;
+}
+
+// ----------------------------- SSE sums -----------------------------------------
+
+#if SLANG_TEST_WAVE_SSE
+
+// Lanes are processed 4 at a time. The active mask bits for lanes [base, base + 4) become an all ones/zeros mask.
+static SLANG_FORCE_INLINE __m128i _waveLaneMask4(WaveMask mask, int base)
+{
+    const __m128i bits = _mm_set_epi32(8, 4, 2, 1);
+    const __m128i laneBits = _mm_and_si128(_mm_set1_epi32(int((mask >> base) & 0xf)), bits);
+    return _mm_cmpeq_epi32(laneBits, bits);
+}
+
+static SLANG_FORCE_INLINE float _waveHorizontalAdd(__m128 v)
+{
+    __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+static SLANG_FORCE_INLINE int32_t _waveHorizontalAdd(__m128i v)
+{
+    __m128i sums = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtsi128_si32(sums);
+}
+
+// Inclusive scan of 4 lanes: shift by one lane and add, then by two lanes and add
+static SLANG_FORCE_INLINE __m128i _waveScan4(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+    return _mm_add_epi32(v, _mm_slli_si128(v, 8));
+}
+
+static SLANG_FORCE_INLINE __m128 _waveScan4(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+    return _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+}
+
+static SLANG_FORCE_INLINE float _waveSumSSE(const Wave& wave, const WaveValue<float>& value)
+{
+    __m128 sum = _mm_setzero_ps();
+    for (int base = 0; base < kWaveLaneCount; base += 4)
+    {
+        __m128 lanes = _mm_and_ps(_mm_load_ps(&value.lanes[base]), _mm_castsi128_ps(_waveLaneMask4(wave.activeMask, base)));
+        sum = _mm_add_ps(sum, lanes);
+    }
+    return _waveHorizontalAdd(sum);
+}
+
+template <typename T>
+static SLANG_FORCE_INLINE T _waveSumSSEInt(const Wave& wave, const WaveValue<T>& value)
+{
+    __m128i sum = _mm_setzero_si128();
+    for (int base = 0; base < kWaveLaneCount; base += 4)
+    {
+        __m128i lanes = _mm_and_si128(_mm_load_si128((const __m128i*)&value.lanes[base]), _waveLaneMask4(wave.activeMask, base));
+        sum = _mm_add_epi32(sum, lanes);
+    }
+    return T(_waveHorizontalAdd(sum));
+}
+
+static SLANG_FORCE_INLINE WaveValue<float> _wavePrefixSumSSE(const Wave& wave, const WaveValue<float>& value)
+{
+    // Exclusive scan: scan each 4 lanes, then add the running total carried from the lanes below
+    WaveValue<float> result;
+    __m128 carry = _mm_setzero_ps();
+    for (int base = 0; base < kWaveLaneCount; base += 4)
+    {
+        __m128 lanes = _mm_and_ps(_mm_load_ps(&value.lanes[base]), _mm_castsi128_ps(_waveLaneMask4(wave.activeMask, base)));
+        __m128 exclusive = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(lanes), 4));
+        __m128 scanned = _mm_add_ps(_waveScan4(exclusive), carry);
+        _mm_store_ps(&result.lanes[base], scanned);
+        __m128 total = _mm_add_ps(scanned, lanes);
+        carry = _mm_shuffle_ps(total, total, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    return result;
+}
+
+template <typename T>
+static SLANG_FORCE_INLINE WaveValue<T> _wavePrefixSumSSEInt(const Wave& wave, const WaveValue<T>& value)
+{
+    WaveValue<T> result;
+    __m128i carry = _mm_setzero_si128();
+    for (int base = 0; base < kWaveLaneCount; base += 4)
+    {
+        __m128i lanes = _mm_and_si128(_mm_load_si128((const __m128i*)&value.lanes[base]), _waveLaneMask4(wave.activeMask, base));
+        __m128i scanned = _mm_add_epi32(_waveScan4(_mm_slli_si128(lanes, 4)), carry);
+        _mm_store_si128((__m128i*)&result.lanes[base], scanned);
+        __m128i total = _mm_add_epi32(scanned, lanes);
+        carry = _mm_shuffle_epi32(total, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    return result;
+}
+
+#endif // SLANG_TEST_WAVE_SSE
+
+// ----------------------------- Query -----------------------------------------
+
+SLANG_FORCE_INLINE uint32_t WaveGetLaneCount(const Wave& wave)
+{
+    (void)wave;
+    return uint32_t(kWaveLaneCount);
+}
+
+SLANG_FORCE_INLINE WaveValue<uint32_t> WaveGetLaneIndex(const Wave& wave)
+{
+    (void)wave;
+    WaveValue<uint32_t> result;
+    for (int i = 0; i < kWaveLaneCount; i++)
+        result.lanes[i] = uint32_t(i);
+    return result;
+}
+
+SLANG_FORCE_INLINE WaveValue<bool> WaveIsFirstLane(const Wave& wave)
+{
+    const int first = _waveFirstLane(wave.activeMask);
+    WaveValue<bool> result;
+    for (int i = 0; i < kWaveLaneCount; i++)
+        result.lanes[i] = (i == first);
+    return result;
+}
+
+// ----------------------------- Vote -----------------------------------------
+
+/// Bitmask of the active lanes where `condition` holds. HLSL returns a uint4; with at most 32 lanes only .x is used.
+SLANG_FORCE_INLINE WaveMask WaveActiveBallot(const Wave& wave, const WaveValue<bool>& condition)
+{
+    WaveMask mask = 0;
+    for (int i = 0; i < kWaveLaneCount; i++)
+        mask |= WaveMask(condition.lanes[i]) << i;
+    return mask & wave.activeMask;
+}
+
+SLANG_FORCE_INLINE bool WaveActiveAnyTrue(const Wave& wave, const WaveValue<bool>& condition)
+{
+    return WaveActiveBallot(wave, condition) != 0;
+}
+
+SLANG_FORCE_INLINE bool WaveActiveAllTrue(const Wave& wave, const WaveValue<bool>& condition)
+{
+    return WaveActiveBallot(wave, condition) == wave.activeMask;
+}
+
+SLANG_FORCE_INLINE uint32_t WaveActiveCountBits(const Wave& wave, const WaveValue<bool>& condition)
+{
+    return _waveCountBits(WaveActiveBallot(wave, condition));
+}
+
+SLANG_FORCE_INLINE WaveValue<uint32_t> WavePrefixCountBits(const Wave& wave, const WaveValue<bool>& condition)
+{
+    const WaveMask ballot = WaveActiveBallot(wave, condition);
+    WaveValue<uint32_t> result;
+    for (int i = 0; i < kWaveLaneCount; i++)
+        result.lanes[i] = _waveCountBits(ballot & ((WaveMask(1) << i) - 1));
+    return result;
+}
+
+template <typename T>
+SLANG_FORCE_INLINE bool WaveActiveAllEqual(const Wave& wave, const WaveValue<T>& value)
+{
+    if (!wave.activeMask)
+        return true;
+    const T first = value.lanes[_waveFirstLane(wave.activeMask)];
+    for (int i = 0; i < kWaveLaneCount; i++)
+    {
+        if (wave.isLaneActive(i) && !(value.lanes[i] == first))
+            return false;
+    }
+    return true;
+}
+
+// ----------------------------- Reductions -----------------------------------------
+
+template <typename T>
+SLANG_FORCE_INLINE T WaveActiveSum(const Wave& wave, const WaveValue<T>& value) { return _waveReduceScalar<WaveOpAdd<T>>(wave, value); }
+
+template <typename T>
+SLANG_FORCE_INLINE T WaveActiveProduct(const Wave& wave, const WaveValue<T>& value) { return _waveReduceScalar<WaveOpMul<T>>(wave, value); }
+
+template <typename T>
+SLANG_FORCE_INLINE T WaveActiveBitAnd(const Wave& wave, const WaveValue<T>& value) { return _waveReduceScalar<WaveOpAnd<T>>(wave, value); }
+
+template <typename T>
+SLANG_FORCE_INLINE T WaveActiveBitOr(const Wave& wave, const WaveValue<T>& value) { return _waveReduceScalar<WaveOpOr<T>>(wave, value); }
+
+template <typename T>
+SLANG_FORCE_INLINE T WaveActiveBitXor(const Wave& wave, const WaveValue<T>& value) { return _waveReduceScalar<WaveOpXor<T>>(wave, value); }
+
+template <typename T>
+SLANG_FORCE_INLINE T WaveActiveMin(const Wave& wave, const WaveValue<T>& value) { return _waveReduceFromFirst<WaveOpMin<T>>(wave, value); }
+
+template <typename T>
+SLANG_FORCE_INLINE T WaveActiveMax(const Wave& wave, const WaveValue<T>& value) { return _waveReduceFromFirst<WaveOpMax<T>>(wave, value); }
+
+// ----------------------------- Prefix -----------------------------------------
+
+template <typename T>
+SLANG_FORCE_INLINE WaveValue<T> WavePrefixSum(const Wave& wave, const WaveValue<T>& value) { return _wavePrefixScalar<WaveOpAdd<T>>(wave, value); }
+
+template <typename T>
+SLANG_FORCE_INLINE WaveValue<T> WavePrefixProduct(const Wave& wave, const WaveValue<T>& value) { return _wavePrefixScalar<WaveOpMul<T>>(wave, value); }
+
+#if SLANG_TEST_WAVE_SSE
+// With whole groups of 4 lanes the 32 bit sums go through SSE
+#   define SLANG_TEST_WAVE_SSE_SUM(T, REDUCE, PREFIX) \
+    template <> SLANG_FORCE_INLINE T WaveActiveSum<T>(const Wave& wave, const WaveValue<T>& value) \
+    { return (kWaveLaneCount % 4) == 0 ? REDUCE(wave, value) : _waveReduceScalar<WaveOpAdd<T>>(wave, value); } \
+    template <> SLANG_FORCE_INLINE WaveValue<T> WavePrefixSum<T>(const Wave& wave, const WaveValue<T>& value) \
+    { return (kWaveLaneCount % 4) == 0 ? PREFIX(wave, value) : _wavePrefixScalar<WaveOpAdd<T>>(wave, value); }
+
+SLANG_TEST_WAVE_SSE_SUM(float, _waveSumSSE, _wavePrefixSumSSE)
+SLANG_TEST_WAVE_SSE_SUM(int32_t, _waveSumSSEInt<int32_t>, _wavePrefixSumSSEInt<int32_t>)
+SLANG_TEST_WAVE_SSE_SUM(uint32_t, _waveSumSSEInt<uint32_t>, _wavePrefixSumSSEInt<uint32_t>)
+
+#   undef SLANG_TEST_WAVE_SSE_SUM
+#endif
+
+// ----------------------------- Lane reads -----------------------------------------
+
+template <typename T>
+SLANG_FORCE_INLINE T WaveReadLaneAt(const Wave& wave, const WaveValue<T>& value, int lane)
+{
+    (void)wave;
+    return value.lanes[lane];
+}
+
+template <typename T>
+SLANG_FORCE_INLINE T WaveReadLaneFirst(const Wave& wave, const WaveValue<T>& value)
+{
+    if (!wave.activeMask)
+        return T();
+    return value.lanes[_waveFirstLane(wave.activeMask)];
+}
+
+/// Each lane reads `value` from the lane given in `sourceLane` (Slang's non standard WaveShuffle).
+template <typename T>
+SLANG_FORCE_INLINE WaveValue<T> WaveShuffle(const Wave& wave, const WaveValue<T>& value, const WaveValue<int>& sourceLane)
+{
+    (void)wave;
+    WaveValue<T> result;
+    for (int i = 0; i < kWaveLaneCount; i++)
+        result.lanes[i] = value.lanes[uint32_t(sourceLane.lanes[i]) % uint32_t(kWaveLaneCount)];
+    return result;
+}
@@ -0,0 +1,130 @@
+// Compares the two CompileStrategy ways (CompileStrategy.h) of compiling a file with many entry points to hlsl:
+// code generated per entry point, against one whole program output shared by all of them.
+//
+// The file is generated: compute entry points that each call a couple of helpers out of a shared set, written to
+// out_entrypoints.slang. Each strategy is timed from the same session and its output size is reported, then the
+// faster and the smaller strategy are named.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+#include "CompileStrategy.h"
+#include "RunModes.h"
+
+static const char*  c_sourceFileName            = "out_entrypoints.slang";
+static const int    c_helperCount               = 32;
+static const int    c_defaultEntryPointCount    = 64;
+static const int    c_defaultRepeatCount        = 5;
+
+static bool WriteEntryPoints(int entryPointCount, std::vector<std::string>& outNames)
+{
+    FILE* file = nullptr;
+    fopen_s(&file, c_sourceFileName, "wb");
+    if (!file)
+        return false;
+
+    fprintf(file, "// Generated by the wholeprogram run mode\n\nRWBuffer<float> Data;\n\n");
+    for (int i = 0; i < c_helperCount; i++)
+    {
+        fprintf(file, "float helper%i(float x)\n{\n", i);
+        fprintf(file, "    float y = x * %i.0 + 0.5;\n", i + 1);
+        fprintf(file, "    for (int i = 0; i < 4; i++)\n        y = y * 0.5 + sin(y) * cos(y * %i.0);\n", i + 2);
+        fprintf(file, "    return y;\n}\n\n");
+    }
+
+    outNames.clear();
+    for (int i = 0; i < entryPointCount; i++)
+    {
+        outNames.push_back("csmain" + std::to_string(i));
+        fprintf(file, "[shader(\"compute\")]\n[numthreads(64, 1, 1)]\n");
+        fprintf(file, "void %s(uint3 DTid : SV_DispatchThreadID)\n{\n", outNames.back().c_str());
+        fprintf(file, "    Data[DTid.x] = helper%i(Data[DTid.x]) + helper%i(float(DTid.x));\n}\n\n",
+            i % c_helperCount, (i * 7 + 3) % c_helperCount);
+    }
+    fclose(file);
+    return true;
+}
+
+struct StrategyRun
+{
+    CompileStrategy     strategy;
+    double              ms = 0.0;
+    size_t              outputSize = 0;
+};
+
+int RunWholeProgramBenchmark(int argc, char** argv)
+{
+    const int entryPointCount = argc > 1 ? atoi(argv[1]) : c_defaultEntryPointCount;
+    const int repeatCount = argc > 2 ? atoi(argv[2]) : c_defaultRepeatCount;
+    if (entryPointCount < 1 || repeatCount < 1)
+    {
+        printf("Entry point and repeat counts must be at least 1.\n");
+        return 1;
+    }
+
+    ProgramCompileDesc desc;
+    desc.sourceFileName = c_sourceFileName;
+    if (!WriteEntryPoints(entryPointCount, desc.entryPointNames))
+    {
+        printf("Could not open %s for writing.\n", c_sourceFileName);
+        return 1;
+    }
+
+    printf("Whole program vs per entry point: %i entry points sharing %i helpers, best of %i compiles\n\n",
+        entryPointCount, c_helperCount, repeatCount);
+    printf("    %-20s %12s %16s %14s\n", "strategy", "ms", "ms/entry point", "output KB");
+
+    SlangSession* session = spCreateSession(NULL);
+    int failures = 0;
+
+    StrategyRun runs[] = { { CompileStrategy::PerEntryPoint }, { CompileStrategy::WholeProgram } };
+    for (StrategyRun& run : runs)
+    {
+        ProgramCompileOutput output;
+        bool ok = true;
+        run.ms = TimeBestMs(repeatCount, [&]()
+        {
+            ok &= SLANG_SUCCEEDED(CompileProgram(session, desc, run.strategy, output));
+        });
+        if (!ok)
+        {
+            printf("    ERROR: the %s compile failed\n%s", GetCompileStrategyName(run.strategy), output.diagnostics.c_str());
+            failures++;
+            continue;
+        }
+        run.outputSize = output.outputSize;
+
+        // Text targets keep entry point names, so every one must be findable in its output
+        for (const EntryPointCode& entryPoint : output.entryPoints)
+        {
+            const std::string code((const char*)entryPoint.code->getBufferPointer(), entryPoint.code->getBufferSize());
+            if (code.find(entryPoint.name) == std::string::npos)
+            {
+                printf("    ERROR: %s isn't in its %s output\n", entryPoint.name.c_str(), GetCompileStrategyName(run.strategy));
+                failures++;
+                break;
+            }
+        }
+
+        printf("    %-20s %12.3f %16.4f %14.2f\n", GetCompileStrategyName(run.strategy), run.ms,
+            run.ms / entryPointCount, double(run.outputSize) / 1024.0);
+    }
+    spDestroySession(session);
+
+    if (!failures)
+    {
+        const StrategyRun& perEntryPoint = runs[0];
+        const StrategyRun& wholeProgram = runs[1];
+        const StrategyRun& faster = wholeProgram.ms < perEntryPoint.ms ? wholeProgram : perEntryPoint;
+        const StrategyRun& smaller = wholeProgram.outputSize < perEntryPoint.outputSize ? wholeProgram : perEntryPoint;
+        printf("\n    %-40s %s (%.2fx)\n", "faster", GetCompileStrategyName(faster.strategy),
+            faster.ms > 0.0 ? (wholeProgram.ms + perEntryPoint.ms - faster.ms) / faster.ms : 0.0);
+        printf("    %-40s %s (%.2fx)\n", "smaller", GetCompileStrategyName(smaller.strategy),
+            smaller.outputSize ? double(wholeProgram.outputSize + perEntryPoint.outputSize - smaller.outputSize) / double(smaller.outputSize) : 0.0);
+    }
+
+    return failures ? 1 : 0;
+}
@@ -2,10 +2,19 @@
 // API user guide: https://github.com/shader-slang/slang/blob/master/docs/api-users-guide.md
 
 #include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "slang/slang.h"
 
+#include "Bench.h"
+#include "DiagnosticLog.h"
+#include "ReproCorpus.h"
+#include "RunModes.h"
+
 static const char*              c_fileNameSource        = "test.slang";
 static const char*              c_fileNameOut           = "out_compiled.hlsl";
 static const char*              c_fileNameReflection    = "out_reflection.txt";
@@ -14,9 +23,62 @@ static const SlangStage         c_stage                 = SlangStage::SLANG_STAG
 static const SlangCompileTarget c_compileTarget         = SlangCompileTarget::SLANG_HLSL;
 static const char*              c_compileProfile        = "cs_5_1";
 static const bool               c_loadFromMemory        = false;
+static const double             c_reproThresholdMs      = -1.0;     // >= 0 saves a repro of a compile slower than this (ReproCorpus.h)
+static const size_t             c_diagnosticRingSize    = 256;
+
+struct RunMode
+{
+    const char* name;
+    int (*run)(int argc, char** argv);
+    const char* description;
+};
+
+static const RunMode c_runModes[] =
+{
+    { "texbench", RunTextureBenchmark, "[size] CPU texture layout/filter/batching benchmark" },
+    { "arenabench", RunArenaBenchmark, "[maxThreads] per worker scratch arena vs heap allocation benchmark" },
+    { "wavebench", RunWaveBenchmark, "[elements] [threads] lane batched wave intrinsic checks and benchmark" },
+    { "groupsharedbench", RunGroupSharedBenchmark, "[elements] [threads] groupshared/barrier kernels run as fibers" },
+    { "gfxcpu", RunCPUDeviceHarness, "[elements] [repeat] run test.slang end to end on the slang-gfx CPU device" },
+    { "shadercache", RunShaderCacheBenchmark, "[cacheDir] [budgetKB] cold vs warm startup with a byte budgeted shader cache" },
+    { "dispatchbench", RunDispatchOverheadBenchmark, "[dispatches] [ringSize] per dispatch CPU overhead, fresh vs recycled heaps and shader objects" },
+    { "piperecord", RunPipelineRecord, "[manifest] record the pipelines a run uses" },
+    { "pipeprewarm", RunPipelinePrewarm, "[manifest] [threads] first request latency, lazy vs prewarmed from the manifest" },
+    { "layoutbench", RunLayoutBenchmark, "[iterations] shader parameter binding by name vs cached layout slots vs one block" },
+    { "asynccompile", RunAsyncCompileBenchmark, "[edits] [threads] background compiles of edited test.slang with priorities and supersede" },
+    { "kernelcounters", RunKernelCounterBenchmark, "[elements] [threads] per entry point invocation, time, buffer byte and texture sample counters" },
+    { "tensorcpu", RunTensorBenchmark, "[elements] [threads] fused TensorView kernel on the CPU vs an eager operator chain" },
+    { "tensorrank", RunTensorRankBenchmark, "[elements] [threads] rank 6 tensor view with 64 bit strides, full index math vs collapsed dimensions" },
+    { "autotune", RunAutotune, "[elements] [repeats] pick the fastest numthreads for test.slang on the CPU device and store it" },
+    { "modulecontainer", RunModuleContainerBenchmark, "[functions] [repeats] link a shared library from a precompiled .slang-module container vs its source" },
+    { "wholeprogram", RunWholeProgramBenchmark, "[entryPoints] [repeats] many entry points compiled one at a time vs as one whole program output" },
+    { "optmatrix", RunOptMatrixBenchmark, "[elements] [repeats] compile time, code size and cpu runtime for every optimization, debug info and target combination" },
+    { "diagbatch", RunDiagnosticBatchBenchmark, "[jobs] [threads] batch compile with diagnostics streamed as structured records, failing jobs reported at once" },
+    { "checksweep", RunCheckSweepBenchmark, "[permutations] [threads] [reproMs] parallel permutation sweep, full compilation vs check only, with fail fast" },
+    { "reproreplay", RunReproReplayBenchmark, "[dir] [repeats] time the slow compile repros checksweep captured" },
+    { "kernelcache", RunKernelCacheBenchmark, "[kernels] [elements] start cpu kernels from the shared library cache, cold and warm" },
+    { "hotreload", RunHotReloadBenchmark, "[edits] | watch [seconds] recompile edited kernels in the background and swap them into a running dispatch loop" },
+    { "memfootprint", RunMemoryFootprintBenchmark, "[sessions] [budgetKB] memory kept by warm sessions, modules, reflection and blobs, with LRU eviction to a budget" },
+    { "sessionpool", RunSessionPoolBenchmark, "[threads] [requests] [maxUses] compile requests served from a session pool with thread affinity vs a session per request" },
+};
 
 int main(int argc, char** argv)
 {
+    // With no arguments, compile the test shader to hlsl as always. Otherwise the first argument picks a run mode.
+    if (argc > 1)
+    {
+        for (const RunMode& mode : c_runModes)
+        {
+            if (strcmp(argv[1], mode.name) == 0)
+                return mode.run(argc - 1, argv + 1);
+        }
+
+        printf("Unknown mode \"%s\". Available modes:\n", argv[1]);
+        for (const RunMode& mode : c_runModes)
+            printf("    %-18s %s\n", mode.name, mode.description);
+        return 1;
+    }
+
     int ret = 0;
 
     // Create a session and request
@@ -59,7 +121,49 @@ int main(int argc, char** argv)
         c_entryPointName,
         c_stage);
 
-    int anyErrors = spCompile(request);
+    // Optionally keep a repro of a slow compile for the reproreplay run mode
+    SlowCompileRecorder reproRecorder(c_defaultReproDirectory, c_reproThresholdMs);
+    if (c_reproThresholdMs >= 0.0)
+        reproRecorder.prepare(request);
+
+    // Diagnostics are printed as slang reports them, while the compile runs on another thread
+    DiagnosticRing diagnosticRing(c_diagnosticRingSize);
+    DiagnosticStream diagnosticStream(diagnosticRing, 0);
+    diagnosticStream.keepText();
+    diagnosticStream.attach(request);
+
+    std::atomic<bool> compileDone{ false };
+    int anyErrors = 0;
+    double compileMs = 0.0;
+    std::thread compileThread([&]()
+    {
+        Timer compileTimer;
+        anyErrors = spCompile(request);
+        compileMs = compileTimer.elapsedMs();
+        diagnosticStream.flush();
+        compileDone = true;
+    });
+
+    DiagnosticRecord record;
+    for (;;)
+    {
+        const bool done = compileDone.load();
+        if (!diagnosticRing.tryPop(record))
+        {
+            if (done)
+                break;
+            std::this_thread::yield();
+            continue;
+        }
+        if (record.line)
+            printf("%s(%i): %s %i: %s\n", record.file, record.line, GetDiagnosticSeverityName(record.severity), record.code, record.message);
+        else
+            printf("%s %i: %s\n", GetDiagnosticSeverityName(record.severity), record.code, record.message);
+    }
+    compileThread.join();
+
+    if (c_reproThresholdMs >= 0.0 && reproRecorder.recordIfSlow(request, std::string(c_fileNameSource) + "_" + c_entryPointName, compileMs))
+        printf("Saved a repro of the %.1f ms compile to %s\n", compileMs, c_defaultReproDirectory);
 
     if (anyErrors != 0)
     {
@@ -69,10 +173,9 @@ int main(int argc, char** argv)
     else
         printf("spCompile: OK!\n");
 
-    // Output diagnostics if there were problems
-    char const* diagnostics = spGetDiagnosticOutput(request);
-    if (diagnostics && diagnostics[0])
-        printf("diagnostics:\n%s\n", diagnostics);
+    // The ring was full and some records weren't printed, so print everything
+    if (diagnosticRing.getDroppedCount())
+        printf("%llu diagnostics dropped, all diagnostics:\n%s\n", (unsigned long long)diagnosticRing.getDroppedCount(), diagnosticStream.getText().c_str());
 
     // write the compiled output
     {